@@ -26,9 +26,10 @@ namespace D3D9 {
 
     size_t arial_font_id;
 
-    NOINLINE void init_render( HWND wnd ) {
-        D3DPRESENT_PARAMETERS d3dpp;
+    // kept for IDirect3DDevice9::Reset
+    D3DPRESENT_PARAMETERS d3dpp;
 
+    NOINLINE void init_render( HWND wnd ) {
         d3d = Direct3DCreate9( D3D_SDK_VERSION );
 
         // set device data
@@ -46,7 +47,42 @@ namespace D3D9 {
         arial_font_id = g_d3d9_renderer->create_font( g_d3d9_renderer->get_font_path( "Arial (TrueType)" ), 30, true );
     }
 
+    NOINLINE void resize( size_t width, size_t height ) {
+        if( !d3ddev || !width || !height )
+            return;
+
+        // the back buffer only changes size on reset
+        d3dpp.BackBufferWidth  = ( UINT ) width;
+        d3dpp.BackBufferHeight = ( UINT ) height;
+
+        g_d3d9_renderer->on_lost();
+
+        if( d3ddev->Reset( &d3dpp ) >= 0 )
+            g_d3d9_renderer->on_reset();
+    }
+
+    NOINLINE void set_dpi( uint32_t dpi ) {
+        if( g_d3d9_renderer )
+            g_d3d9_renderer->set_dpi( dpi );
+    }
+
     NOINLINE void render_frame() {
+        const auto state = d3ddev->TestCooperativeLevel();
+
+        // device lost ( alt-tab, etc. ), wait until it can be reset
+        if( state == D3DERR_DEVICELOST ) {
+            g_d3d9_renderer->on_lost();
+            return;
+        }
+
+        // only the renderer's default pool resources are rebuilt, fonts survive
+        if( state == D3DERR_DEVICENOTRESET ) {
+            g_d3d9_renderer->on_lost();
+
+            if( d3ddev->Reset( &d3dpp ) < 0 || !g_d3d9_renderer->on_reset() )
+                return;
+        }
+
         // clear the window to a deep blue
         d3ddev->Clear( 0, NULL, D3DCLEAR_TARGET, D3DCOLOR_XRGB( 255, 255, 255 ), 1.f, 0 );
 
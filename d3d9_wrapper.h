@@ -29,6 +29,12 @@ namespace D3D9 {
     // initialize d3d9 frame rendering
     NOINLINE void init_render( HWND wnd );
 
+    // resize back buffer to the window client size
+    NOINLINE void resize( size_t width, size_t height );
+
+    // window moved to a monitor with another dpi
+    NOINLINE void set_dpi( uint32_t dpi );
+
     // render current frame
     NOINLINE void render_frame();
 
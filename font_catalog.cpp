@@ -0,0 +1,231 @@
+// portable, builds without the windows / d3d headers so it can be tested anywhere
+#include <cstdio>
+#include <cctype>
+#include <filesystem>
+#include "font_catalog.h"
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <Windows.h>
+    #include <Shlobj.h>
+#endif
+
+namespace {
+
+    // index file header, bump the version when the format changes
+    constexpr char index_header[] = "dx9-renderer font index 1";
+
+    NOINLINE bool is_regular_style( const std::string &style ) {
+        const auto normalized = FontCatalog::normalize( style );
+
+        return normalized.empty() || normalized == "regular" || normalized == "normal" || normalized == "book" || normalized == "roman";
+    }
+
+    NOINLINE bool is_font_file( const std::filesystem::path &path ) {
+        auto extension = path.extension().string();
+
+        for( auto &ch : extension )
+            ch = ( char ) std::tolower( ( unsigned char ) ch );
+
+        return extension == ".ttf" || extension == ".otf" || extension == ".ttc";
+    }
+
+#ifdef _WIN32
+    // registry value names look like "Arial Bold (TrueType)" or "Cambria & Cambria Math (TrueType)",
+    // the data is a file name relative to the fonts folder or, for per user fonts, a full path
+    NOINLINE size_t add_registry_fonts( FontCatalog &catalog, HKEY root, const std::string &fonts_folder ) {
+        HKEY    reg_key;
+        char    name_buf[ MAX_PATH ];
+        char    data_buf[ MAX_PATH ];
+        DWORD   name_size, data_size, type;
+        size_t  count;
+
+        if( RegOpenKeyExA( root, "Software\\Microsoft\\Windows NT\\CurrentVersion\\Fonts", 0, KEY_READ, &reg_key ) != ERROR_SUCCESS )
+            return 0;
+
+        count = 0;
+
+        for( DWORD reg_index = 0; ; ++reg_index ) {
+            name_size = MAX_PATH;
+            data_size = MAX_PATH - 1;
+
+            if( RegEnumValueA( reg_key, reg_index, name_buf, &name_size, nullptr, &type, ( LPBYTE ) data_buf, &data_size ) != ERROR_SUCCESS )
+                break;
+
+            if( type != REG_SZ )
+                continue;
+
+            data_buf[ data_size ] = '\0';
+
+            std::string path = data_buf;
+            if( path.find( ':' ) == std::string::npos && path.find( '\\' ) == std::string::npos )
+                path = fonts_folder + '\\' + path;
+
+            // style isn't split out of the value name, the whole name is the key
+            catalog.add( name_buf, {}, path );
+            count++;
+        }
+
+        RegCloseKey( reg_key );
+
+        return count;
+    }
+#endif
+
+}
+
+NOINLINE std::string FontCatalog::normalize( const std::string &name ) {
+    std::string normalized;
+
+    normalized.reserve( name.size() );
+
+    for( const auto ch : name )
+        normalized.push_back( ( char ) std::tolower( ( unsigned char ) ch ) );
+
+    // drop "(truetype)" / "(opentype)" style suffix
+    const auto paren = normalized.rfind( '(' );
+    if( paren != std::string::npos && normalized.back() == ')' )
+        normalized.erase( paren );
+
+    // trim
+    const auto first = normalized.find_first_not_of( " \t" );
+    if( first == std::string::npos )
+        return {};
+
+    const auto last = normalized.find_last_not_of( " \t" );
+
+    return normalized.substr( first, last - first + 1 );
+}
+
+NOINLINE void FontCatalog::add( const std::string &family, const std::string &style, const std::string &path ) {
+    const auto index = m_entries.size();
+
+    m_entries.push_back( { family, style, path } );
+
+    const auto family_key = normalize( family );
+    const auto style_key  = normalize( style );
+
+    // "family style", the first font to claim a name keeps it
+    if( !style_key.empty() )
+        m_lookup.emplace( family_key + ' ' + style_key, index );
+
+    // the family alone resolves to its regular style if there is one
+    if( is_regular_style( style ) )
+        m_lookup[ family_key ] = index;
+    else
+        m_lookup.emplace( family_key, index );
+
+    // file name without extension, ex. arialbd
+    m_lookup.emplace( normalize( std::filesystem::path( path ).stem().string() ), index );
+}
+
+NOINLINE std::string FontCatalog::find( const std::string &name ) const {
+    const auto it = m_lookup.find( normalize( name ) );
+    if( it == m_lookup.end() )
+        return {};
+
+    return m_entries[ it->second ].m_path;
+}
+
+NOINLINE size_t FontCatalog::add_directory( FT_Library ft_library, const std::string &directory ) {
+    FT_Face         ft_face;
+    std::error_code error;
+    size_t          count;
+
+    if( !ft_library )
+        return 0;
+
+    count = 0;
+
+    std::filesystem::recursive_directory_iterator it( directory, std::filesystem::directory_options::skip_permission_denied, error ), end;
+    for( ; !error && it != end; it.increment( error ) ) {
+        if( !it->is_regular_file( error ) || !is_font_file( it->path() ) )
+            continue;
+
+        const auto path = it->path().string();
+
+        // only the first face of a collection is used, the renderer always opens face 0
+        if( FT_New_Face( ft_library, path.c_str(), 0, &ft_face ) )
+            continue;
+
+        if( ft_face->family_name )
+            add( ft_face->family_name, ft_face->style_name ? ft_face->style_name : "", path );
+
+        FT_Done_Face( ft_face );
+        count++;
+    }
+
+    return count;
+}
+
+NOINLINE size_t FontCatalog::add_system_fonts() {
+#ifdef _WIN32
+    char fonts_folder[ MAX_PATH ] = {};
+
+    if( SHGetFolderPathA( nullptr, CSIDL_FONTS, nullptr, 0, fonts_folder ) < 0 )
+        return 0;
+
+    // machine wide fonts, then fonts installed for the current user only
+    return add_registry_fonts( *this, HKEY_LOCAL_MACHINE, fonts_folder ) + add_registry_fonts( *this, HKEY_CURRENT_USER, fonts_folder );
+#else
+    return 0;
+#endif
+}
+
+NOINLINE bool FontCatalog::save_index( const std::string &path ) const {
+    FILE *file;
+
+    file = std::fopen( path.c_str(), "wb" );
+    if( !file )
+        return false;
+
+    // one font per line, family \t style \t path
+    std::fprintf( file, "%s\n", index_header );
+
+    for( const auto &entry : m_entries )
+        std::fprintf( file, "%s\t%s\t%s\n", entry.m_family.c_str(), entry.m_style.c_str(), entry.m_path.c_str() );
+
+    return std::fclose( file ) == 0;
+}
+
+NOINLINE bool FontCatalog::load_index( const std::string &path ) {
+    FILE        *file;
+    char        line_buf[ 2048 ];
+    std::string line;
+
+    file = std::fopen( path.c_str(), "rb" );
+    if( !file )
+        return false;
+
+    // stale format, rebuild
+    if( !std::fgets( line_buf, sizeof( line_buf ), file ) || std::string( line_buf ).rfind( index_header, 0 ) != 0 ) {
+        std::fclose( file );
+        return false;
+    }
+
+    clear();
+
+    while( std::fgets( line_buf, sizeof( line_buf ), file ) ) {
+        line = line_buf;
+
+        while( !line.empty() && ( line.back() == '\n' || line.back() == '\r' ) )
+            line.pop_back();
+
+        const auto first  = line.find( '\t' );
+        const auto second = first == std::string::npos ? std::string::npos : line.find( '\t', first + 1 );
+        if( second == std::string::npos )
+            continue;
+
+        add( line.substr( 0, first ), line.substr( first + 1, second - first - 1 ), line.substr( second + 1 ) );
+    }
+
+    std::fclose( file );
+
+    return !empty();
+}
+
+NOINLINE void FontCatalog::clear() {
+    m_entries.clear();
+    m_lookup.clear();
+}
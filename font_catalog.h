@@ -0,0 +1,69 @@
+#pragma once
+
+// portable, the registry provider is only compiled on windows
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#ifndef NOINLINE
+    #define NOINLINE
+#endif
+
+//
+// Font catalogue
+//
+// maps font names to file paths. built once from the windows fonts registry key or by scanning a
+// fonts directory, and can be saved to / loaded from an index file so later runs skip the scan.
+// names are matched case-insensitively and without the registry's " (TrueType)" style suffix,
+// "Arial", "arial bold", "Arial Bold (TrueType)" and the file name "arialbd" all resolve.
+//
+class FontCatalog {
+public:
+    struct Entry_t {
+        std::string m_family; // family name, ex. Arial
+        std::string m_style;  // style name, ex. Bold ( may be empty )
+        std::string m_path;   // full font file path
+    };
+
+    using entries_t = std::vector< Entry_t >;
+    using lookup_t  = std::unordered_map< std::string, size_t >;
+
+    entries_t m_entries; // known fonts
+    lookup_t  m_lookup;  // normalized name -> entry index
+
+    // ctor(s)
+    FontCatalog() : m_entries{}, m_lookup{} {
+
+    }
+
+    // add font, a regular style entry also becomes the family default
+    NOINLINE void add( const std::string &family, const std::string &style, const std::string &path );
+
+    // find font file path, empty if unknown
+    NOINLINE std::string find( const std::string &name ) const;
+
+    // scan directory ( recursively ) for ttf / otf / ttc files, family and style are read with freetype
+    NOINLINE size_t add_directory( FT_Library ft_library, const std::string &directory );
+
+    // add fonts installed on the system ( windows fonts registry keys )
+    NOINLINE size_t add_system_fonts();
+
+    // write catalogue to index file
+    NOINLINE bool save_index( const std::string &path ) const;
+
+    // replace catalogue with index file contents
+    NOINLINE bool load_index( const std::string &path );
+
+    // forget all fonts
+    NOINLINE void clear();
+
+    // any fonts?
+    bool empty() const {
+        return m_entries.empty();
+    }
+
+    // lowercase, trim and drop a trailing parenthesized suffix
+    NOINLINE static std::string normalize( const std::string &name );
+};
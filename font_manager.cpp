@@ -0,0 +1,164 @@
+#include "includes.h"
+
+NOINLINE bool FontManager::init() {
+    if( m_ft_library )
+        return true;
+
+    return FT_Init_FreeType( &m_ft_library ) == 0;
+}
+
+NOINLINE FT_Face FontManager::acquire_face( const std::string &path ) {
+    FaceEntry_t entry;
+    FT_Error    ft_error;
+
+    PROFILE_FUNCTION();
+
+    if( !init() )
+        return nullptr;
+
+    // already open
+    const auto it = m_faces.find( path );
+    if( it != m_faces.end() ) {
+        it->second.m_refs++;
+        return it->second.m_face;
+    }
+
+    // freetype reads the face straight from the mapping, fall back to a regular file open if mapping fails
+    if( map_file( path, entry ) )
+        ft_error = FT_New_Memory_Face( m_ft_library, ( const FT_Byte * ) entry.m_view, ( FT_Long ) entry.m_file_size, 0, &entry.m_face );
+    else
+        ft_error = FT_New_Face( m_ft_library, path.c_str(), 0, &entry.m_face );
+
+    if( ft_error ) {
+        close_face( entry );
+        return nullptr;
+    }
+
+    entry.m_refs = 1;
+
+    return m_faces.emplace( path, entry ).first->second.m_face;
+}
+
+NOINLINE void FontManager::release_face( FT_Face face ) {
+    const auto it = find_face( face );
+    if( it == m_faces.end() )
+        return;
+
+    if( --it->second.m_refs == 0 ) {
+        close_face( it->second );
+        m_faces.erase( it );
+    }
+}
+
+NOINLINE FT_Face FontManager::open_private_face( FT_Face shared_face ) {
+    FT_Face  face;
+    FT_Error ft_error;
+
+    const auto it = find_face( shared_face );
+    if( it == m_faces.end() )
+        return nullptr;
+
+    const auto &entry = it->second;
+
+    // parse the same mapping again, the shared entry keeps it alive
+    if( entry.m_view )
+        ft_error = FT_New_Memory_Face( m_ft_library, ( const FT_Byte * ) entry.m_view, ( FT_Long ) entry.m_file_size, 0, &face );
+    else
+        ft_error = FT_New_Face( m_ft_library, it->first.c_str(), 0, &face );
+
+    if( ft_error )
+        return nullptr;
+
+    it->second.m_refs++;
+
+    return face;
+}
+
+NOINLINE void FontManager::close_private_face( FT_Face shared_face, FT_Face private_face ) {
+    if( !private_face )
+        return;
+
+    FT_Done_Face( private_face );
+
+    release_face( shared_face );
+}
+
+NOINLINE void FontManager::release() {
+    // faces have to go before the library that owns them
+    for( auto &face : m_faces )
+        close_face( face.second );
+
+    m_faces.clear();
+
+    if( m_ft_library ) {
+        FT_Done_FreeType( m_ft_library );
+        m_ft_library = nullptr;
+    }
+}
+
+NOINLINE FontManager::faces_t::iterator FontManager::find_face( FT_Face face ) {
+    if( !face )
+        return m_faces.end();
+
+    for( auto it = m_faces.begin(); it != m_faces.end(); ++it ) {
+        if( it->second.m_face == face )
+            return it;
+    }
+
+    return m_faces.end();
+}
+
+NOINLINE bool FontManager::map_file( const std::string &path, FaceEntry_t &entry ) {
+    LARGE_INTEGER file_size;
+
+    entry.m_file = CreateFileA( path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+    if( entry.m_file == INVALID_HANDLE_VALUE )
+        return false;
+
+    if( !GetFileSizeEx( entry.m_file, &file_size ) || !file_size.QuadPart ) {
+        close_face( entry );
+        return false;
+    }
+
+    entry.m_file_size = ( size_t ) file_size.QuadPart;
+
+    entry.m_mapping = CreateFileMappingA( entry.m_file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+    if( !entry.m_mapping ) {
+        close_face( entry );
+        return false;
+    }
+
+    entry.m_view = MapViewOfFile( entry.m_mapping, FILE_MAP_READ, 0, 0, 0 );
+    if( !entry.m_view ) {
+        close_face( entry );
+        return false;
+    }
+
+    return true;
+}
+
+NOINLINE void FontManager::close_face( FaceEntry_t &entry ) {
+    // done face first, it may still read from the mapping
+    if( entry.m_face ) {
+        FT_Done_Face( entry.m_face );
+        entry.m_face = nullptr;
+    }
+
+    if( entry.m_view ) {
+        UnmapViewOfFile( entry.m_view );
+        entry.m_view = nullptr;
+    }
+
+    if( entry.m_mapping ) {
+        CloseHandle( entry.m_mapping );
+        entry.m_mapping = nullptr;
+    }
+
+    if( entry.m_file != INVALID_HANDLE_VALUE ) {
+        CloseHandle( entry.m_file );
+        entry.m_file = INVALID_HANDLE_VALUE;
+    }
+
+    entry.m_file_size = 0;
+    entry.m_refs      = 0;
+}
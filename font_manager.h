@@ -0,0 +1,74 @@
+#pragma once
+
+//
+// Shared freetype library and face cache
+//
+// every font used to create its own FT_Library and parse its own copy of the ttf file. the manager owns
+// one library and hands out faces by path, faces are reference counted and backed by a read only mapping
+// of the font file so additional sizes of the same font only cost an FT_Size.
+//
+class FontManager {
+public:
+    struct FaceEntry_t {
+        FT_Face     m_face;      // shared face
+        size_t      m_refs;      // fonts using the face
+        HANDLE      m_file;      // font file
+        HANDLE      m_mapping;   // file mapping
+        const void *m_view;      // mapped file data
+        size_t      m_file_size; // mapped size
+
+        // ctor(s)
+        FORCEINLINE FaceEntry_t() : m_face{}, m_refs{}, m_file{ INVALID_HANDLE_VALUE }, m_mapping{}, m_view{}, m_file_size{} {
+
+        }
+    };
+
+    using faces_t = std::unordered_map< std::string, FaceEntry_t >;
+
+    FT_Library m_ft_library; // shared freetype library
+    faces_t    m_faces;      // open faces keyed by path
+
+    // ctor(s)
+    FORCEINLINE FontManager() : m_ft_library{}, m_faces{} {
+
+    }
+
+    // dtor
+    FORCEINLINE ~FontManager() {
+        release();
+    }
+
+    // initialize freetype, safe to call more than once
+    NOINLINE bool init();
+
+    // get face for font file, opened on first use. every acquire needs a matching release_face
+    NOINLINE FT_Face acquire_face( const std::string &path );
+
+    // drop reference to face, closed when the last font lets go
+    NOINLINE void release_face( FT_Face face );
+
+    // open a separate face on the same font data as a shared face, for use on another thread.
+    // freetype faces aren't thread safe, so this has to be called from the thread owning the manager
+    NOINLINE FT_Face open_private_face( FT_Face shared_face );
+
+    // close face from open_private_face
+    NOINLINE void close_private_face( FT_Face shared_face, FT_Face private_face );
+
+    // close all faces and the library
+    NOINLINE void release();
+
+    // get freetype library
+    FORCEINLINE FT_Library get_library() const {
+        return m_ft_library;
+    }
+
+private:
+    // map font file into memory
+    NOINLINE bool map_file( const std::string &path, FaceEntry_t &entry );
+
+    // find cache entry of shared face
+    NOINLINE faces_t::iterator find_face( FT_Face face );
+
+    // close face and unmap its file
+    NOINLINE void close_face( FaceEntry_t &entry );
+};
@@ -0,0 +1,100 @@
+// portable, also builds without the windows / d3d headers
+#include <cstring>
+#include "glyph_bitmap.h"
+
+// same backend selection as vector.h, VECTOR_NO_SIMD forces the scalar fallback
+#if !defined( VECTOR_NO_SIMD ) && ( defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 ) )
+    #define GLYPH_BITMAP_SSE
+    #include <emmintrin.h>
+#elif !defined( VECTOR_NO_SIMD ) && ( defined( __aarch64__ ) || defined( _M_ARM64 ) )
+    #define GLYPH_BITMAP_NEON
+    #include <arm_neon.h>
+#endif
+
+NOINLINE void GlyphBitmap::expand_mono( const uint8_t *src, ptrdiff_t src_pitch, size_t width, size_t height, uint8_t *dst, ptrdiff_t dst_pitch ) {
+#if defined( GLYPH_BITMAP_SSE )
+    // bit of each output byte, 2 source bytes cover 16 pixels
+    const auto bits = _mm_setr_epi8( ( char ) 0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01, ( char ) 0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01 );
+#elif defined( GLYPH_BITMAP_NEON )
+    const uint8_t bit_values[ 16 ] = { 0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01, 0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01 };
+    const auto    bits             = vld1q_u8( bit_values );
+#endif
+
+    for( size_t row = 0; row < height; ++row ) {
+        const auto in  = src + ( ptrdiff_t ) row * src_pitch;
+        const auto out = dst + ( ptrdiff_t ) row * dst_pitch;
+
+        size_t x = 0;
+
+#if defined( GLYPH_BITMAP_SSE )
+        for( ; x + 16 <= width; x += 16 ) {
+            // spread byte 0 over lanes 0-7 and byte 1 over lanes 8-15, then test each lane's bit
+            auto v = _mm_cvtsi32_si128( in[ x / 8 ] | ( in[ x / 8 + 1 ] << 8 ) );
+            v = _mm_unpacklo_epi8( v, v );
+            v = _mm_unpacklo_epi16( v, v );
+            v = _mm_unpacklo_epi32( v, v );
+
+            _mm_storeu_si128( ( __m128i * ) ( out + x ), _mm_cmpeq_epi8( _mm_and_si128( v, bits ), bits ) );
+        }
+#elif defined( GLYPH_BITMAP_NEON )
+        for( ; x + 16 <= width; x += 16 ) {
+            const auto v = vcombine_u8( vdup_n_u8( in[ x / 8 ] ), vdup_n_u8( in[ x / 8 + 1 ] ) );
+
+            vst1q_u8( out + x, vtstq_u8( v, bits ) );
+        }
+#endif
+
+        for( ; x < width; ++x )
+            out[ x ] = ( in[ x >> 3 ] & ( 0x80 >> ( x & 7 ) ) ) ? 255 : 0;
+    }
+}
+
+NOINLINE void GlyphBitmap::expand_gray( const uint8_t *src, ptrdiff_t src_pitch, size_t width, size_t height, size_t bits, uint8_t *dst, ptrdiff_t dst_pitch ) {
+    const auto per_byte = 8 / bits;
+    const auto max      = ( 1u << bits ) - 1;
+
+    for( size_t row = 0; row < height; ++row ) {
+        const auto in  = src + ( ptrdiff_t ) row * src_pitch;
+        const auto out = dst + ( ptrdiff_t ) row * dst_pitch;
+
+        for( size_t x = 0; x < width; ++x ) {
+            const auto shift = 8 - bits * ( x % per_byte + 1 );
+
+            out[ x ] = ( uint8_t ) ( ( ( in[ x / per_byte ] >> shift ) & max ) * 255 / max );
+        }
+    }
+}
+
+NOINLINE void GlyphBitmap::copy_rows( const uint8_t *src, ptrdiff_t src_pitch, size_t row_size, size_t height, uint8_t *dst, ptrdiff_t dst_pitch ) {
+    // one copy when neither side is padded
+    if( src_pitch == dst_pitch && src_pitch == ( ptrdiff_t ) row_size ) {
+        std::memcpy( dst, src, row_size * height );
+        return;
+    }
+
+    for( size_t row = 0; row < height; ++row )
+        std::memcpy( dst + ( ptrdiff_t ) row * dst_pitch, src + ( ptrdiff_t ) row * src_pitch, row_size );
+}
+
+NOINLINE bool GlyphBitmap::to_coverage( const uint8_t *src, ptrdiff_t src_pitch, size_t width, size_t height, size_t bits, std::vector< uint8_t > &pixels ) {
+    if( bits != 1 && bits != 2 && bits != 4 && bits != 8 )
+        return false;
+
+    pixels.resize( width * height );
+
+    if( !width || !height )
+        return true;
+
+    // a negative pitch starts at the bottom row, walk it top down
+    if( src_pitch < 0 )
+        src -= src_pitch * ( ptrdiff_t ) ( height - 1 );
+
+    if( bits == 8 )
+        copy_rows( src, src_pitch, width, height, pixels.data(), ( ptrdiff_t ) width );
+    else if( bits == 1 )
+        expand_mono( src, src_pitch, width, height, pixels.data(), ( ptrdiff_t ) width );
+    else
+        expand_gray( src, src_pitch, width, height, bits, pixels.data(), ( ptrdiff_t ) width );
+
+    return true;
+}
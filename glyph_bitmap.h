@@ -0,0 +1,35 @@
+#pragma once
+
+// portable, also builds without the windows / d3d headers
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#ifndef NOINLINE
+    #define NOINLINE
+#endif
+
+//
+// Glyph bitmap conversion
+//
+// freetype hands out glyph bitmaps as 1, 2, 4 or 8 bits per pixel with a row pitch that may be padded or
+// negative ( bottom up ). these expand them straight to tightly packed 8 bit coverage, 0 - 255, the layout
+// atlas pages and the distance field generator take, without an intermediate FT_Bitmap_Convert copy.
+// the 1 bit expansion is simd, 16 pixels per step
+//
+namespace GlyphBitmap {
+
+    // expand rows of 1 bit pixels ( most significant bit first ) to 0 / 255 bytes
+    NOINLINE void expand_mono( const uint8_t *src, ptrdiff_t src_pitch, size_t width, size_t height, uint8_t *dst, ptrdiff_t dst_pitch );
+
+    // expand rows of 2 or 4 bit gray pixels to 0 - 255
+    NOINLINE void expand_gray( const uint8_t *src, ptrdiff_t src_pitch, size_t width, size_t height, size_t bits, uint8_t *dst, ptrdiff_t dst_pitch );
+
+    // copy rows between different pitches
+    NOINLINE void copy_rows( const uint8_t *src, ptrdiff_t src_pitch, size_t row_size, size_t height, uint8_t *dst, ptrdiff_t dst_pitch );
+
+    // convert a bitmap of 1, 2, 4 or 8 bits per pixel to tightly packed coverage, the vector is reused and only grows.
+    // false for other depths
+    NOINLINE bool to_coverage( const uint8_t *src, ptrdiff_t src_pitch, size_t width, size_t height, size_t bits, std::vector< uint8_t > &pixels );
+
+}
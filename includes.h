@@ -27,6 +27,9 @@
 // try to force func to not be inlined by the compiler
 #define NOINLINE __declspec( noinline )
 
+// compile in timeline profiler zones ( see profiler.h )
+//#define RENDERER_PROFILING
+
 //
 // types
 //
@@ -39,11 +42,25 @@ using ulong_t = unsigned long;
 
 #include <Windows.h>
 #include <cstdint>
+#include <cstring>
 #include <vector>
 #include <memory>
 #include <array>
 #include <map>
 #include <unordered_map>
+#include <string>
+#include <string_view>
+#include <cstdarg>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <deque>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <algorithm>
+#include <cmath>
 #include <Shlobj.h>
 #include <Shlobj_core.h>
 
@@ -56,11 +73,24 @@ using ulong_t = unsigned long;
 #include FT_FREETYPE_H
 #include FT_STROKER_H 
 #include FT_BITMAP_H 
+#include FT_GLYPH_H
+#include FT_SIZES_H
 
 // misc
 #include "math.h"
 #include "utils.h"
+#include "profiler.h"
+#include "rect_packer.h"
+#include "sdf.h"
+#include "glyph_bitmap.h"
+#include "thread_pool.h"
+#include "spsc_queue.h"
 #include "vector.h"
+#include "font_catalog.h"
+#include "font_manager.h"
+#include "texture_manager.h"
+#include "sprite_atlas.h"
+#include "overlay_channel.h"
 #include "renderer.h"
 
 // d3d related
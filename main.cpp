@@ -10,6 +10,23 @@ LRESULT __stdcall WindowProc( HWND wnd, UINT message, WPARAM wparam, LPARAM lpar
         PostQuitMessage( 0 );
         return 0;
 
+    // client area resized
+    case WM_SIZE:
+        if( wparam != SIZE_MINIMIZED )
+            D3D9::resize( LOWORD( lparam ), HIWORD( lparam ) );
+
+        return 0;
+
+    // moved to a monitor with another dpi, lparam is the suggested window rect
+    case WM_DPICHANGED: {
+        const auto rect = ( RECT * ) lparam;
+
+        D3D9::set_dpi( HIWORD( wparam ) );
+
+        SetWindowPos( wnd, NULL, rect->left, rect->top, rect->right - rect->left, rect->bottom - rect->top, SWP_NOZORDER | SWP_NOACTIVATE );
+        return 0;
+    }
+
     default:
         break;
     }
@@ -6,4 +6,18 @@ namespace Math {
     static constexpr auto pi    = 3.14159265358979f;
     static constexpr auto pi_2  = ( 2.f * 3.14159265358979f );
 
+    // segments needed for a circle of radius to stay within max_error pixels of the true curve.
+    // rounded up to a multiple of 4 so the shape stays symmetric on both axes
+    FORCEINLINE size_t circle_segments( float radius, float max_error, size_t min_segments = 8, size_t max_segments = 256 ) {
+        size_t segments;
+
+        if( radius <= max_error )
+            return min_segments;
+
+        segments = ( size_t ) std::ceil( pi / std::acos( 1.f - ( max_error / radius ) ) );
+        segments = ( segments + 3 ) & ~( size_t ) 3;
+
+        return std::clamp( segments, min_segments, max_segments );
+    }
+
 }
\ No newline at end of file
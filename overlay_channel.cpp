@@ -0,0 +1,311 @@
+// portable, builds without the windows / d3d headers so it can be tested anywhere
+#include <cstring>
+#include <new>
+#include "overlay_channel.h"
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <Windows.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+NOINLINE bool OverlayChannel::map( const std::string &name, size_t size, bool create ) {
+    void *view;
+
+#ifdef _WIN32
+    if( create )
+        m_handle = CreateFileMappingA( INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, ( DWORD ) ( ( uint64_t ) size >> 32 ), ( DWORD ) size, name.c_str() );
+    else
+        m_handle = OpenFileMappingA( FILE_MAP_ALL_ACCESS, FALSE, name.c_str() );
+
+    if( !m_handle )
+        return false;
+
+    // opening maps the whole section, its size comes from the header
+    view = MapViewOfFile( m_handle, FILE_MAP_ALL_ACCESS, 0, 0, size );
+    if( !view ) {
+        CloseHandle( m_handle );
+        m_handle = nullptr;
+
+        return false;
+    }
+#else
+    struct stat info;
+
+    // posix shm names start with a slash
+    const auto path = "/" + name;
+
+    m_fd = create ? shm_open( path.c_str(), O_CREAT | O_RDWR, 0600 ) : shm_open( path.c_str(), O_RDWR, 0 );
+    if( m_fd < 0 )
+        return false;
+
+    if( create && ftruncate( m_fd, ( off_t ) size ) != 0 ) {
+        ::close( m_fd );
+        m_fd = -1;
+
+        return false;
+    }
+
+    if( !create ) {
+        if( fstat( m_fd, &info ) != 0 || ( size_t ) info.st_size < sizeof( Header_t ) ) {
+            ::close( m_fd );
+            m_fd = -1;
+
+            return false;
+        }
+
+        size = ( size_t ) info.st_size;
+    }
+
+    view = mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0 );
+    if( view == MAP_FAILED ) {
+        ::close( m_fd );
+        m_fd = -1;
+
+        return false;
+    }
+#endif
+
+    m_header       = ( Header_t * ) view;
+    m_ring         = ( uint8_t * ) view + sizeof( Header_t );
+    m_mapping_size = size;
+    m_name         = name;
+    m_owner        = create;
+
+    return true;
+}
+
+NOINLINE bool OverlayChannel::create( const std::string &name, size_t capacity ) {
+    size_t ring_size;
+
+    close();
+
+    // power of two so positions wrap with a mask, at least a page
+    ring_size = 4096;
+    while( ring_size < capacity )
+        ring_size <<= 1;
+
+    if( !map( name, sizeof( Header_t ) + ring_size, true ) )
+        return false;
+
+    auto header = new( m_header ) Header_t;
+
+    header->m_version  = version;
+    header->m_capacity = ( uint32_t ) ring_size;
+    header->m_head.store( 0, std::memory_order_relaxed );
+    header->m_tail.store( 0, std::memory_order_relaxed );
+    header->m_frames_published.store( 0, std::memory_order_relaxed );
+    header->m_frames_dropped.store( 0, std::memory_order_relaxed );
+    header->m_frames_skipped.store( 0, std::memory_order_relaxed );
+
+    // producers wait for the magic, everything above is visible once they see it
+    header->m_magic.store( magic, std::memory_order_release );
+
+    return true;
+}
+
+NOINLINE bool OverlayChannel::open( const std::string &name ) {
+    close();
+
+    if( !map( name, 0, false ) )
+        return false;
+
+    // not initialized yet or a different layout
+    if( m_header->m_magic.load( std::memory_order_acquire ) != magic || m_header->m_version != version
+     || ( m_mapping_size && m_mapping_size < sizeof( Header_t ) + m_header->m_capacity ) ) {
+        close();
+        return false;
+    }
+
+    m_write = m_header->m_head.load( std::memory_order_relaxed );
+
+    return true;
+}
+
+NOINLINE void OverlayChannel::close() {
+    if( !m_header )
+        return;
+
+#ifdef _WIN32
+    UnmapViewOfFile( m_header );
+    CloseHandle( m_handle );
+
+    m_handle = nullptr;
+#else
+    munmap( m_header, m_mapping_size );
+    ::close( m_fd );
+
+    if( m_owner )
+        shm_unlink( ( "/" + m_name ).c_str() );
+
+    m_fd = -1;
+#endif
+
+    m_header       = nullptr;
+    m_ring         = nullptr;
+    m_mapping_size = 0;
+    m_owner        = false;
+    m_frame_open   = false;
+}
+
+NOINLINE uint8_t *OverlayChannel::reserve_record( uint32_t type, size_t payload_size ) {
+    uint64_t padding;
+
+    if( !m_header || !m_frame_open || m_frame_failed )
+        return nullptr;
+
+    const uint64_t capacity = m_header->m_capacity;
+    const uint64_t size     = ( sizeof( Overlay::Record_t ) + payload_size + 7 ) & ~( uint64_t ) 7;
+
+    // records don't wrap, one that would cross the end starts over at the front behind a pad record
+    auto offset = m_write & ( capacity - 1 );
+
+    padding = offset + size > capacity ? capacity - offset : 0;
+
+    if( m_write + padding + size - m_header->m_tail.load( std::memory_order_acquire ) > capacity ) {
+        m_frame_failed = true;
+        return nullptr;
+    }
+
+    if( padding ) {
+        const Overlay::Record_t pad = { Overlay::RECORD_PAD, ( uint32_t ) padding };
+        std::memcpy( m_ring + offset, &pad, sizeof( pad ) );
+
+        m_write += padding;
+        offset   = 0;
+    }
+
+    const Overlay::Record_t record = { type, ( uint32_t ) size };
+    std::memcpy( m_ring + offset, &record, sizeof( record ) );
+
+    m_write += size;
+
+    return m_ring + offset + sizeof( Overlay::Record_t );
+}
+
+NOINLINE void OverlayChannel::begin_frame() {
+    if( !m_header )
+        return;
+
+    // anything written since the last published frame is thrown away
+    m_write        = m_header->m_head.load( std::memory_order_relaxed );
+    m_frame_open   = true;
+    m_frame_failed = false;
+
+    reserve_record( Overlay::RECORD_FRAME, 0 );
+}
+
+NOINLINE bool OverlayChannel::end_frame() {
+    if( !m_header || !m_frame_open )
+        return false;
+
+    m_frame_open = false;
+
+    if( m_frame_failed ) {
+        m_header->m_frames_dropped.fetch_add( 1, std::memory_order_relaxed );
+        return false;
+    }
+
+    // publish the whole frame to the consumer
+    m_header->m_head.store( m_write, std::memory_order_release );
+    m_header->m_frames_published.fetch_add( 1, std::memory_order_relaxed );
+
+    return true;
+}
+
+NOINLINE void OverlayChannel::add_filled_rect( float x, float y, float w, float h, uint32_t color ) {
+    const Overlay::Rect_t rect = { x, y, w, h, color };
+
+    const auto data = reserve_record( Overlay::RECORD_FILLED_RECT, sizeof( rect ) );
+    if( data )
+        std::memcpy( data, &rect, sizeof( rect ) );
+}
+
+NOINLINE void OverlayChannel::add_line( float start_x, float start_y, float end_x, float end_y, uint32_t color, float thickness ) {
+    const Overlay::Line_t line = { start_x, start_y, end_x, end_y, thickness, color };
+
+    const auto data = reserve_record( Overlay::RECORD_LINE, sizeof( line ) );
+    if( data )
+        std::memcpy( data, &line, sizeof( line ) );
+}
+
+NOINLINE void OverlayChannel::add_text( uint32_t font_id, float x, float y, uint32_t flags, uint32_t color, const std::string &text ) {
+    const Overlay::Text_t header = { font_id, x, y, flags, color, ( uint32_t ) text.size() };
+
+    const auto data = reserve_record( Overlay::RECORD_TEXT, sizeof( header ) + text.size() );
+    if( !data )
+        return;
+
+    std::memcpy( data, &header, sizeof( header ) );
+    std::memcpy( data + sizeof( header ), text.data(), text.size() );
+}
+
+NOINLINE Overlay::Vertex_t *OverlayChannel::reserve_vertices( uint32_t topology, size_t count ) {
+    const Overlay::Vertices_t header = { topology, ( uint32_t ) count };
+
+    const auto data = reserve_record( Overlay::RECORD_VERTICES, sizeof( header ) + count * sizeof( Overlay::Vertex_t ) );
+    if( !data )
+        return nullptr;
+
+    std::memcpy( data, &header, sizeof( header ) );
+
+    return ( Overlay::Vertex_t * ) ( data + sizeof( header ) );
+}
+
+NOINLINE bool OverlayChannel::drain( std::vector< uint8_t > &frame ) {
+    Overlay::Record_t record;
+    size_t            frames;
+
+    if( !m_header )
+        return false;
+
+    const uint64_t capacity = m_header->m_capacity;
+    const auto     head     = m_header->m_head.load( std::memory_order_acquire );
+
+    auto tail = m_header->m_tail.load( std::memory_order_relaxed );
+    if( tail == head )
+        return false;
+
+    frame.clear();
+
+    frames = 0;
+
+    // everything up to head is complete frames, only the last one is kept
+    while( tail < head ) {
+        const auto offset = tail & ( capacity - 1 );
+
+        std::memcpy( &record, m_ring + offset, sizeof( record ) );
+
+        // the producer is another process, don't trust it
+        if( record.m_size < sizeof( record ) || record.m_size % 8 || offset + record.m_size > capacity || tail + record.m_size > head ) {
+            frame.clear();
+            frames = 0;
+            tail   = head;
+
+            break;
+        }
+
+        if( record.m_type == Overlay::RECORD_FRAME ) {
+            frame.clear();
+            ++frames;
+        }
+
+        else if( record.m_type != Overlay::RECORD_PAD )
+            frame.insert( frame.end(), m_ring + offset, m_ring + offset + record.m_size );
+
+        tail += record.m_size;
+    }
+
+    // hand the space back to the producer
+    m_header->m_tail.store( tail, std::memory_order_release );
+
+    if( frames > 1 )
+        m_header->m_frames_skipped.fetch_add( frames - 1, std::memory_order_relaxed );
+
+    return frames > 0;
+}
@@ -0,0 +1,184 @@
+#pragma once
+
+// portable, shared memory is a file mapping on windows and posix shm elsewhere
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <string>
+#include <vector>
+
+#ifndef NOINLINE
+    #define NOINLINE
+#endif
+
+#ifndef FORCEINLINE
+    #define FORCEINLINE inline
+#endif
+
+//
+// Overlay command records
+//
+// a record is a header followed by its payload, sizes are rounded up to 8 bytes so records stay aligned
+// in the ring. colors are packed argb like Color::get, vertices are laid out like Vertex_t
+//
+namespace Overlay {
+
+    enum RecordType : uint32_t {
+        RECORD_PAD = 0,     // filler up to the end of the ring, skipped
+        RECORD_FRAME,       // starts a frame, the consumer keeps the records of the latest complete frame
+        RECORD_FILLED_RECT, // Rect_t
+        RECORD_LINE,        // Line_t
+        RECORD_TEXT,        // Text_t followed by length utf-8 bytes
+        RECORD_VERTICES     // Vertices_t followed by count Vertex_t
+    };
+
+    struct Record_t {
+        uint32_t m_type;
+        uint32_t m_size; // header included
+    };
+
+    struct Rect_t {
+        float    m_x, m_y, m_w, m_h;
+        uint32_t m_color;
+    };
+
+    struct Line_t {
+        float    m_start_x, m_start_y, m_end_x, m_end_y;
+        float    m_thickness;
+        uint32_t m_color;
+    };
+
+    struct Text_t {
+        uint32_t m_font_id;
+        float    m_x, m_y;
+        uint32_t m_flags;
+        uint32_t m_color;
+        uint32_t m_length;
+    };
+
+    struct Vertex_t {
+        float    m_x, m_y, m_z, m_rhw;
+        uint32_t m_color;
+        float    m_u, m_v;
+    };
+
+    struct Vertices_t {
+        uint32_t m_topology; // D3DPRIMITIVETYPE, untextured
+        uint32_t m_count;
+    };
+
+    static_assert( sizeof( Vertex_t ) == 28, "Overlay::Vertex_t must match the renderer vertex" );
+
+}
+
+//
+// Shared memory channel for overlay commands from other processes
+//
+// single producer / single consumer byte ring. the renderer creates the channel and drains it every frame,
+// one external process opens it and writes frames of records. the producer only publishes a frame once it's
+// complete, a frame that doesn't fit the free space is dropped whole and counted, so memory stays bounded
+// and the renderer never sees half a frame. vertex runs are written straight into the ring
+//
+class OverlayChannel {
+public:
+    static constexpr uint32_t magic   = 0x4F585244; // "DRXO"
+    static constexpr uint32_t version = 1;
+
+    struct Header_t {
+        std::atomic< uint32_t > m_magic;    // written last by the creator, the channel is ready once it matches
+        uint32_t                m_version;
+        uint32_t                m_capacity; // ring bytes, power of two
+
+        alignas( 64 ) std::atomic< uint64_t > m_head; // bytes published, written by the producer
+        alignas( 64 ) std::atomic< uint64_t > m_tail; // bytes consumed, written by the consumer
+
+        alignas( 64 ) std::atomic< uint64_t > m_frames_published; // producer counters
+        std::atomic< uint64_t >               m_frames_dropped;   // frames that didn't fit
+        std::atomic< uint64_t >               m_frames_skipped;   // consumer counter, frames replaced by a newer one before they were drawn
+    };
+
+    static_assert( std::atomic< uint64_t >::is_always_lock_free, "shared counters must be lock free to work across processes" );
+
+private:
+    Header_t    *m_header;   // start of the mapping
+    uint8_t     *m_ring;     // ring bytes after the header
+    size_t      m_mapping_size;
+    void        *m_handle;   // file mapping on windows
+    int         m_fd;        // shm descriptor elsewhere
+    std::string m_name;
+    bool        m_owner;     // created the channel, unlinks it on close
+
+    // producer frame state
+    uint64_t    m_write;        // end of the unpublished frame
+    bool        m_frame_open;
+    bool        m_frame_failed; // a record didn't fit, the frame is dropped at end_frame
+
+    // map shared memory, create sizes and initializes it
+    NOINLINE bool map( const std::string &name, size_t size, bool create );
+
+    // producer, reserve a record with payload bytes. nullptr if it doesn't fit
+    NOINLINE uint8_t *reserve_record( uint32_t type, size_t payload_size );
+
+public:
+    // ctor(s)
+    OverlayChannel() : m_header{ nullptr }, m_ring{ nullptr }, m_mapping_size{}, m_handle{ nullptr }, m_fd{ -1 }, m_name{}, m_owner{},
+        m_write{}, m_frame_open{}, m_frame_failed{} {
+
+    }
+
+    // dtor
+    ~OverlayChannel() {
+        close();
+    }
+
+    OverlayChannel( const OverlayChannel & )            = delete;
+    OverlayChannel &operator=( const OverlayChannel & ) = delete;
+
+    // consumer, create the channel with a ring of at least capacity bytes
+    NOINLINE bool create( const std::string &name, size_t capacity );
+
+    // producer, open a channel created by the renderer. fails until it exists
+    NOINLINE bool open( const std::string &name );
+
+    NOINLINE void close();
+
+    FORCEINLINE bool is_open() const {
+        return m_header != nullptr;
+    }
+
+    //
+    // producer
+    //
+    // start a frame, records before end_frame are published together
+    NOINLINE void begin_frame();
+
+    // publish the frame, false if it was dropped
+    NOINLINE bool end_frame();
+
+    NOINLINE void add_filled_rect( float x, float y, float w, float h, uint32_t color );
+
+    NOINLINE void add_line( float start_x, float start_y, float end_x, float end_y, uint32_t color, float thickness = 1.f );
+
+    NOINLINE void add_text( uint32_t font_id, float x, float y, uint32_t flags, uint32_t color, const std::string &text );
+
+    // vertices written in place, nullptr if the run doesn't fit
+    NOINLINE Overlay::Vertex_t *reserve_vertices( uint32_t topology, size_t count );
+
+    //
+    // consumer
+    //
+    // move the records of the latest complete frame into frame, false if no new frame was published
+    NOINLINE bool drain( std::vector< uint8_t > &frame );
+
+    FORCEINLINE uint64_t get_frames_published() const {
+        return m_header ? m_header->m_frames_published.load( std::memory_order_relaxed ) : 0;
+    }
+
+    FORCEINLINE uint64_t get_frames_dropped() const {
+        return m_header ? m_header->m_frames_dropped.load( std::memory_order_relaxed ) : 0;
+    }
+
+    FORCEINLINE uint64_t get_frames_skipped() const {
+        return m_header ? m_header->m_frames_skipped.load( std::memory_order_relaxed ) : 0;
+    }
+};
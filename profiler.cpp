@@ -0,0 +1,200 @@
+#include "includes.h"
+
+namespace Profiler {
+
+    std::atomic< bool > g_enabled{};
+
+    namespace {
+
+        std::atomic< uint32_t > g_generation{ 1 };    // current capture generation
+        std::atomic< uint64_t > g_capture_start{};    // capture start timestamp
+        std::atomic< uint64_t > g_zone_overhead_ns{}; // measured cost of an empty zone
+
+        // registered thread buffers, the lock is only taken once per thread and when dumping
+        std::mutex                                     g_buffers_mutex;
+        std::vector< std::shared_ptr< ThreadBuffer > > g_buffers;
+
+        // buffer of the calling thread, registered on first use
+        NOINLINE ThreadBuffer *get_thread_buffer() {
+            thread_local std::shared_ptr< ThreadBuffer > buffer;
+
+            if( !buffer ) {
+                std::lock_guard< std::mutex > lock( g_buffers_mutex );
+
+                buffer = std::make_shared< ThreadBuffer >( ( uint32_t ) g_buffers.size() + 1 );
+                g_buffers.push_back( buffer );
+            }
+
+            return buffer.get();
+        }
+
+        // write string as json string literal
+        NOINLINE void write_json_string( FILE *file, const char *str ) {
+            std::fputc( '"', file );
+
+            for( auto it = str; *it; ++it ) {
+                if( *it == '"' || *it == '\\' )
+                    std::fputc( '\\', file );
+
+                // control characters are never part of zone names, drop them
+                if( ( uint8_t ) *it >= 0x20 )
+                    std::fputc( *it, file );
+            }
+
+            std::fputc( '"', file );
+        }
+
+    }
+
+    NOINLINE void ThreadBuffer::push( const char *name, uint64_t start, uint64_t end ) {
+        size_t count;
+
+        // a new capture was started since our last event, reset our own buffer.
+        // the count is cleared before the generation is published so a dump never sees stale events.
+        const auto generation = g_generation.load( std::memory_order_relaxed );
+        if( m_generation.load( std::memory_order_relaxed ) != generation ) {
+            m_count.store( 0, std::memory_order_relaxed );
+            m_dropped.store( 0, std::memory_order_relaxed );
+            m_generation.store( generation, std::memory_order_release );
+
+            // the events written below can't move above the new generation, a dump checks it again after copying
+            std::atomic_thread_fence( std::memory_order_release );
+        }
+
+        // bounded memory, drop the event when full
+        count = m_count.load( std::memory_order_relaxed );
+        if( count >= capacity ) {
+            m_dropped.fetch_add( 1, std::memory_order_relaxed );
+            return;
+        }
+
+        m_events[ count ] = { name, start, end };
+
+        // publish event to readers
+        m_count.store( count + 1, std::memory_order_release );
+    }
+
+    NOINLINE void begin_capture() {
+        g_capture_start.store( now(), std::memory_order_relaxed );
+        g_generation.fetch_add( 1, std::memory_order_relaxed );
+        g_enabled.store( true, std::memory_order_release );
+    }
+
+    NOINLINE void end_capture() {
+        g_enabled.store( false, std::memory_order_release );
+    }
+
+    NOINLINE void set_thread_name( const std::string &name ) {
+        auto buffer = get_thread_buffer();
+
+        std::lock_guard< std::mutex > lock( g_buffers_mutex );
+        buffer->m_name = name;
+    }
+
+    NOINLINE double calibrate( size_t iterations ) {
+        ThreadBuffer scratch( 0 );
+        uint64_t     start, end;
+
+        if( !iterations )
+            return 0.0;
+
+        // time the exact work a zone does, into a scratch buffer so the capture isn't polluted
+        start = now();
+
+        for( size_t i = 0; i < iterations; ++i ) {
+            const auto zone_start = now();
+            scratch.push( "calibrate", zone_start, now() );
+
+            // keep the buffer from filling up, a full buffer takes the cheaper drop path
+            if( scratch.m_count.load( std::memory_order_relaxed ) == ThreadBuffer::capacity )
+                scratch.m_count.store( 0, std::memory_order_relaxed );
+        }
+
+        end = now();
+
+        g_zone_overhead_ns.store( ( end - start ) / iterations, std::memory_order_relaxed );
+
+        return ( double ) ( end - start ) / ( double ) iterations;
+    }
+
+    NOINLINE size_t get_dropped_count() {
+        size_t dropped = 0;
+
+        std::lock_guard< std::mutex > lock( g_buffers_mutex );
+
+        const auto generation = g_generation.load( std::memory_order_relaxed );
+        for( const auto &buffer : g_buffers ) {
+            if( buffer->m_generation.load( std::memory_order_acquire ) == generation )
+                dropped += buffer->m_dropped.load( std::memory_order_relaxed );
+        }
+
+        return dropped;
+    }
+
+    NOINLINE void record( const char *name, uint64_t start, uint64_t end ) {
+        get_thread_buffer()->push( name, start, end );
+    }
+
+    NOINLINE bool dump_chrome_trace( const std::string &path ) {
+        FILE                  *file;
+        bool                   first;
+        std::vector< Event_t > events;
+
+        file = std::fopen( path.c_str(), "wb" );
+        if( !file )
+            return false;
+
+        const auto dropped = get_dropped_count();
+
+        std::lock_guard< std::mutex > lock( g_buffers_mutex );
+
+        const auto generation = g_generation.load( std::memory_order_relaxed );
+        const auto base       = g_capture_start.load( std::memory_order_relaxed );
+
+        std::fprintf( file, "{\"displayTimeUnit\":\"ns\",\"otherData\":{\"zone_overhead_ns\":%llu,\"dropped_events\":%zu},\"traceEvents\":[",
+            ( unsigned long long ) g_zone_overhead_ns.load( std::memory_order_relaxed ), dropped );
+
+        first = true;
+
+        for( const auto &buffer : g_buffers ) {
+            // buffer hasn't recorded anything during this capture
+            if( buffer->m_generation.load( std::memory_order_acquire ) != generation )
+                continue;
+
+            // events below the published count are complete, the owner may keep recording while we copy.
+            // if it moved on to a newer capture meanwhile it may have overwritten them, skip the buffer
+            const auto count = buffer->m_count.load( std::memory_order_acquire );
+            events.assign( buffer->m_events.get(), buffer->m_events.get() + count );
+
+            std::atomic_thread_fence( std::memory_order_acquire );
+            if( buffer->m_generation.load( std::memory_order_relaxed ) != generation )
+                continue;
+
+            // thread name metadata
+            if( !buffer->m_name.empty() ) {
+                std::fprintf( file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", first ? "" : ",", buffer->m_thread_id );
+                write_json_string( file, buffer->m_name.c_str() );
+                std::fputs( "}}", file );
+
+                first = false;
+            }
+
+            for( const auto &event : events ) {
+                const auto start = event.m_start > base ? event.m_start - base : 0;
+
+                std::fprintf( file, "%s{\"name\":", first ? "" : "," );
+                write_json_string( file, event.m_name );
+                std::fprintf( file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                    buffer->m_thread_id, ( double ) start / 1000.0, ( double ) ( event.m_end - event.m_start ) / 1000.0 );
+
+                first = false;
+            }
+        }
+
+        std::fputs( "]}", file );
+        std::fclose( file );
+
+        return true;
+    }
+
+}
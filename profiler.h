@@ -0,0 +1,112 @@
+#pragma once
+
+//
+// scoped-zone timeline profiler
+//
+// every thread records into its own fixed size event buffer, the owning thread is the only writer so
+// recording never takes a lock. buffers are dumped on demand to the chrome trace event json format,
+// which loads in chrome://tracing and https://ui.perfetto.dev.
+//
+// zones are compiled out entirely unless RENDERER_PROFILING is defined, and when compiled in they
+// cost a single relaxed load while capturing is disabled.
+//
+namespace Profiler {
+
+    // single timeline event
+    struct Event_t {
+        const char *m_name;  // zone name, must have static storage duration
+        uint64_t    m_start; // start timestamp in nanoseconds
+        uint64_t    m_end;   // end timestamp in nanoseconds
+    };
+
+    //
+    // Per thread event buffer
+    //
+    class ThreadBuffer {
+    public:
+        static constexpr size_t capacity = 16384;
+
+        std::unique_ptr< Event_t[] > m_events;     // event storage
+        std::atomic< size_t >        m_count;      // published event count
+        std::atomic< size_t >        m_dropped;    // events dropped because the buffer was full
+        std::atomic< uint32_t >      m_generation; // capture generation the events belong to
+        uint32_t                     m_thread_id;  // sequential thread id
+        std::string                  m_name;       // thread name
+
+        // ctor(s)
+        FORCEINLINE ThreadBuffer( uint32_t thread_id ) : m_events{ std::make_unique< Event_t[] >( capacity ) }, m_count{}, m_dropped{}, m_generation{}, m_thread_id{ thread_id }, m_name{} {
+
+        }
+
+        // append event, only called from the owning thread
+        NOINLINE void push( const char *name, uint64_t start, uint64_t end );
+    };
+
+    // current timestamp in nanoseconds
+    FORCEINLINE uint64_t now() {
+        return ( uint64_t ) std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now().time_since_epoch() ).count();
+    }
+
+    // capture running? read through enabled(), set by begin_capture / end_capture
+    extern std::atomic< bool > g_enabled;
+
+    // is a capture running?
+    FORCEINLINE bool enabled() {
+        return g_enabled.load( std::memory_order_relaxed );
+    }
+
+    // start a new capture, previously recorded events are discarded
+    NOINLINE void begin_capture();
+
+    // stop capturing, recorded events are kept until the next capture
+    NOINLINE void end_capture();
+
+    // name the calling thread in the trace
+    NOINLINE void set_thread_name( const std::string &name );
+
+    // measure the cost of recording an empty zone, returns average nanoseconds per zone
+    NOINLINE double calibrate( size_t iterations = 10000 );
+
+    // total events dropped across all threads in the current capture
+    NOINLINE size_t get_dropped_count();
+
+    // write recorded events as chrome trace json. threads keep recording while it runs, a thread that starts
+    // a capture begun meanwhile resets its buffer and is left out of the dump instead of read half overwritten
+    NOINLINE bool dump_chrome_trace( const std::string &path );
+
+    // record event for the calling thread
+    NOINLINE void record( const char *name, uint64_t start, uint64_t end );
+
+    //
+    // RAII zone, records [ctor, dtor) on the calling thread
+    //
+    class ScopedZone {
+    private:
+        const char *m_name;
+        uint64_t    m_start;
+
+    public:
+        // ctor(s)
+        FORCEINLINE ScopedZone( const char *name ) : m_name{ name }, m_start{} {
+            if( enabled() )
+                m_start = now();
+        }
+
+        // dtor
+        FORCEINLINE ~ScopedZone() {
+            if( m_start )
+                record( m_name, m_start, now() );
+        }
+    };
+
+}
+
+#ifdef RENDERER_PROFILING
+    #define PROFILE_CONCAT_IMPL( a, b ) a##b
+    #define PROFILE_CONCAT( a, b )      PROFILE_CONCAT_IMPL( a, b )
+    #define PROFILE_SCOPE( name )       Profiler::ScopedZone PROFILE_CONCAT( profile_zone_, __LINE__ ){ name }
+    #define PROFILE_FUNCTION()          PROFILE_SCOPE( __FUNCTION__ )
+#else
+    #define PROFILE_SCOPE( name )
+    #define PROFILE_FUNCTION()
+#endif
@@ -0,0 +1,81 @@
+#pragma once
+
+// portable, also builds without the windows / d3d headers
+#include <vector>
+
+#ifndef FORCEINLINE
+    #define FORCEINLINE inline
+#endif
+
+//
+// Shelf rectangle packer for atlas pages
+//
+// rects are placed left to right on horizontal shelves, a new shelf is opened below the last one
+// when no existing shelf has room. the shelf with the least wasted height is preferred.
+//
+class RectPacker {
+public:
+    struct Shelf_t {
+        size_t m_y;      // top of shelf
+        size_t m_height; // shelf height
+        size_t m_x;      // next free x
+    };
+
+    size_t                 m_width, m_height; // page dimensions
+    size_t                 m_padding;         // empty pixels kept around each rect
+    std::vector< Shelf_t > m_shelves;         // open shelves
+
+    // ctor(s)
+    FORCEINLINE RectPacker() : m_width{}, m_height{}, m_padding{}, m_shelves{} {
+
+    }
+
+    FORCEINLINE RectPacker( size_t width, size_t height, size_t padding ) : m_width{ width }, m_height{ height }, m_padding{ padding }, m_shelves{} {
+
+    }
+
+    // forget all packed rects
+    FORCEINLINE void reset() {
+        m_shelves.clear();
+    }
+
+    // find a spot for a width x height rect, returns false if the page is full
+    FORCEINLINE bool pack( size_t width, size_t height, size_t &x, size_t &y ) {
+        Shelf_t *best;
+        size_t   next_y;
+
+        const auto padded_width  = width + m_padding * 2;
+        const auto padded_height = height + m_padding * 2;
+
+        if( padded_width > m_width || padded_height > m_height )
+            return false;
+
+        // pick the fitting shelf that wastes the least height
+        best = nullptr;
+
+        for( auto &shelf : m_shelves ) {
+            if( shelf.m_height < padded_height || m_width - shelf.m_x < padded_width )
+                continue;
+
+            if( !best || shelf.m_height < best->m_height )
+                best = &shelf;
+        }
+
+        // open a new shelf below the last one
+        if( !best ) {
+            next_y = m_shelves.empty() ? 0 : m_shelves.back().m_y + m_shelves.back().m_height;
+            if( m_height - next_y < padded_height )
+                return false;
+
+            m_shelves.push_back( { next_y, padded_height, 0 } );
+            best = &m_shelves.back();
+        }
+
+        x = best->m_x + m_padding;
+        y = best->m_y + m_padding;
+
+        best->m_x += padded_width;
+
+        return true;
+    }
+};
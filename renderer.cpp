@@ -1,7 +1,24 @@
 #include "includes.h"
 
-NOINLINE bool Renderer::init( IDirect3DDevice9 *device, size_t max_vertices ) {
+namespace {
+
+    // is primitve type a list?
+    NOINLINE bool is_toplogy_list( D3DPRIMITIVETYPE topology );
+
+    // primitive type grouping order
+    NOINLINE int get_topology_order( D3DPRIMITIVETYPE topology );
+
+    // clip line segment to rect, returns false if the segment is fully outside
+    NOINLINE bool clip_line( Vec2_t &start, Vec2_t &end, const Rect_t &rect );
+
+    // clip convex polygon to rect in place, scratch is used as temporary storage
+    NOINLINE void clip_polygon( std::vector< Vec2_t > &points, const Rect_t &rect, std::vector< Vec2_t > &scratch );
+
+}
+
+NOINLINE bool Renderer::init( IDirect3DDevice9 *device, size_t max_vertices, size_t worker_count ) {
     D3DVIEWPORT9 viewport;
+    D3DCAPS9     caps;
 
     if( !device || !max_vertices )
         return false;
@@ -15,15 +32,200 @@ NOINLINE bool Renderer::init( IDirect3DDevice9 *device, size_t max_vertices ) {
     m_max_vertices = max_vertices;
     m_width        = viewport.Width;
     m_height       = viewport.Height;
+    m_max_instances = std::max< size_t >( max_vertices / 6, 1 );
+
+    // stream frequency instancing needs vs_3_0, which needs a ps_3_0 partner
+    m_instancing_supported = device->GetDeviceCaps( &caps ) >= 0 
+        && caps.VertexShaderVersion >= D3DVS_VERSION( 3, 0 ) && caps.PixelShaderVersion >= D3DPS_VERSION( 3, 0 );
 
     // create vertex buffer / etc.
     if( !reacquire() )
         return false;
 
+    // compile shaders, managed by us so they survive device resets
+    if( !create_shaders() )
+        return false;
+
+    create_instance_shaders();
+
+    // workers for font creation
+    if( !m_thread_pool.init( worker_count ) )
+        return false;
+
     return true;
 }
 
+NOINLINE bool Renderer::create_shaders() {
+    ID3DXBuffer *shader_buffer, *error_buffer;
+
+    // distance field text, c0.x is the edge softness and c0.y the edge in distance units ( 0.5 is the glyph outline ).
+    // the distance is stored in alpha, color comes from the vertex
+    constexpr char sdf_shader_source[] =
+        "sampler s0 : register( s0 );"
+        "float4 c0 : register( c0 );"
+        "float4 main( float4 color : COLOR0, float2 uv : TEXCOORD0 ) : COLOR0 {"
+        "    float distance = tex2D( s0, uv ).a;"
+        "    float alpha    = smoothstep( c0.y - c0.x, c0.y + c0.x, distance );"
+        "    return float4( color.rgb, color.a * alpha );"
+        "}";
+
+    // layer textures, drawing into a cleared target leaves premultiplied color behind. 
+    // undone here so the texture blends like everything else
+    constexpr char layer_shader_source[] =
+        "sampler s0 : register( s0 );"
+        "float4 main( float4 color : COLOR0, float2 uv : TEXCOORD0 ) : COLOR0 {"
+        "    float4 texel = tex2D( s0, uv );"
+        "    return float4( texel.rgb / max( texel.a, 0.001f ), texel.a ) * color;"
+        "}";
+
+    // sprites, full color textures tinted by the vertex color
+    constexpr char sprite_shader_source[] =
+        "sampler s0 : register( s0 );"
+        "float4 main( float4 color : COLOR0, float2 uv : TEXCOORD0 ) : COLOR0 {"
+        "    return tex2D( s0, uv ) * color;"
+        "}";
+
+    const auto compile = [ & ]( const char *source, size_t length, IDirect3DPixelShader9 **shader ) {
+        if( *shader )
+            return true;
+
+        shader_buffer = nullptr;
+        error_buffer  = nullptr;
+
+        if( D3DXCompileShader( source, ( UINT ) length, nullptr, nullptr, "main", "ps_2_0", 0, &shader_buffer, &error_buffer, nullptr ) != D3D_OK ) {
+            Utils::safe_release( &error_buffer );
+            return false;
+        }
+
+        Utils::safe_release( &error_buffer );
+
+        const auto result = m_device->CreatePixelShader( ( const DWORD * ) shader_buffer->GetBufferPointer(), shader );
+
+        Utils::safe_release( &shader_buffer );
+
+        return result == D3D_OK;
+    };
+
+    return compile( sdf_shader_source, sizeof( sdf_shader_source ) - 1, &m_sdf_shader ) 
+        && compile( layer_shader_source, sizeof( layer_shader_source ) - 1, &m_layer_shader )
+        && compile( sprite_shader_source, sizeof( sprite_shader_source ) - 1, &m_sprite_shader );
+}
+
+NOINLINE void Renderer::create_instance_shaders() {
+    ID3DXBuffer *shader_buffer, *error_buffer;
+
+    // c0.xy is 2 / viewport size ( y flipped ), c0.zw moves to clip space including the half pixel offset of pretransformed vertices
+    constexpr char vertex_shader_source[] =
+        "float4 c0 : register( c0 );"
+        "struct output_t { float4 pos : POSITION; float4 color : COLOR0; float2 uv : TEXCOORD0; };"
+        "output_t main( float2 corner : POSITION, float4 rect : TEXCOORD1, float4 color : COLOR0, float4 uv : TEXCOORD2 ) {"
+        "    output_t output;"
+        "    float2 pos = rect.xy + corner * rect.zw;"
+        "    output.pos   = float4( pos * c0.xy + c0.zw, 0.f, 1.f );"
+        "    output.color = color;"
+        "    output.uv    = lerp( uv.xy, uv.zw, corner );"
+        "    return output;"
+        "}";
+
+    // c0.x is 1 for textured batches. same as the fixed function stage 0 setup, color from the vertex and alpha from the
+    // texture alone, so glyphs look the same on both paths
+    constexpr char pixel_shader_source[] =
+        "sampler s0 : register( s0 );"
+        "float4 c0 : register( c0 );"
+        "float4 main( float4 color : COLOR0, float2 uv : TEXCOORD0 ) : COLOR0 {"
+        "    if( c0.x > 0.f )"
+        "        return float4( color.rgb, tex2D( s0, uv ).a );"
+        "    return color;"
+        "}";
+
+    // unit quad corner in stream 0, Instance_t in stream 1
+    constexpr D3DVERTEXELEMENT9 elements[] = {
+        { 0, 0,  D3DDECLTYPE_FLOAT2,   D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_POSITION, 0 },
+        { 1, 0,  D3DDECLTYPE_FLOAT4,   D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_TEXCOORD, 1 },
+        { 1, 16, D3DDECLTYPE_D3DCOLOR, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_COLOR,    0 },
+        { 1, 20, D3DDECLTYPE_FLOAT4,   D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_TEXCOORD, 2 },
+        D3DDECL_END()
+    };
+
+    if( !m_instancing_supported || m_instance_vs )
+        return;
+
+    const auto compile = [ & ]( const char *source, size_t length, const char *profile ) {
+        shader_buffer = nullptr;
+        error_buffer  = nullptr;
+
+        const auto result = D3DXCompileShader( source, ( UINT ) length, nullptr, nullptr, "main", profile, 0, &shader_buffer, &error_buffer, nullptr );
+
+        Utils::safe_release( &error_buffer );
+
+        return result == D3D_OK;
+    };
+
+    if( compile( vertex_shader_source, sizeof( vertex_shader_source ) - 1, "vs_3_0" ) ) {
+        m_device->CreateVertexShader( ( const DWORD * ) shader_buffer->GetBufferPointer(), &m_instance_vs );
+
+        Utils::safe_release( &shader_buffer );
+    }
+
+    if( compile( pixel_shader_source, sizeof( pixel_shader_source ) - 1, "ps_3_0" ) ) {
+        m_device->CreatePixelShader( ( const DWORD * ) shader_buffer->GetBufferPointer(), &m_instance_ps );
+
+        Utils::safe_release( &shader_buffer );
+    }
+
+    m_device->CreateVertexDeclaration( elements, &m_instance_declaration );
+
+    // stay on the vertex path
+    if( !m_instance_vs || !m_instance_ps || !m_instance_declaration ) {
+        Utils::safe_release( &m_instance_declaration );
+        Utils::safe_release( &m_instance_vs );
+        Utils::safe_release( &m_instance_ps );
+
+        m_instancing_supported = false;
+        m_instancing           = false;
+    }
+}
+
+NOINLINE void Renderer::create_instance_buffers() {
+    void *data;
+
+    // corners in triangle strip order, indexed as 2 triangles
+    constexpr float    corners[]  = { 0.f, 0.f, 1.f, 0.f, 0.f, 1.f, 1.f, 1.f };
+    constexpr uint16_t indices[]  = { 0, 1, 2, 1, 3, 2 };
+
+    if( !m_instancing_supported )
+        return;
+
+    const auto fail = [ & ]() {
+        Utils::safe_release( &m_instance_buffer );
+        Utils::safe_release( &m_quad_buffer );
+        Utils::safe_release( &m_quad_indices );
+
+        m_instancing_supported = false;
+        m_instancing           = false;
+    };
+
+    if( m_device->CreateVertexBuffer( ( UINT ) ( m_max_instances * sizeof( Instance_t ) ), ( D3DUSAGE_DYNAMIC | D3DUSAGE_WRITEONLY ), 0, D3DPOOL_DEFAULT, &m_instance_buffer, nullptr ) < 0 
+     || m_device->CreateVertexBuffer( sizeof( corners ), D3DUSAGE_WRITEONLY, 0, D3DPOOL_DEFAULT, &m_quad_buffer, nullptr ) < 0 
+     || m_device->CreateIndexBuffer( sizeof( indices ), D3DUSAGE_WRITEONLY, D3DFMT_INDEX16, D3DPOOL_DEFAULT, &m_quad_indices, nullptr ) < 0 )
+        return fail();
+
+    if( m_quad_buffer->Lock( 0, 0, &data, 0 ) < 0 )
+        return fail();
+
+    std::memcpy( data, corners, sizeof( corners ) );
+    m_quad_buffer->Unlock();
+
+    if( m_quad_indices->Lock( 0, 0, &data, 0 ) < 0 )
+        return fail();
+
+    std::memcpy( data, indices, sizeof( indices ) );
+    m_quad_indices->Unlock();
+}
+
 NOINLINE bool Renderer::reacquire() {
+    PROFILE_FUNCTION();
+
     release();
 
     // create vertex buffer
@@ -34,6 +236,8 @@ NOINLINE bool Renderer::reacquire() {
     if( m_device->CreateStateBlock( D3DSBT_ALL, &m_render_state_block ) < 0 )
         return false;
 
+    create_instance_buffers();
+
     return true;
 }
 
@@ -109,22 +313,161 @@ NOINLINE void Renderer::begin() {
     m_device->SetSamplerState( 0, D3DSAMP_MINFILTER, D3DTEXF_LINEAR );
 }
 
-NOINLINE void Renderer::flush() {
-    void   *data;
-    size_t order, primitive_count, batch_pos;
+NOINLINE void Renderer::begin_instancing() {
+    // pretransformed vertices have pixel centers on integer coordinates, move by half a pixel to match
+    const float viewport_transform[ 4 ] = { 
+        2.f / ( float ) m_width, -2.f / ( float ) m_height, -1.f - 1.f / ( float ) m_width, 1.f + 1.f / ( float ) m_height 
+    };
+
+    m_device->SetVertexDeclaration( m_instance_declaration );
+    m_device->SetVertexShader( m_instance_vs );
+    m_device->SetPixelShader( m_instance_ps );
+    m_device->SetVertexShaderConstantF( 0, viewport_transform, 1 );
+    m_device->SetStreamSource( 0, m_quad_buffer, 0, sizeof( Vec2_t ) );
+    m_device->SetStreamSourceFreq( 1, D3DSTREAMSOURCE_INSTANCEDATA | 1u );
+    m_device->SetIndices( m_quad_indices );
+}
+
+NOINLINE void Renderer::end_instancing() {
+    m_device->SetStreamSourceFreq( 0, 1 );
+    m_device->SetStreamSourceFreq( 1, 1 );
+    m_device->SetStreamSource( 1, nullptr, 0, 0 );
+
+    // back to the state begin set up
+    m_device->SetVertexShader( nullptr );
+    m_device->SetPixelShader( nullptr );
+    m_device->SetFVF( CUSTOM_VERTEX_TYPE );
+    m_device->SetStreamSource( 0, m_vertex_buffer, 0, sizeof( Vertex_t ) );
+}
+
+NOINLINE uint64_t Renderer::hash_render_list() const {
+    uint64_t hash;
+
+    PROFILE_FUNCTION();
+
+    // vertices and instances have no padding, hashed as raw bytes
+    hash = Utils::hash_bytes( m_render_list.m_vertices.data(), m_render_list.m_vertices.size() * sizeof( Vertex_t ) );
+    hash = Utils::hash_bytes( m_render_list.m_instances.data(), m_render_list.m_instances.size() * sizeof( Instance_t ), hash );
+
+    // batches field by field, their padding is undefined
+    for( const auto &b : m_render_list.m_batches ) {
+        const uint64_t fields[ 6 ] = {
+            b.m_count, ( uint64_t ) b.m_topology, ( uint64_t ) ( uintptr_t ) b.m_texture, ( uint64_t ) ( uintptr_t ) b.m_pixel_shader,
+            Utils::hash_bytes( &b.m_shader_params, sizeof( b.m_shader_params ) ), b.m_instanced
+        };
+
+        hash = Utils::hash_bytes( fields, sizeof( fields ), hash );
+    }
+
+    return hash;
+}
+
+NOINLINE bool Renderer::upload_render_list() {
+    void *data;
+
+    // a failed upload leaves the buffers in an unknown state
+    m_upload_valid = false;
 
     // lock vertex buffer and copy our vertices over.
-    if( m_vertex_buffer->Lock( 0, 0, &data, D3DLOCK_DISCARD ) < 0 )
-        return;
+    {
+        PROFILE_SCOPE( "Renderer::flush lock" );
+
+        if( m_vertex_buffer->Lock( 0, 0, &data, D3DLOCK_DISCARD ) < 0 )
+            return false;
+    }
 
-    std::memcpy( data, m_render_list.m_vertices.data(), m_render_list.m_vertices.size() * sizeof( Vertex_t ) );
+    {
+        PROFILE_SCOPE( "Renderer::flush memcpy" );
+
+        std::memcpy( data, m_render_list.m_vertices.data(), m_render_list.m_vertices.size() * sizeof( Vertex_t ) );
+    }
 
     m_vertex_buffer->Unlock();
 
-    batch_pos = 0;
+    if( !m_render_list.m_instances.empty() ) {
+        PROFILE_SCOPE( "Renderer::flush instances" );
+
+        if( !m_instance_buffer || m_instance_buffer->Lock( 0, 0, &data, D3DLOCK_DISCARD ) < 0 )
+            return false;
+
+        std::memcpy( data, m_render_list.m_instances.data(), m_render_list.m_instances.size() * sizeof( Instance_t ) );
+
+        m_instance_buffer->Unlock();
+    }
+
+    return true;
+}
+
+NOINLINE void Renderer::flush() {
+    size_t order, primitive_count, batch_pos, instance_pos;
+    bool   instanced;
+
+    PROFILE_FUNCTION();
+
+    const auto start = Profiler::now();
+
+    // static frames ( menus, hud ) are already in the buffers, only the draw calls are issued again
+    if( m_reuse_uploads ) {
+        const auto hash = hash_render_list();
+
+        if( m_upload_valid && hash == m_upload_hash )
+            m_stats.m_upload_skips++;
+
+        else {
+            if( !upload_render_list() )
+                return;
+
+            m_upload_hash  = hash;
+            m_upload_valid = true;
+        }
+    }
+
+    else if( !upload_render_list() )
+        return;
+
+    PROFILE_SCOPE( "Renderer::flush draw" );
+
+    batch_pos    = 0;
+    instance_pos = 0;
+    instanced    = false;
+
+    IDirect3DPixelShader9 *pixel_shader = nullptr;
 
     // render batch
     for( const auto &b : m_render_list.m_batches ) {
+        // unit quad indexed once per instance
+        if( b.m_instanced ) {
+            if( !b.m_count )
+                continue;
+
+            if( !instanced ) {
+                begin_instancing();
+
+                instanced    = true;
+                pixel_shader = m_instance_ps;
+            }
+
+            const float shader_params[ 4 ] = { b.m_texture ? 1.f : 0.f, 0.f, 0.f, 0.f };
+            m_device->SetPixelShaderConstantF( 0, shader_params, 1 );
+
+            m_device->SetStreamSourceFreq( 0, D3DSTREAMSOURCE_INDEXEDDATA | ( UINT ) b.m_count );
+            m_device->SetStreamSource( 1, m_instance_buffer, ( UINT ) ( instance_pos * sizeof( Instance_t ) ), sizeof( Instance_t ) );
+            m_device->SetTexture( 0, b.m_texture );
+            m_device->DrawIndexedPrimitive( D3DPT_TRIANGLELIST, 0, 0, 4, 0, 2 );
+
+            instance_pos += b.m_count;
+
+            m_stats.m_draw_calls++;
+            continue;
+        }
+
+        if( instanced ) {
+            end_instancing();
+
+            instanced    = false;
+            pixel_shader = nullptr;
+        }
+
         order = get_topology_order( b.m_topology );
         if( !b.m_count || !order )
             continue;
@@ -137,562 +480,3360 @@ NOINLINE void Renderer::flush() {
         else
             primitive_count -= ( order - 1 );
 
+        // fixed function unless the batch brings its own shader
+        if( b.m_pixel_shader != pixel_shader ) {
+            pixel_shader = b.m_pixel_shader;
+            m_device->SetPixelShader( pixel_shader );
+        }
+
+        if( pixel_shader ) {
+            const float shader_params[ 4 ] = { b.m_shader_params.x, b.m_shader_params.y, 0.f, 0.f };
+            m_device->SetPixelShaderConstantF( 0, shader_params, 1 );
+        }
+
         // render
         m_device->SetTexture( 0, b.m_texture );
         m_device->DrawPrimitive( b.m_topology, batch_pos, primitive_count );
 
         batch_pos += b.m_count;
+
+        m_stats.m_draw_calls++;
     }
 
+    if( instanced )
+        end_instancing();
+
+    m_stats.m_batches  += m_render_list.m_batches.size();
+    m_stats.m_flush_ns += Profiler::now() - start;
+
     m_render_list.clear();
 }
 
-NOINLINE void Renderer::render() {
-    size_t num_vertices;
-
-    // dont render if list entry
-    num_vertices = m_render_list.m_vertices.size();
-    if( !num_vertices )
+NOINLINE void Renderer::on_lost() {
+    if( m_device_lost )
         return;
 
-    // increase vertex buffer
-    if( num_vertices > m_max_vertices ) {
-        m_max_vertices = num_vertices;
-
-        if( !reacquire() )
-            return;
-    }
+    release();
+    release_layers();
 
-    // render
-    begin();
-    flush();
-    end();
+    m_device_lost = true;
 }
 
-NOINLINE void Renderer::end() {
-    // apply old render state
-    m_render_state_block->Apply();
-}
+NOINLINE bool Renderer::on_reset() {
+    PROFILE_FUNCTION();
 
-NOINLINE void Renderer::release() {
-    Utils::safe_release( &m_vertex_buffer );
-    Utils::safe_release( &m_render_state_block );
-}
+    const auto start = Profiler::now();
 
-NOINLINE void Renderer::add_vertices( Vertex_t *vertex_array, size_t vertex_count, D3DPRIMITIVETYPE topology, IDirect3DTexture9 *texture ) {
-    auto vertices = &m_render_list.m_vertices;
-    auto batches  = &m_render_list.m_batches;
+    // the back buffer may have a new size
+    if( !resize() )
+        return false;
 
-    // add verticies to list
-    for( size_t i = 0; i < vertex_count; ++i )
-        vertices->push_back( vertex_array[ i ] );
+    if( !reacquire() )
+        return false;
 
-    //  create new batch if needed
-    if( batches->empty() 
-      || batches->back().m_topology != topology 
-      || batches->back().m_texture != texture )
-        batches->push_back( { topology, texture } );
+    m_device_lost = false;
 
-    batches->back().m_count += vertex_count;
+    m_stats.m_resets++;
+    m_stats.m_reset_ns += Profiler::now() - start;
+
+    return true;
 }
 
-NOINLINE font_id_t Renderer::create_font( const std::string &ttf_font, size_t size, bool anti_alias ) {
-    font_ptr_t font = std::make_unique< Font >();
+NOINLINE bool Renderer::resize() {
+    D3DVIEWPORT9 viewport;
 
-    if( !font->init( m_device, ttf_font, size, anti_alias ) )
-        return 0;
+    if( !m_device || m_device->GetViewport( &viewport ) < 0 )
+        return false;
 
-    m_fonts.push_back( std::move( font ) );
+    resize( viewport.Width, viewport.Height );
 
-    return m_fonts.size() - 1;
+    return true;
 }
 
-NOINLINE std::string Renderer::get_font_path( const std::string &font_name ) {
-    HKEY        reg_key;
-    char        name_buf[ MAX_PATH ];
-    size_t      reg_index;
-    ulong_t     ret_buf_size;
-    std::string ttf_font_name;
-
-    // open registry key
-    RegOpenKeyEx( HKEY_LOCAL_MACHINE, "Software\\Microsoft\\Windows NT\\CurrentVersion\\Fonts", 0, KEY_READ, &reg_key );
-
-    // start itteration at first registry entry
-    reg_index = 0;
-
-    // iterate over registry key values
-    while( true ) {
-        // clear name buffer
-        memset( name_buf, 0, MAX_PATH );
-        
-        ret_buf_size = MAX_PATH;
-
-        // get name of regsitry value
-        // layout:
-        // Name | Type | Data
-        // Arial (True Type) | REG_SZ | arial.ttf
-        if( RegEnumValueA( reg_key, reg_index, name_buf, &ret_buf_size, 0, 0, 0, 0 ) != ERROR_SUCCESS )
-            return {};
-
-        // have we found the font we are looking for?
-        // the name of the value will contain the font name 
-        // ex. Arial (TrueType)
-        if( std::string( name_buf ).find( font_name ) != std::string::npos ) {
-            ret_buf_size = MAX_PATH;
-
-            // get data stored at registry key entry
-            // layout:
-            // Name | Type | Data
-            // Arial (True Type) | REG_SZ | arial.ttf
-            RegQueryValueExA( reg_key, name_buf, 0, 0, ( LPBYTE ) name_buf, &ret_buf_size );
-
-            break;
-        }
+NOINLINE void Renderer::resize( size_t width, size_t height ) {
+    // the screen size is parked while a layer is recorded
+    if( m_active_layer != invalid_layer_id ) {
+        m_screen_width  = width;
+        m_screen_height = height;
 
-        reg_index++;
+        return;
     }
 
-    // save font name
-    ttf_font_name = name_buf;
+    m_width  = width;
+    m_height = height;
+}
 
-    // clear name buffer
-    memset( name_buf, 0, MAX_PATH );
+NOINLINE void Renderer::set_ui_scale( float scale ) {
+    scale = std::clamp( scale, 0.25f, 8.f );
+    if( scale == m_ui_scale )
+        return;
 
-    // get default folder name
-    SHGetFolderPathA( 0, CSIDL_FONTS, 0, 0, name_buf );
+    m_ui_scale = scale;
 
-    return std::string( name_buf ) + '\\' + ttf_font_name;
+    update_font_scales();
 }
 
-NOINLINE void Renderer::draw_line( const Vec2_t &start, const Vec2_t &end, const Color color, float thickness ) {
-    Vec2_t   diff, norm, a, b, c, d;
-    Vertex_t vertices[ 6 ];
+NOINLINE void Renderer::update_font_scales() {
+    PROFILE_FUNCTION();
 
-    if( start == end || !color.a )
-        return;
+    const auto font_count = m_fonts.size();
 
-    // draw 1 pixel line
-    if( thickness <= 1.f ) {
-        vertices[ 0 ] = { start, color };
-        vertices[ 1 ] = { end, color };
+    m_font_scales.resize( font_count, { invalid_font_id, invalid_font_id, false } );
 
-        add_vertices( vertices, 2, D3DPT_LINELIST );
-    }
+    // copy of the same face and size, ex. from an earlier scale or another font id
+    const auto find_copy = [ & ]( const Font *font, size_t size ) {
+        for( font_id_t copy_id = 0; copy_id < m_fonts.size(); ++copy_id ) {
+            const auto copy = m_fonts[ copy_id ].get();
 
-    // draw a line with some thickness
-    // https://forum.libcinder.org/topic/smooth-thick-lines-using-geometry-shader
-    else {
-        // calculate the normal vector of this line.
-        diff = end - start; 
-        norm = Vec2_t( -diff.y, diff.x ).normalized();
+            if( ( copy_id >= font_count || m_font_scales[ copy_id ].m_copy ) && copy->m_size == size && copy->m_anti_alias == font->m_anti_alias 
+             && copy->m_create_flags == font->m_create_flags && copy->m_path == font->m_path )
+                return copy_id;
+        }
 
-        // calculate corners for quad vertices.
-        a = start - norm * thickness;
-        b = start + norm * thickness;
-        c = end - norm * thickness;
-        d = end + norm * thickness;
+        return invalid_font_id;
+    };
 
-        vertices[ 0 ] = { a, color };
-        vertices[ 1 ] = { b, color };
-        vertices[ 2 ] = { d, color };
+    for( font_id_t font_id = 0; font_id < font_count; ++font_id ) {
+        auto &entry = m_font_scales[ font_id ];
 
-        vertices[ 3 ] = { c, color };
-        vertices[ 4 ] = { d, color };
-        vertices[ 5 ] = { a, color };
+        // the vector may grow below, don't hold on to a reference
+        const auto font = m_fonts[ font_id ].get();
 
-        add_vertices( vertices, 6, D3DPT_TRIANGLELIST );
-    }
-}
+        // distance fields stay crisp at any scale, fallback glyphs would come out at the font's size
+        if( entry.m_copy || font->m_sdf || !font->m_fallbacks.empty() || font->m_path.empty() )
+            continue;
 
-NOINLINE void Renderer::draw_line( float start_x, float start_y, float end_x, float end_y, const Color color, float thickness ) {
-    draw_line( { start_x, start_y }, { end_x, end_y }, color, thickness );
-}
+        const auto size = ( size_t ) std::lround( font->m_size * m_ui_scale );
 
-NOINLINE void Renderer::draw_filled_rect( const Vec2_t &pos, const Vec2_t &size, const Color color ) { 
-    Vertex_t vertices[ 6 ];
+        // back at the font's own size, draw it right away
+        if( !size || size == font->m_size ) {
+            entry.m_target = entry.m_current = invalid_font_id;
+            continue;
+        }
 
-    if( !color.a )
-        return;
+        entry.m_target = find_copy( font, size );
+        if( entry.m_target != invalid_font_id )
+            continue;
 
-    vertices[ 0 ] = { { pos.x,          pos.y }, color };
-    vertices[ 1 ] = { { pos.x + size.x, pos.y }, color };
-    vertices[ 2 ] = { { pos.x,          pos.y + size.y }, color };
+        // rasterized in the background and packed within the glyph upload budget, the current copy keeps drawing meanwhile
+        const auto copy_id = create_font_async( font->m_path, size, font->m_anti_alias, font->m_create_flags );
 
-    vertices[ 3 ] = { { pos.x + size.x, pos.y }, color };
-    vertices[ 4 ] = { { pos.x + size.x, pos.y + size.y }, color };
-    vertices[ 5 ] = { { pos.x,          pos.y + size.y }, color };
+        if( copy_id != invalid_font_id )
+            entry.m_target = copy_id;
+    }
 
-    add_vertices( vertices, 6, D3DPT_TRIANGLELIST );
+    m_font_scales.resize( m_fonts.size(), { invalid_font_id, invalid_font_id, true } );
 }
 
-NOINLINE void Renderer::draw_filled_rect( float x, float y, float w, float h, const Color color ) {
-    draw_filled_rect( { x, y }, { w, h }, color );
-}
+NOINLINE font_id_t Renderer::get_scaled_font( font_id_t font_id, float &scale ) {
+    // texture layers are rendered at their own size and stretched
+    if( font_id >= m_font_scales.size() || ( m_active_layer != invalid_layer_id && m_layers[ m_active_layer ]->m_mode == Layer_t::TEXTURE ) )
+        return font_id;
 
-NOINLINE void Renderer::draw_filled_gradient_rect( const Vec2_t &pos, const Vec2_t &size, const ColorRect &color_rect ) { //
-    Vertex_t vertices[ 6 ];
+    auto &entry = m_font_scales[ font_id ];
 
-    if( !color_rect.valid() )
-        return;
+    // switch to the new copy once all of its glyphs are in
+    if( entry.m_target != entry.m_current && ( entry.m_target == invalid_font_id || m_fonts[ entry.m_target ]->is_loaded() ) )
+        entry.m_current = entry.m_target;
 
-    vertices[ 0 ] = { { pos.x,          pos.y }, color_rect.m_top_left };
-    vertices[ 1 ] = { { pos.x + size.x, pos.y }, color_rect.m_top_right };
-    vertices[ 2 ] = { { pos.x,          pos.y + size.y }, color_rect.m_bottom_left };
+    if( entry.m_current == invalid_font_id )
+        return font_id;
 
-    vertices[ 3 ] = { { pos.x + size.x, pos.y }, color_rect.m_top_right };
-    vertices[ 4 ] = { { pos.x + size.x, pos.y + size.y }, color_rect.m_bottom_right };
-    vertices[ 5 ] = { { pos.x,          pos.y + size.y }, color_rect.m_bottom_left };
+    // draw at the logical size, the ui scale brings the glyphs back to the copy's pixel size
+    scale *= ( float ) m_fonts[ font_id ]->m_size / ( float ) m_fonts[ entry.m_current ]->m_size;
 
-    add_vertices( vertices, 6, D3DPT_TRIANGLELIST );
+    return entry.m_current;
 }
 
-NOINLINE void Renderer::draw_filled_gradient_rect( float x, float y, float w, float h, const ColorRect &color_rect ) {
-    draw_filled_gradient_rect( { x, y }, { w, h }, color_rect );
-}
+NOINLINE void Renderer::apply_ui_scale() {
+    PROFILE_FUNCTION();
 
-NOINLINE void Renderer::draw_rect( const Vec2_t &pos, const Vec2_t &size, const Color color, float thickness ) { 
-    // bottom line.
-    draw_filled_rect( pos.x, pos.y + size.y - thickness, size.x, thickness, color );
-      
-    // top line.
-    draw_filled_rect( pos.x, pos.y, size.x, thickness, color );
-    
-    // left line.
-    draw_filled_rect( pos.x, pos.y, thickness, size.y, color );
+    VertexKernels::scale( m_render_list.m_vertices.data(), m_render_list.m_vertices.size(), {}, m_ui_scale );
 
-    // right line.
-    draw_filled_rect( pos.x + size.x - thickness, pos.y, thickness, size.y, color );
+    for( auto &instance : m_render_list.m_instances ) {
+        instance.m_pos  = instance.m_pos * m_ui_scale;
+        instance.m_size = instance.m_size * m_ui_scale;
+    }
 }
 
-NOINLINE void Renderer::draw_rect( float x, float y, float w, float h, const Color color, float thickness ) {
-    draw_rect( { x, y }, { w, h }, color, thickness );
-}
+NOINLINE void Renderer::render() {
+    PROFILE_FUNCTION();
 
-NOINLINE void Renderer::draw_outlined_filled_rect( const Vec2_t &pos, const Vec2_t &size, const Color fill_color, const Color outline_color ) {
-    draw_filled_rect( pos.x, pos.y, size.x, size.y, fill_color );
-    draw_rect( pos.x - 1.f, pos.y - 1.f, size.x + 2.f, size.y + 2.f, outline_color );
-}
+    // nothing to draw with, drop the frame so the list doesn't grow while the device is gone
+    if( m_device_lost ) {
+        m_render_list.clear();
+        return;
+    }
 
-NOINLINE void Renderer::draw_outlined_filled_rect( float x, float y, float w, float h, const Color fill_color, const Color outline_color ) {
-    draw_outlined_filled_rect( { x, y }, { w, h }, fill_color, outline_color );
-}
+    // fonts created since the ui scale was set need their copies too
+    if( m_ui_scale != 1.f && m_font_scales.size() < m_fonts.size() )
+        update_font_scales();
 
-NOINLINE void Renderer::draw_outlined_rect( const Vec2_t &pos, const Vec2_t &size, const Color inner_color, const Color outline_color ) {
-    // outline
-    draw_rect( pos.x - 1.f, pos.y - 1.f, size.x + 2.f, size.y + 2.f, outline_color );
-    draw_rect( pos.x + 1.f, pos.y + 1.f, size.x - 2.f, size.y - 2.f, outline_color );
+    // pack glyphs of fonts loading in the background
+    if( !m_font_loads.empty() )
+        process_font_loads();
 
-    // inner line
-    draw_rect( pos.x, pos.y, size.x, size.y, inner_color );
-}
+    // every so often forget text layouts that aren't used anymore. counted per render call, stats frames
+    // stand still while nothing is drawn and would sweep on every one of those renders
+    if( ++m_layout_frame % layout_cache_frames == 0 )
+        evict_text_layouts();
 
-NOINLINE void Renderer::draw_outlined_rect( float x, float y, float w, float h, const Color inner_color, const Color outline_color ) {
-    draw_outlined_rect( { x, y }, { w, h }, inner_color, outline_color );
-}
+    // other processes draw on top of everything else
+    if( m_overlay.is_open() )
+        draw_overlay();
 
-NOINLINE void Renderer::draw_circle( const Vec2_t &pos, float radius, const Color color ) {
-    static constexpr auto segment_count = 32;
-    std::array< Vertex_t, segment_count + 1 > vertices;
+    // layers recorded since the last frame, before the frame composites them
+    render_layers();
 
-    if( !color.a )
+    // everything was drawn in logical coordinates
+    if( m_ui_scale != 1.f )
+        apply_ui_scale();
+
+    // dont render if list entry
+    if( ( !m_render_list.m_vertices.empty() || !m_render_list.m_instances.empty() ) && grow_buffers( m_render_list ) ) {
+        // render
+        begin();
+        flush();
+        end();
+
+        m_stats.m_frames++;
+    }
+
+    // textures of this frame are drawn, now they can go
+    trim_textures();
+}
+
+NOINLINE void Renderer::trim_textures() {
+    if( !m_texture_manager.end_frame() )
+        return;
+
+    // recorded vertex layers point at textures directly, an evicted page has to be acquired again
+    for( auto &layer : m_layers ) {
+        if( layer->m_mode == Layer_t::VERTICES )
+            layer->m_dirty = true;
+    }
+
+    m_upload_valid = false;
+}
+
+NOINLINE void Renderer::manage_font_pages( font_id_t font_id ) {
+    const auto font = m_fonts[ font_id ].get();
+
+    font->m_textures = &m_texture_manager;
+
+    for( size_t i = 0; i < font->m_pages.size(); ++i ) {
+        auto &page = font->m_pages[ i ];
+
+        if( !page.m_texture || page.m_handle != invalid_texture_handle )
+            continue;
+
+        // the manager owns the texture from here on, the font keeps a borrowed pointer while it's resident
+        page.m_handle = m_texture_manager.add( page.m_texture, font_id, 
+            [ font, i ]() { return font->restore_page( i ); }, 
+            [ font, i ]() { font->evict_page( i ); } );
+    }
+}
+
+NOINLINE texture_handle_t Renderer::load_texture( const std::string &path ) {
+    // managed so it survives device resets, read again from the file after eviction
+    const auto load = [ device = m_device, path ]() -> IDirect3DTexture9 * {
+        IDirect3DTexture9 *texture = nullptr;
+
+        if( D3DXCreateTextureFromFileExA( device, path.c_str(), D3DX_DEFAULT_NONPOW2, D3DX_DEFAULT_NONPOW2, 1, 0, D3DFMT_UNKNOWN, D3DPOOL_MANAGED, 
+            D3DX_DEFAULT, D3DX_DEFAULT, 0, nullptr, nullptr, &texture ) != D3D_OK )
+            return nullptr;
+
+        return texture;
+    };
+
+    return m_texture_manager.add( load(), TextureManager::user_group, load );
+}
+
+NOINLINE texture_handle_t Renderer::create_texture( size_t width, size_t height, const uint32_t *pixels ) {
+    IDirect3DTexture9 *texture;
+    D3DLOCKED_RECT    locked_rect;
+
+    if( !width || !height || !pixels )
+        return invalid_texture_handle;
+
+    if( D3DXCreateTexture( m_device, ( UINT ) width, ( UINT ) height, 1, 0, D3DFMT_A8R8G8B8, D3DPOOL_MANAGED, &texture ) != D3D_OK )
+        return invalid_texture_handle;
+
+    if( texture->LockRect( 0, &locked_rect, nullptr, 0 ) != D3D_OK ) {
+        Utils::safe_release( &texture );
+        return invalid_texture_handle;
+    }
+
+    for( size_t row = 0; row < height; ++row )
+        std::memcpy( ( uint8_t * ) locked_rect.pBits + ( ptrdiff_t ) row * locked_rect.Pitch, pixels + row * width, width * sizeof( uint32_t ) );
+
+    texture->UnlockRect( 0 );
+
+    // nothing to create it again from, stays resident
+    return m_texture_manager.add( texture, TextureManager::user_group );
+}
+
+NOINLINE void Renderer::release_texture( texture_handle_t texture ) {
+    m_texture_manager.remove( texture );
+}
+
+NOINLINE bool Renderer::upload_sprite_pages() {
+    const auto &pages = m_sprite_atlas.get_pages();
+
+    for( auto i = m_sprite_pages.size(); i < pages.size(); ++i ) {
+        const auto texture = create_texture( pages[ i ].m_width, pages[ i ].m_height, pages[ i ].m_pixels.data() );
+        if( texture == invalid_texture_handle )
+            return false;
+
+        m_sprite_pages.push_back( texture );
+    }
+
+    // pages live in managed textures now
+    m_sprite_atlas.release_pixels();
+
+    return true;
+}
+
+NOINLINE bool Renderer::load_sprite_atlas( const std::string &path ) {
+    PROFILE_FUNCTION();
+
+    for( const auto texture : m_sprite_pages )
+        release_texture( texture );
+
+    m_sprite_pages.clear();
+
+    return m_sprite_atlas.load( path ) && upload_sprite_pages();
+}
+
+NOINLINE bool Renderer::add_sprites( const std::vector< std::string > &paths, size_t page_size ) {
+    IDirect3DTexture9       *image;
+    D3DSURFACE_DESC         desc;
+    D3DLOCKED_RECT          locked_rect;
+    std::vector< uint32_t > pixels;
+
+    PROFILE_FUNCTION();
+
+    for( const auto &path : paths ) {
+        // decoded by d3dx into system memory, converted to argb
+        if( D3DXCreateTextureFromFileExA( m_device, path.c_str(), D3DX_DEFAULT_NONPOW2, D3DX_DEFAULT_NONPOW2, 1, 0, D3DFMT_A8R8G8B8, D3DPOOL_SYSTEMMEM, 
+            D3DX_FILTER_NONE, D3DX_DEFAULT, 0, nullptr, nullptr, &image ) != D3D_OK ) {
+            m_sprite_atlas.drop_images();
+            return false;
+        }
+
+        if( image->GetLevelDesc( 0, &desc ) != D3D_OK || image->LockRect( 0, &locked_rect, nullptr, D3DLOCK_READONLY ) != D3D_OK ) {
+            Utils::safe_release( &image );
+            m_sprite_atlas.drop_images();
+            return false;
+        }
+
+        pixels.resize( ( size_t ) desc.Width * desc.Height );
+        for( UINT row = 0; row < desc.Height; ++row )
+            std::memcpy( &pixels[ ( size_t ) row * desc.Width ], ( const uint8_t * ) locked_rect.pBits + ( ptrdiff_t ) row * locked_rect.Pitch, desc.Width * sizeof( uint32_t ) );
+
+        image->UnlockRect( 0 );
+
+        Utils::safe_release( &image );
+
+        // named after the file
+        auto name = path.substr( path.find_last_of( "/\\" ) + 1 );
+        name = name.substr( 0, name.rfind( '.' ) );
+
+        // all or nothing, the images added so far are dropped so their names stay free
+        if( !m_sprite_atlas.add_image( name, desc.Width, desc.Height, pixels.data() ) ) {
+            m_sprite_atlas.drop_images();
+            return false;
+        }
+    }
+
+    if( !m_sprite_atlas.build( page_size ) ) {
+        m_sprite_atlas.drop_images();
+        return false;
+    }
+
+    return upload_sprite_pages();
+}
+
+NOINLINE bool Renderer::open_overlay_channel( const std::string &name, size_t capacity ) {
+    m_overlay_frame.clear();
+
+    return m_overlay.create( name, capacity );
+}
+
+NOINLINE void Renderer::close_overlay_channel() {
+    m_overlay.close();
+    m_overlay_frame.clear();
+}
+
+NOINLINE void Renderer::draw_overlay() {
+    Overlay::Record_t record;
+    size_t            offset;
+
+    PROFILE_FUNCTION();
+
+    // keep drawing the last frame until the producer publishes a new one
+    if( m_overlay.drain( m_overlay_staging ) )
+        std::swap( m_overlay_frame, m_overlay_staging );
+
+    offset = 0;
+
+    // records were checked against the ring but their payloads come from another process
+    while( offset + sizeof( record ) <= m_overlay_frame.size() ) {
+        std::memcpy( &record, m_overlay_frame.data() + offset, sizeof( record ) );
+
+        const auto payload      = m_overlay_frame.data() + offset + sizeof( record );
+        const auto payload_size = ( size_t ) record.m_size - sizeof( record );
+
+        offset += record.m_size;
+
+        switch( record.m_type ) {
+            case Overlay::RECORD_FILLED_RECT: {
+                Overlay::Rect_t rect;
+
+                if( payload_size < sizeof( rect ) )
+                    break;
+
+                std::memcpy( &rect, payload, sizeof( rect ) );
+                draw_filled_rect( rect.m_x, rect.m_y, rect.m_w, rect.m_h, Color::from_argb( rect.m_color ) );
+
+                break;
+            }
+
+            case Overlay::RECORD_LINE: {
+                Overlay::Line_t line;
+
+                if( payload_size < sizeof( line ) )
+                    break;
+
+                std::memcpy( &line, payload, sizeof( line ) );
+                draw_line( line.m_start_x, line.m_start_y, line.m_end_x, line.m_end_y, Color::from_argb( line.m_color ), line.m_thickness );
+
+                break;
+            }
+
+            case Overlay::RECORD_TEXT: {
+                Overlay::Text_t text;
+
+                if( payload_size < sizeof( text ) )
+                    break;
+
+                std::memcpy( &text, payload, sizeof( text ) );
+
+                if( text.m_length > payload_size - sizeof( text ) || text.m_font_id >= m_fonts.size() )
+                    break;
+
+                draw_text( text.m_font_id, std::string_view( ( const char * ) payload + sizeof( text ), text.m_length ), { text.m_x, text.m_y }, text.m_flags, 
+                    Color::from_argb( text.m_color ) );
+
+                break;
+            }
+
+            case Overlay::RECORD_VERTICES: {
+                Overlay::Vertices_t run;
+
+                if( payload_size < sizeof( run ) )
+                    break;
+
+                std::memcpy( &run, payload, sizeof( run ) );
+
+                const auto topology = ( D3DPRIMITIVETYPE ) run.m_topology;
+                const auto order    = run.m_topology >= D3DPT_POINTLIST && run.m_topology <= D3DPT_TRIANGLEFAN ? get_topology_order( topology ) : 0;
+
+                // whole primitives only
+                if( !order || !run.m_count || run.m_count > ( payload_size - sizeof( run ) ) / sizeof( Vertex_t ) 
+                 || ( is_toplogy_list( topology ) ? run.m_count % order != 0 : run.m_count < ( uint32_t ) order ) )
+                    break;
+
+                std::memcpy( reserve_vertices( run.m_count, topology ), payload + sizeof( run ), run.m_count * sizeof( Vertex_t ) );
+
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+}
+
+NOINLINE bool Renderer::grow_buffers( const RenderList &list ) {
+    const auto num_vertices  = list.m_vertices.size();
+    const auto num_instances = list.m_instances.size();
+
+    if( num_vertices <= m_max_vertices && num_instances <= m_max_instances )
+        return true;
+
+    m_max_vertices  = std::max( m_max_vertices, num_vertices );
+    m_max_instances = std::max( m_max_instances, num_instances );
+
+    return reacquire();
+}
+
+NOINLINE void Renderer::end() {
+    // apply old render state
+    m_render_state_block->Apply();
+}
+
+NOINLINE void Renderer::release() {
+    // recreated buffers start out empty
+    m_upload_valid = false;
+
+    Utils::safe_release( &m_vertex_buffer );
+    Utils::safe_release( &m_render_state_block );
+    Utils::safe_release( &m_instance_buffer );
+    Utils::safe_release( &m_quad_buffer );
+    Utils::safe_release( &m_quad_indices );
+}
+
+NOINLINE void Renderer::add_vertices( Vertex_t *vertex_array, size_t vertex_count, D3DPRIMITIVETYPE topology, IDirect3DTexture9 *texture, 
+    IDirect3DPixelShader9 *pixel_shader, const Vec2_t &shader_params ) {
+    if( !vertex_count )
+        return;
+
+    // add verticies to list
+    std::copy( vertex_array, vertex_array + vertex_count, reserve_vertices( vertex_count, topology, texture, pixel_shader, shader_params ) );
+}
+
+NOINLINE Vertex_t *Renderer::reserve_vertices( size_t vertex_count, D3DPRIMITIVETYPE topology, IDirect3DTexture9 *texture, 
+    IDirect3DPixelShader9 *pixel_shader, const Vec2_t &shader_params ) {
+    auto vertices = &m_render_list.m_vertices;
+    auto batches  = &m_render_list.m_batches;
+
+    m_stats.m_submissions++;
+    m_stats.m_vertices += vertex_count;
+
+    const auto offset = vertices->size();
+    vertices->resize( offset + vertex_count );
+
+    //  create new batch if needed, strips and fans can't be joined with the previous shape
+    if( batches->empty() 
+      || batches->back().m_instanced
+      || !is_toplogy_list( topology )
+      || batches->back().m_topology != topology 
+      || batches->back().m_texture != texture 
+      || batches->back().m_pixel_shader != pixel_shader 
+      || batches->back().m_shader_params.x != shader_params.x 
+      || batches->back().m_shader_params.y != shader_params.y )
+        batches->push_back( { topology, texture, 0, pixel_shader, shader_params } );
+
+    batches->back().m_count += vertex_count;
+
+    return vertices->data() + offset;
+}
+
+NOINLINE Instance_t *Renderer::reserve_instances( size_t instance_count, IDirect3DTexture9 *texture ) {
+    auto instances = &m_render_list.m_instances;
+    auto batches   = &m_render_list.m_batches;
+
+    m_stats.m_submissions++;
+    m_stats.m_instances += instance_count;
+
+    const auto offset = instances->size();
+    instances->resize( offset + instance_count );
+
+    // instances only join an instanced batch of the same texture
+    if( batches->empty() 
+      || !batches->back().m_instanced 
+      || batches->back().m_texture != texture )
+        batches->push_back( { D3DPT_TRIANGLELIST, texture, 0, nullptr, {}, true } );
+
+    batches->back().m_count += instance_count;
+
+    return instances->data() + offset;
+}
+
+NOINLINE void Renderer::unreserve_vertices( size_t vertex_count ) {
+    auto vertices = &m_render_list.m_vertices;
+    auto batches  = &m_render_list.m_batches;
+
+    if( !vertex_count || batches->empty() )
+        return;
+
+    // the reserved vertices are the tail of the last batch
+    vertices->resize( vertices->size() - vertex_count );
+    batches->back().m_count -= vertex_count;
+
+    m_stats.m_vertices -= vertex_count;
+
+    if( !batches->back().m_count )
+        batches->pop_back();
+}
+
+NOINLINE Renderer::ClipResult Renderer::clip_test( const Rect_t &bounds ) const {
+    const auto clip_rect = get_clip_rect();
+
+    // trivial reject
+    if( !bounds.intersects( clip_rect ) )
+        return CLIP_REJECT;
+
+    // the device clips against the viewport itself, only pushed clip rects need cpu clipping
+    if( m_clip_rects.empty() || clip_rect.contains( bounds ) )
+        return CLIP_ACCEPT;
+
+    return CLIP_PARTIAL;
+}
+
+NOINLINE void Renderer::add_convex_polygon( const std::vector< Vec2_t > &points, const Color color ) {
+    Vertex_t vertices[ 3 ];
+
+    if( points.size() < 3 )
+        return;
+
+    // fan triangulation, emitted as a list so it merges with other triangle batches
+    for( size_t i = 1; i + 1 < points.size(); ++i ) {
+        vertices[ 0 ] = { points[ 0 ], color };
+        vertices[ 1 ] = { points[ i ], color };
+        vertices[ 2 ] = { points[ i + 1 ], color };
+
+        add_vertices( vertices, 3, D3DPT_TRIANGLELIST );
+    }
+}
+
+NOINLINE void Renderer::push_clip_rect( const Vec2_t &pos, const Vec2_t &size, bool intersect_current ) {
+    auto rect = Rect_t::from_size( pos, size );
+
+    // nested panels only ever shrink the visible area
+    if( intersect_current )
+        rect = rect.intersection( get_clip_rect() );
+
+    // nothing recorded into a vertex layer may leave the layer rect at the bottom of the stack
+    else if( is_recording_vertices() )
+        rect = rect.intersection( m_clip_rects.front() );
+
+    m_clip_rects.push_back( rect );
+}
+
+NOINLINE void Renderer::push_clip_rect( float x, float y, float w, float h, bool intersect_current ) {
+    push_clip_rect( { x, y }, { w, h }, intersect_current );
+}
+
+NOINLINE void Renderer::pop_clip_rect() {
+    // the layer rect of a vertex layer is popped by end_layer
+    if( m_clip_rects.size() > ( is_recording_vertices() ? 1u : 0u ) )
+        m_clip_rects.pop_back();
+}
+
+NOINLINE layer_id_t Renderer::create_layer( const std::string &name, const Vec2_t &pos, const Vec2_t &size, Layer_t::LayerMode mode ) {
+    // names are unique, creating it again returns the existing layer
+    const auto existing = find_layer( name );
+    if( existing != invalid_layer_id )
+        return existing;
+
+    if( size.x < 1.f || size.y < 1.f )
+        return invalid_layer_id;
+
+    auto layer = std::make_unique< Layer_t >();
+
+    layer->m_name = name;
+    layer->m_mode = mode;
+    layer->m_pos  = pos;
+    layer->m_size = { std::floor( size.x ), std::floor( size.y ) };
+
+    m_layers.push_back( std::move( layer ) );
+
+    return m_layers.size() - 1;
+}
+
+NOINLINE layer_id_t Renderer::find_layer( const std::string &name ) const {
+    for( size_t i = 0; i < m_layers.size(); ++i ) {
+        if( m_layers[ i ]->m_name == name )
+            return i;
+    }
+
+    return invalid_layer_id;
+}
+
+NOINLINE bool Renderer::begin_layer( layer_id_t layer_id ) {
+    // layers don't nest
+    if( layer_id >= m_layers.size() || m_active_layer != invalid_layer_id )
+        return false;
+
+    auto &layer = *m_layers[ layer_id ];
+
+    // still valid, nothing to record
+    if( !layer.m_dirty )
+        return false;
+
+    // draw calls land in the layer until end_layer, relative to its top left and clipped to its size
+    layer.m_list.clear();
+
+    std::swap( m_render_list, layer.m_list );
+    std::swap( m_clip_rects, m_layer_clip_rects );
+
+    m_clip_rects.clear();
+
+    // texture layers are clipped by their render target. vertex layers are drawn straight into the frame,
+    // so everything recorded is clipped to the layer rect on the cpu
+    if( layer.m_mode == Layer_t::VERTICES )
+        m_clip_rects.push_back( Rect_t::from_size( { 0.f, 0.f }, layer.m_size ) );
+
+    m_screen_width  = m_width;
+    m_screen_height = m_height;
+    m_width         = ( size_t ) layer.m_size.x;
+    m_height        = ( size_t ) layer.m_size.y;
+
+    m_active_layer = layer_id;
+
+    return true;
+}
+
+NOINLINE void Renderer::end_layer() {
+    if( m_active_layer == invalid_layer_id )
+        return;
+
+    auto &layer = *m_layers[ m_active_layer ];
+
+    std::swap( m_render_list, layer.m_list );
+    std::swap( m_clip_rects, m_layer_clip_rects );
+
+    m_width        = m_screen_width;
+    m_height       = m_screen_height;
+    m_active_layer = invalid_layer_id;
+
+    layer.m_dirty = false;
+
+    if( layer.m_mode != Layer_t::TEXTURE )
+        return;
+
+    // render target is created here so draw_layer can reference it before render draws into it
+    if( !layer.m_texture && m_device->CreateTexture( ( UINT ) layer.m_size.x, ( UINT ) layer.m_size.y, 1, D3DUSAGE_RENDERTARGET, D3DFMT_A8R8G8B8, 
+        D3DPOOL_DEFAULT, &layer.m_texture, nullptr ) < 0 ) {
+        layer.m_texture = nullptr;
+        layer.m_dirty   = true;
+
+        return;
+    }
+
+    layer.m_pending = true;
+}
+
+NOINLINE void Renderer::draw_layer( layer_id_t layer_id ) {
+    if( layer_id >= m_layers.size() || m_active_layer != invalid_layer_id )
+        return;
+
+    auto &layer = *m_layers[ layer_id ];
+
+    if( layer.m_mode == Layer_t::TEXTURE ) {
+        if( !layer.m_texture )
+            return;
+
+        const std::array< Vec2_t, 6 > uv_coords = {
+            {
+                { 0.f, 1.f },
+                { 1.f, 1.f },
+                { 0.f, 0.f },
+                { 1.f, 1.f },
+                { 1.f, 0.f },
+                { 0.f, 0.f }
+            }
+        };
+
+        add_texture_quad( layer.m_pos, layer.m_size, { 255, 255, 255, 255 }, layer.m_texture, uv_coords, m_layer_shader );
+        return;
+    }
+
+    const auto &list = layer.m_list;
+    if( list.m_batches.empty() )
+        return;
+
+    // recorded batches are appended as is, only moved to the layer position.
+    // begin_layer clipped them to the layer rect, the current clip rect doesn't apply
+    const auto first_vertex   = m_render_list.m_vertices.size();
+    const auto first_instance = m_render_list.m_instances.size();
+
+    m_render_list.m_vertices.insert( m_render_list.m_vertices.end(), list.m_vertices.begin(), list.m_vertices.end() );
+    m_render_list.m_instances.insert( m_render_list.m_instances.end(), list.m_instances.begin(), list.m_instances.end() );
+    m_render_list.m_batches.insert( m_render_list.m_batches.end(), list.m_batches.begin(), list.m_batches.end() );
+
+    VertexKernels::translate( m_render_list.m_vertices.data() + first_vertex, list.m_vertices.size(), layer.m_pos );
+
+    for( auto i = first_instance; i < m_render_list.m_instances.size(); ++i )
+        m_render_list.m_instances[ i ].m_pos += layer.m_pos;
+
+    m_stats.m_submissions++;
+    m_stats.m_vertices  += list.m_vertices.size();
+    m_stats.m_instances += list.m_instances.size();
+}
+
+NOINLINE void Renderer::invalidate_layer( layer_id_t layer_id ) {
+    if( layer_id < m_layers.size() )
+        m_layers[ layer_id ]->m_dirty = true;
+}
+
+NOINLINE void Renderer::set_layer_rect( layer_id_t layer_id, const Vec2_t &pos, const Vec2_t &size ) {
+    if( layer_id >= m_layers.size() || size.x < 1.f || size.y < 1.f )
+        return;
+
+    auto &layer = *m_layers[ layer_id ];
+
+    // moving is free, resizing needs new contents
+    layer.m_pos = pos;
+
+    const Vec2_t new_size = { std::floor( size.x ), std::floor( size.y ) };
+    if( new_size == layer.m_size )
+        return;
+
+    layer.m_size    = new_size;
+    layer.m_dirty   = true;
+    layer.m_pending = false;
+
+    Utils::safe_release( &layer.m_texture );
+}
+
+NOINLINE void Renderer::render_layers() {
+    for( auto &layer : m_layers ) {
+        if( layer->m_pending && layer->m_texture )
+            render_layer( *layer );
+    }
+}
+
+NOINLINE void Renderer::render_layer( Layer_t &layer ) {
+    IDirect3DSurface9 *target, *old_target;
+    D3DVIEWPORT9      old_viewport;
+
+    PROFILE_FUNCTION();
+
+    layer.m_pending = false;
+
+    if( !grow_buffers( layer.m_list ) )
+        return;
+
+    if( layer.m_texture->GetSurfaceLevel( 0, &target ) < 0 )
+        return;
+
+    if( m_device->GetRenderTarget( 0, &old_target ) < 0 ) {
+        Utils::safe_release( &target );
+        return;
+    }
+
+    m_device->GetViewport( &old_viewport );
+
+    m_device->SetRenderTarget( 0, target );
+    m_device->Clear( 0, nullptr, D3DCLEAR_TARGET, 0, 1.f, 0 );
+
+    // flush the recorded list as if it were a frame of the layer's size. the list is consumed,
+    // a lost texture is recorded again
+    std::swap( m_render_list, layer.m_list );
+
+    m_screen_width  = m_width;
+    m_screen_height = m_height;
+    m_width         = ( size_t ) layer.m_size.x;
+    m_height        = ( size_t ) layer.m_size.y;
+
+    if( !m_render_list.m_batches.empty() ) {
+        begin();
+        flush();
+        end();
+    }
+
+    m_width  = m_screen_width;
+    m_height = m_screen_height;
+
+    std::swap( m_render_list, layer.m_list );
+
+    m_device->SetRenderTarget( 0, old_target );
+    m_device->SetViewport( &old_viewport );
+
+    Utils::safe_release( &target );
+    Utils::safe_release( &old_target );
+
+    // the frame has to be uploaded again
+    m_upload_valid = false;
+}
+
+NOINLINE void Renderer::release_layers() {
+    for( auto &layer : m_layers ) {
+        Utils::safe_release( &layer->m_texture );
+
+        // texture contents are gone, they have to be drawn again
+        if( layer->m_mode == Layer_t::TEXTURE ) {
+            layer->m_dirty   = true;
+            layer->m_pending = false;
+        }
+    }
+}
+
+NOINLINE bool Renderer::dump_stats_json( const std::string &path ) const {
+    FILE *file;
+
+    file = std::fopen( path.c_str(), "wb" );
+    if( !file )
+        return false;
+
+    // per frame averages and flush cost per vertex
+    const auto frames        = m_stats.m_frames ? ( double ) m_stats.m_frames : 1.0;
+    const auto ns_per_vertex = m_stats.m_vertices ? ( double ) m_stats.m_flush_ns / ( double ) m_stats.m_vertices : 0.0;
+
+    std::fprintf( file,
+        "{\"frames\":%llu,\"submissions\":%llu,\"vertices\":%llu,\"instances\":%llu,\"batches\":%llu,\"draw_calls\":%llu,\"flush_ns\":%llu,\"upload_skips\":%llu,\"resets\":%llu,\"reset_ns\":%llu,"
+        "\"upload_skip_rate\":%.3f,\"submissions_per_frame\":%.3f,\"vertices_per_frame\":%.3f,\"draw_calls_per_frame\":%.3f,\"flush_ns_per_vertex\":%.3f}\n",
+        ( unsigned long long ) m_stats.m_frames, ( unsigned long long ) m_stats.m_submissions, ( unsigned long long ) m_stats.m_vertices, ( unsigned long long ) m_stats.m_instances,
+        ( unsigned long long ) m_stats.m_batches, ( unsigned long long ) m_stats.m_draw_calls, ( unsigned long long ) m_stats.m_flush_ns,
+        ( unsigned long long ) m_stats.m_upload_skips, ( unsigned long long ) m_stats.m_resets, ( unsigned long long ) m_stats.m_reset_ns, m_stats.m_upload_skips / frames, m_stats.m_submissions / frames, m_stats.m_vertices / frames, m_stats.m_draw_calls / frames, ns_per_vertex );
+
+    std::fclose( file );
+
+    return true;
+}
+
+NOINLINE font_id_t Renderer::create_font( const std::string &ttf_font, size_t size, bool anti_alias, uint32_t create_flags ) {
+    font_ptr_t font = std::make_unique< Font >();
+
+    if( !font->init( m_device, &m_font_manager, &m_thread_pool, ttf_font, size, anti_alias, create_flags ) )
+        return invalid_font_id;
+
+    m_fonts.push_back( std::move( font ) );
+
+    manage_font_pages( m_fonts.size() - 1 );
+
+    return m_fonts.size() - 1;
+}
+
+NOINLINE font_id_t Renderer::create_font_async( const std::string &ttf_font, size_t size, bool anti_alias, uint32_t create_flags, font_callback_t callback ) {
+    // without workers the job would run inline and spin on a glyph queue only render drains, load it right here
+    if( !m_thread_pool.get_worker_count() ) {
+        const auto font_id = create_font( ttf_font, size, anti_alias, create_flags );
+
+        if( font_id != invalid_font_id && callback )
+            callback( font_id, true );
+
+        return font_id;
+    }
+
+    font_ptr_t font = std::make_unique< Font >();
+    auto       load = std::make_unique< FontLoad_t >();
+
+    // the face is opened here, freetype face creation isn't thread safe
+    if( !font->open( m_device, &m_font_manager, ttf_font, size, anti_alias, create_flags ) )
+        return invalid_font_id;
+
+    // the worker gets its own face so fonts created meanwhile can keep using the shared one
+    load->m_face = font->open_worker_face();
+    if( !load->m_face )
+        return invalid_font_id;
+
+    font->get_charmap( load->m_charmap );
+
+    load->m_font     = font.get();
+    load->m_callback = std::move( callback );
+
+    m_fonts.push_back( std::move( font ) );
+
+    load->m_font_id = m_fonts.size() - 1;
+
+    // rasterize in the background, glyphs are handed back through the queue
+    const auto job  = load.get();
+    const auto pool = &m_thread_pool;
+    m_thread_pool.submit( [ pool, job ]() { run_font_load( pool, job ); } );
+
+    m_font_loads.push_back( std::move( load ) );
+
+    return m_fonts.size() - 1;
+}
+
+NOINLINE void Renderer::run_font_load( ThreadPool *pool, FontLoad_t *job ) {
+    PROFILE_SCOPE( "Renderer::create_font_async rasterize" );
+
+    while( !job->m_cancel.load( std::memory_order_relaxed ) ) {
+        if( !job->m_holding ) {
+            if( job->m_next == job->m_charmap.size() )
+                break;
+
+            const auto &entry = job->m_charmap[ job->m_next++ ];
+
+            job->m_held      = {};
+            job->m_held.m_ok = job->m_font->rasterize_glyph( job->m_face, entry.first, entry.second, job->m_held );
+            job->m_holding   = true;
+        }
+
+        // full until the render thread packs some. give the worker back and resume behind whatever got queued meanwhile
+        if( !job->m_glyphs.try_push( std::move( job->m_held ) ) ) {
+            std::this_thread::yield();
+
+            pool->submit( [ pool, job ]() { run_font_load( pool, job ); } );
+            return;
+        }
+
+        job->m_holding = false;
+    }
+
+    job->m_done.store( true, std::memory_order_release );
+}
+
+NOINLINE void Renderer::process_font_loads() {
+    RasterGlyph_t raster;
+
+    PROFILE_FUNCTION();
+
+    auto budget = m_glyph_upload_budget;
+
+    for( auto it = m_font_loads.begin(); it != m_font_loads.end(); ) {
+        auto &load = **it;
+
+        // read done before draining, glyphs pushed before it was set are then guaranteed to be visible
+        const auto done = load.m_done.load( std::memory_order_acquire );
+
+        // pack a bounded number of glyphs per frame
+        while( budget && load.m_glyphs.try_pop( raster ) ) {
+            if( !load.m_font->add_glyph( raster ) )
+                load.m_failed = true;
+
+            load.m_packed++;
+
+            --budget;
+        }
+
+        if( !done || !load.m_glyphs.empty() ) {
+            ++it;
+            continue;
+        }
+
+        // all glyphs are packed, upload and publish the font
+        load.m_font->close_worker_face( load.m_face );
+
+        const auto success = !load.m_failed && load.m_packed == load.m_charmap.size() && load.m_font->upload_atlas();
+
+        load.m_font->m_loaded = success;
+
+        if( success )
+            manage_font_pages( load.m_font_id );
+
+        // layouts that went through the fallback font or chain may measure differently now
+        m_layout_cache.clear();
+
+        if( load.m_callback )
+            load.m_callback( load.m_font_id, success );
+
+        it = m_font_loads.erase( it );
+    }
+}
+
+NOINLINE void Renderer::cancel_font_loads() {
+    // stop producers, then wait for them to leave before their jobs go away
+    for( auto &load : m_font_loads )
+        load->m_cancel.store( true, std::memory_order_relaxed );
+
+    m_thread_pool.wait();
+
+    for( auto &load : m_font_loads )
+        load->m_font->close_worker_face( load->m_face );
+
+    m_font_loads.clear();
+}
+
+NOINLINE bool Renderer::add_font_fallback( font_id_t font_id, font_id_t fallback_id ) {
+    if( font_id >= m_fonts.size() || fallback_id >= m_fonts.size() )
+        return false;
+
+    // line widths depend on the fallbacks
+    m_layout_cache.clear();
+
+    return m_fonts[ font_id ]->add_fallback( m_fonts[ fallback_id ].get() );
+}
+
+NOINLINE font_id_t Renderer::resolve_font( font_id_t font_id ) const {
+    if( font_id < m_fonts.size() && m_fonts[ font_id ]->is_loaded() )
+        return font_id;
+
+    // fall back while the font is loading
+    if( m_fallback_font < m_fonts.size() && m_fonts[ m_fallback_font ]->is_loaded() )
+        return m_fallback_font;
+
+    return invalid_font_id;
+}
+
+NOINLINE bool Renderer::init_font_catalog( const std::string &index_path ) {
+    // cached index from a previous run
+    if( !index_path.empty() && m_font_catalog.load_index( index_path ) )
+        return true;
+
+    m_font_catalog.clear();
+
+    if( !m_font_catalog.add_system_fonts() )
+        return false;
+
+    if( !index_path.empty() )
+        m_font_catalog.save_index( index_path );
+
+    return true;
+}
+
+NOINLINE std::string Renderer::get_font_path( const std::string &font_name ) {
+    // build catalogue on first use
+    if( m_font_catalog.empty() )
+        init_font_catalog();
+
+    return m_font_catalog.find( font_name );
+}
+
+NOINLINE void Renderer::draw_line( const Vec2_t &start, const Vec2_t &end, const Color color, float thickness ) {
+    Vec2_t     diff, norm, a, b, c, d;
+    Vertex_t   vertices[ 6 ];
+    ClipResult clip;
+
+    if( start == end || !color.a )
+        return;
+
+    // cull line bounds, thickness extends to both sides of the line
+    const auto extent = std::max( thickness, 1.f );
+
+    clip = clip_test( { 
+        { std::min( start.x, end.x ) - extent, std::min( start.y, end.y ) - extent }, 
+        { std::max( start.x, end.x ) + extent, std::max( start.y, end.y ) + extent } 
+    } );
+
+    if( clip == CLIP_REJECT )
+        return;
+
+    // draw 1 pixel line
+    if( thickness <= 1.f ) {
+        auto clipped_start = start;
+        auto clipped_end   = end;
+
+        if( clip == CLIP_PARTIAL && !clip_line( clipped_start, clipped_end, get_clip_rect() ) )
+            return;
+
+        vertices[ 0 ] = { clipped_start, color };
+        vertices[ 1 ] = { clipped_end, color };
+
+        add_vertices( vertices, 2, D3DPT_LINELIST );
+    }
+
+    // draw a line with some thickness
+    // https://forum.libcinder.org/topic/smooth-thick-lines-using-geometry-shader
+    else {
+        // calculate the normal vector of this line.
+        diff = end - start; 
+        norm = Vec2_t( -diff.y, diff.x ).normalized_fast();
+
+        // calculate corners for quad vertices.
+        a = start - norm * thickness;
+        b = start + norm * thickness;
+        c = end - norm * thickness;
+        d = end + norm * thickness;
+
+        // clip quad outline and triangulate what is left
+        if( clip == CLIP_PARTIAL ) {
+            m_clip_points.assign( { a, b, d, c } );
+
+            clip_polygon( m_clip_points, get_clip_rect(), m_clip_scratch );
+            add_convex_polygon( m_clip_points, color );
+
+            return;
+        }
+
+        vertices[ 0 ] = { a, color };
+        vertices[ 1 ] = { b, color };
+        vertices[ 2 ] = { d, color };
+
+        vertices[ 3 ] = { c, color };
+        vertices[ 4 ] = { d, color };
+        vertices[ 5 ] = { a, color };
+
+        add_vertices( vertices, 6, D3DPT_TRIANGLELIST );
+    }
+}
+
+NOINLINE void Renderer::draw_line( float start_x, float start_y, float end_x, float end_y, const Color color, float thickness ) {
+    draw_line( { start_x, start_y }, { end_x, end_y }, color, thickness );
+}
+
+NOINLINE void Renderer::draw_filled_rect( const Vec2_t &pos, const Vec2_t &size, const Color color ) { 
+    Vertex_t   vertices[ 6 ];
+    Rect_t     rect;
+    ClipResult clip;
+
+    if( !color.a )
+        return;
+
+    rect = Rect_t::from_size( pos, size );
+
+    clip = clip_test( rect );
+    if( clip == CLIP_REJECT )
+        return;
+
+    // a solid rect only needs its corners moved
+    if( clip == CLIP_PARTIAL )
+        rect = rect.intersection( get_clip_rect() );
+
+    if( m_instancing ) {
+        *reserve_instances( 1 ) = { rect.m_min, rect.m_max - rect.m_min, color };
+        return;
+    }
+
+    vertices[ 0 ] = { { rect.m_min.x, rect.m_min.y }, color };
+    vertices[ 1 ] = { { rect.m_max.x, rect.m_min.y }, color };
+    vertices[ 2 ] = { { rect.m_min.x, rect.m_max.y }, color };
+
+    vertices[ 3 ] = { { rect.m_max.x, rect.m_min.y }, color };
+    vertices[ 4 ] = { { rect.m_max.x, rect.m_max.y }, color };
+    vertices[ 5 ] = { { rect.m_min.x, rect.m_max.y }, color };
+
+    add_vertices( vertices, 6, D3DPT_TRIANGLELIST );
+}
+
+NOINLINE void Renderer::draw_filled_rect( float x, float y, float w, float h, const Color color ) {
+    draw_filled_rect( { x, y }, { w, h }, color );
+}
+
+NOINLINE void Renderer::draw_filled_gradient_rect( const Vec2_t &pos, const Vec2_t &size, const ColorRect &color_rect ) { //
+    Vertex_t   vertices[ 6 ];
+    ClipResult clip;
+
+    if( !color_rect.valid() || size.x == 0.f || size.y == 0.f )
+        return;
+
+    clip = clip_test( Rect_t::from_size( pos, size ) );
+    if( clip == CLIP_REJECT )
+        return;
+
+    auto x0     = pos.x;
+    auto y0     = pos.y;
+    auto x1     = pos.x + size.x;
+    auto y1     = pos.y + size.y;
+    auto colors = color_rect;
+
+    // clamp corners to the clip rect and resample the gradient at the new corners
+    if( clip == CLIP_PARTIAL ) {
+        const auto rect = get_clip_rect();
+
+        x0 = std::clamp( x0, rect.m_min.x, rect.m_max.x );
+        x1 = std::clamp( x1, rect.m_min.x, rect.m_max.x );
+        y0 = std::clamp( y0, rect.m_min.y, rect.m_max.y );
+        y1 = std::clamp( y1, rect.m_min.y, rect.m_max.y );
+
+        const auto sample = [ & ]( float x, float y ) {
+            const auto tx = ( x - pos.x ) / size.x;
+            const auto ty = ( y - pos.y ) / size.y;
+
+            const auto top    = color_rect.m_top_left.lerp( color_rect.m_top_right, tx );
+            const auto bottom = color_rect.m_bottom_left.lerp( color_rect.m_bottom_right, tx );
+
+            return top.lerp( bottom, ty );
+        };
+
+        colors = { sample( x0, y0 ), sample( x1, y0 ), sample( x0, y1 ), sample( x1, y1 ) };
+    }
+
+    vertices[ 0 ] = { { x0, y0 }, colors.m_top_left };
+    vertices[ 1 ] = { { x1, y0 }, colors.m_top_right };
+    vertices[ 2 ] = { { x0, y1 }, colors.m_bottom_left };
+
+    vertices[ 3 ] = { { x1, y0 }, colors.m_top_right };
+    vertices[ 4 ] = { { x1, y1 }, colors.m_bottom_right };
+    vertices[ 5 ] = { { x0, y1 }, colors.m_bottom_left };
+
+    add_vertices( vertices, 6, D3DPT_TRIANGLELIST );
+}
+
+NOINLINE void Renderer::draw_filled_gradient_rect( float x, float y, float w, float h, const ColorRect &color_rect ) {
+    draw_filled_gradient_rect( { x, y }, { w, h }, color_rect );
+}
+
+NOINLINE void Renderer::draw_rect( const Vec2_t &pos, const Vec2_t &size, const Color color, float thickness ) { 
+    // bottom line.
+    draw_filled_rect( pos.x, pos.y + size.y - thickness, size.x, thickness, color );
+      
+    // top line.
+    draw_filled_rect( pos.x, pos.y, size.x, thickness, color );
+    
+    // left line.
+    draw_filled_rect( pos.x, pos.y, thickness, size.y, color );
+
+    // right line.
+    draw_filled_rect( pos.x + size.x - thickness, pos.y, thickness, size.y, color );
+}
+
+NOINLINE void Renderer::draw_rect( float x, float y, float w, float h, const Color color, float thickness ) {
+    draw_rect( { x, y }, { w, h }, color, thickness );
+}
+
+NOINLINE void Renderer::draw_outlined_filled_rect( const Vec2_t &pos, const Vec2_t &size, const Color fill_color, const Color outline_color ) {
+    draw_filled_rect( pos.x, pos.y, size.x, size.y, fill_color );
+    draw_rect( pos.x - 1.f, pos.y - 1.f, size.x + 2.f, size.y + 2.f, outline_color );
+}
+
+NOINLINE void Renderer::draw_outlined_filled_rect( float x, float y, float w, float h, const Color fill_color, const Color outline_color ) {
+    draw_outlined_filled_rect( { x, y }, { w, h }, fill_color, outline_color );
+}
+
+NOINLINE void Renderer::draw_outlined_rect( const Vec2_t &pos, const Vec2_t &size, const Color inner_color, const Color outline_color ) {
+    // outline
+    draw_rect( pos.x - 1.f, pos.y - 1.f, size.x + 2.f, size.y + 2.f, outline_color );
+    draw_rect( pos.x + 1.f, pos.y + 1.f, size.x - 2.f, size.y - 2.f, outline_color );
+
+    // inner line
+    draw_rect( pos.x, pos.y, size.x, size.y, inner_color );
+}
+
+NOINLINE void Renderer::draw_outlined_rect( float x, float y, float w, float h, const Color inner_color, const Color outline_color ) {
+    draw_outlined_rect( { x, y }, { w, h }, inner_color, outline_color );
+}
+
+NOINLINE const CircleTable_t &Renderer::get_circle_table( size_t segment_count ) {
+    const auto index = segment_count / 4;
+
+    if( m_circle_tables.size() <= index )
+        m_circle_tables.resize( index + 1 );
+
+    auto &table = m_circle_tables[ index ];
+
+    // build unit circle on first use, trig is only ever evaluated once per segment count
+    if( !table ) {
+        table = std::make_unique< CircleTable_t >();
+        table->m_cos.resize( segment_count + 1 );
+        table->m_sin.resize( segment_count + 1 );
+
+        for( size_t i = 0; i < segment_count; ++i ) {
+            const auto angle = Math::pi_2 * ( float ) i / ( float ) segment_count;
+
+            table->m_cos[ i ] = std::cos( angle );
+            table->m_sin[ i ] = std::sin( angle );
+        }
+
+        // close the circle exactly
+        table->m_cos[ segment_count ] = table->m_cos[ 0 ];
+        table->m_sin[ segment_count ] = table->m_sin[ 0 ];
+    }
+
+    return *table;
+}
+
+NOINLINE void Renderer::build_arc( const Vec2_t &pos, float radius, float start_angle, float sweep, std::vector< Vec2_t > &points ) {
+    size_t first, last;
+
+    const auto segment_count = Math::circle_segments( radius, m_circle_error );
+    const auto &table        = get_circle_table( segment_count );
+
+    points.clear();
+
+    // full circle, straight from the table
+    if( sweep >= Math::pi_2 ) {
+        points.resize( segment_count + 1 );
+        VertexKernels::from_unit_circle( points.data(), table.m_cos.data(), table.m_sin.data(), segment_count + 1, pos, radius );
+
+        return;
+    }
+
+    // arc, exact end points with the table points between them
+    start_angle = std::fmod( start_angle, Math::pi_2 );
+    if( start_angle < 0.f )
+        start_angle += Math::pi_2;
+
+    const auto step = Math::pi_2 / ( float ) segment_count;
+
+    first = ( size_t ) std::floor( start_angle / step ) + 1;
+    last  = ( size_t ) std::ceil( ( start_angle + sweep ) / step ) - 1;
+
+    const auto count = last >= first ? last - first + 1 : 0;
+
+    points.resize( count + 2 );
+    points.front() = { pos.x + radius * std::cos( start_angle ), pos.y + radius * std::sin( start_angle ) };
+
+    // table points in at most two runs, the second after wrapping past 0
+    const auto index = first % segment_count;
+    const auto run   = std::min( count, segment_count - index );
+
+    VertexKernels::from_unit_circle( &points[ 1 ], &table.m_cos[ index ], &table.m_sin[ index ], run, pos, radius );
+    VertexKernels::from_unit_circle( &points[ 1 + run ], table.m_cos.data(), table.m_sin.data(), count - run, pos, radius );
+
+    points.back() = { pos.x + radius * std::cos( start_angle + sweep ), pos.y + radius * std::sin( start_angle + sweep ) };
+}
+
+NOINLINE void Renderer::add_polyline_segments( const std::vector< Vec2_t > &points, const Color color, ClipResult clip ) {
+    if( points.size() < 2 )
+        return;
+
+    // clip every segment on its own, only what survives is emitted
+    if( clip == CLIP_PARTIAL ) {
+        const auto rect = get_clip_rect();
+
+        for( size_t i = 0; i + 1 < points.size(); ++i ) {
+            auto start = points[ i ];
+            auto end   = points[ i + 1 ];
+
+            if( !clip_line( start, end, rect ) )
+                continue;
+
+            const auto vertices = reserve_vertices( 2, D3DPT_LINELIST );
+            vertices[ 0 ] = { start, color };
+            vertices[ 1 ] = { end, color };
+        }
+
+        return;
+    }
+
+    // emitted as a list so consecutive shapes share one batch
+    const auto vertices = reserve_vertices( ( points.size() - 1 ) * 2, D3DPT_LINELIST );
+    for( size_t i = 0; i + 1 < points.size(); ++i ) {
+        vertices[ i * 2 ]     = { points[ i ], color };
+        vertices[ i * 2 + 1 ] = { points[ i + 1 ], color };
+    }
+}
+
+NOINLINE void Renderer::add_triangle( const Vec2_t &a, const Vec2_t &b, const Vec2_t &c, const Color color, ClipResult clip ) {
+    // clip triangle on its own, each one is convex
+    if( clip == CLIP_PARTIAL ) {
+        m_clip_points.assign( { a, b, c } );
+
+        clip_polygon( m_clip_points, get_clip_rect(), m_clip_scratch );
+        add_convex_polygon( m_clip_points, color );
+
+        return;
+    }
+
+    const auto vertices = reserve_vertices( 3, D3DPT_TRIANGLELIST );
+    vertices[ 0 ] = { a, color };
+    vertices[ 1 ] = { b, color };
+    vertices[ 2 ] = { c, color };
+}
+
+NOINLINE void Renderer::draw_circle( const Vec2_t &pos, float radius, const Color color ) {
+    draw_arc( pos, radius, 0.f, Math::pi_2, color );
+}
+
+NOINLINE void Renderer::draw_circle( float x, float y, float radius, const Color color ) {
+    draw_circle( { x, y }, radius, color );
+}
+
+NOINLINE void Renderer::draw_filled_circle( const Vec2_t &pos, float radius, const Color color ) {
+    draw_sector( pos, radius, 0.f, Math::pi_2, color );
+}
+
+NOINLINE void Renderer::draw_filled_circle( float x, float y, float radius, const Color color ) {
+    draw_filled_circle( { x, y }, radius, color );
+}
+
+NOINLINE void Renderer::draw_arc( const Vec2_t &pos, float radius, float start_angle, float sweep, const Color color, float thickness ) {
+    ClipResult clip;
+
+    if( !color.a || radius <= 0.f || sweep <= 0.f )
+        return;
+
+    // cull against the full circle bounds
+    const auto extent = radius + std::max( thickness, 1.f );
+
+    clip = clip_test( { { pos.x - extent, pos.y - extent }, { pos.x + extent, pos.y + extent } } );
+    if( clip == CLIP_REJECT )
+        return;
+
+    // 1 pixel arc
+    if( thickness <= 1.f ) {
+        build_arc( pos, radius, start_angle, sweep, m_arc_points );
+        add_polyline_segments( m_arc_points, color, clip );
+
+        return;
+    }
+
+    // thick arc, band between the inner and outer radius. thickness extends to both sides like draw_line
+    build_arc( pos, radius + thickness, start_angle, sweep, m_arc_points );
+
+    // inner ring reuses the outer ring's angles so the quads line up. once it reaches the center the band is a sector
+    const auto inner_scale = std::max( radius - thickness, 0.f ) / ( radius + thickness );
+
+    for( size_t i = 0; i + 1 < m_arc_points.size(); ++i ) {
+        const auto outer_a = m_arc_points[ i ];
+        const auto outer_b = m_arc_points[ i + 1 ];
+
+        if( inner_scale == 0.f ) {
+            add_triangle( pos, outer_a, outer_b, color, clip );
+            continue;
+        }
+
+        const auto inner_a = pos + ( outer_a - pos ) * inner_scale;
+        const auto inner_b = pos + ( outer_b - pos ) * inner_scale;
+
+        add_triangle( inner_a, outer_a, outer_b, color, clip );
+        add_triangle( inner_a, outer_b, inner_b, color, clip );
+    }
+}
+
+NOINLINE void Renderer::draw_arc( float x, float y, float radius, float start_angle, float sweep, const Color color, float thickness ) {
+    draw_arc( { x, y }, radius, start_angle, sweep, color, thickness );
+}
+
+NOINLINE void Renderer::draw_sector( const Vec2_t &pos, float radius, float start_angle, float sweep, const Color color ) {
+    ClipResult clip;
+
+    if( !color.a || radius <= 0.f || sweep <= 0.f )
+        return;
+
+    clip = clip_test( { { pos.x - radius, pos.y - radius }, { pos.x + radius, pos.y + radius } } );
+    if( clip == CLIP_REJECT )
+        return;
+
+    build_arc( pos, radius, start_angle, sweep, m_arc_points );
+    if( m_arc_points.size() < 2 )
+        return;
+
+    // fan around the center, emitted as a list so consecutive shapes share one batch
+    if( clip == CLIP_ACCEPT ) {
+        const auto triangle_count = m_arc_points.size() - 1;
+        const auto vertices       = reserve_vertices( triangle_count * 3, D3DPT_TRIANGLELIST );
+
+        for( size_t i = 0; i < triangle_count; ++i ) {
+            vertices[ i * 3 ]     = { pos, color };
+            vertices[ i * 3 + 1 ] = { m_arc_points[ i ], color };
+            vertices[ i * 3 + 2 ] = { m_arc_points[ i + 1 ], color };
+        }
+
+        return;
+    }
+
+    for( size_t i = 0; i + 1 < m_arc_points.size(); ++i )
+        add_triangle( pos, m_arc_points[ i ], m_arc_points[ i + 1 ], color, clip );
+}
+
+NOINLINE void Renderer::draw_sector( float x, float y, float radius, float start_angle, float sweep, const Color color ) {
+    draw_sector( { x, y }, radius, start_angle, sweep, color );
+}
+
+NOINLINE void Renderer::draw_filled_rects( const FilledRect_t *rects, size_t count ) {
+    Vertex_t *vertices;
+    size_t   visible;
+
+    if( !rects || !count )
+        return;
+
+    PROFILE_FUNCTION();
+
+    // classify everything first so the vertices are reserved once
+    m_batch_clip.resize( count );
+
+    visible = 0;
+
+    for( size_t i = 0; i < count; ++i ) {
+        m_batch_clip[ i ] = rects[ i ].m_color.a ? clip_test( Rect_t::from_size( rects[ i ].m_pos, rects[ i ].m_size ) ) : CLIP_REJECT;
+
+        if( m_batch_clip[ i ] != CLIP_REJECT )
+            ++visible;
+    }
+
+    if( !visible )
+        return;
+
+    const auto clip_rect = get_clip_rect();
+
+    if( m_instancing ) {
+        auto instances = reserve_instances( visible );
+
+        for( size_t i = 0; i < count; ++i ) {
+            if( m_batch_clip[ i ] == CLIP_REJECT )
+                continue;
+
+            auto rect = Rect_t::from_size( rects[ i ].m_pos, rects[ i ].m_size );
+
+            if( m_batch_clip[ i ] == CLIP_PARTIAL )
+                rect = rect.intersection( clip_rect );
+
+            *instances++ = { rect.m_min, rect.m_max - rect.m_min, rects[ i ].m_color };
+        }
+
+        return;
+    }
+
+    vertices = reserve_vertices( visible * 6, D3DPT_TRIANGLELIST );
+
+    for( size_t i = 0; i < count; ++i ) {
+        if( m_batch_clip[ i ] == CLIP_REJECT )
+            continue;
+
+        auto rect = Rect_t::from_size( rects[ i ].m_pos, rects[ i ].m_size );
+
+        // a solid rect only needs its corners moved
+        if( m_batch_clip[ i ] == CLIP_PARTIAL )
+            rect = rect.intersection( clip_rect );
+
+        const auto color = rects[ i ].m_color;
+
+        vertices[ 0 ] = { { rect.m_min.x, rect.m_min.y }, color };
+        vertices[ 1 ] = { { rect.m_max.x, rect.m_min.y }, color };
+        vertices[ 2 ] = { { rect.m_min.x, rect.m_max.y }, color };
+
+        vertices[ 3 ] = { { rect.m_max.x, rect.m_min.y }, color };
+        vertices[ 4 ] = { { rect.m_max.x, rect.m_max.y }, color };
+        vertices[ 5 ] = { { rect.m_min.x, rect.m_max.y }, color };
+
+        vertices += 6;
+    }
+}
+
+NOINLINE void Renderer::draw_lines( const LineSegment_t *lines, size_t count, float thickness ) {
+    Vertex_t *vertices;
+    size_t   visible, written, deferred;
+
+    if( !lines || !count )
+        return;
+
+    PROFILE_FUNCTION();
+
+    const auto extent = std::max( thickness, 1.f );
+    const auto thin   = thickness <= 1.f;
+
+    m_batch_clip.resize( count );
+
+    visible  = 0;
+    deferred = 0;
+
+    for( size_t i = 0; i < count; ++i ) {
+        const auto &line = lines[ i ];
+
+        if( line.m_start == line.m_end || !line.m_color.a ) {
+            m_batch_clip[ i ] = CLIP_REJECT;
+            continue;
+        }
+
+        m_batch_clip[ i ] = clip_test( { 
+            { std::min( line.m_start.x, line.m_end.x ) - extent, std::min( line.m_start.y, line.m_end.y ) - extent }, 
+            { std::max( line.m_start.x, line.m_end.x ) + extent, std::max( line.m_start.y, line.m_end.y ) + extent } 
+        } );
+
+        // clipped thick lines turn into polygons of varying size, they go through draw_line afterwards
+        if( m_batch_clip[ i ] == CLIP_PARTIAL && !thin )
+            ++deferred;
+        else if( m_batch_clip[ i ] != CLIP_REJECT )
+            ++visible;
+    }
+
+    if( visible ) {
+        const auto clip_rect = get_clip_rect();
+
+        written  = 0;
+        vertices = reserve_vertices( visible * ( thin ? 2 : 6 ), thin ? D3DPT_LINELIST : D3DPT_TRIANGLELIST );
+
+        for( size_t i = 0; i < count; ++i ) {
+            const auto &line = lines[ i ];
+
+            if( m_batch_clip[ i ] == CLIP_REJECT || ( m_batch_clip[ i ] == CLIP_PARTIAL && !thin ) )
+                continue;
+
+            if( thin ) {
+                auto start = line.m_start;
+                auto end   = line.m_end;
+
+                if( m_batch_clip[ i ] == CLIP_PARTIAL && !clip_line( start, end, clip_rect ) )
+                    continue;
+
+                vertices[ written ]     = { start, line.m_color };
+                vertices[ written + 1 ] = { end, line.m_color };
+
+                written += 2;
+                continue;
+            }
+
+            // same quad as draw_line
+            const auto diff = line.m_end - line.m_start;
+            const auto norm = Vec2_t( -diff.y, diff.x ).normalized_fast() * thickness;
+
+            const auto a = line.m_start - norm;
+            const auto b = line.m_start + norm;
+            const auto c = line.m_end - norm;
+            const auto d = line.m_end + norm;
+
+            vertices[ written ]     = { a, line.m_color };
+            vertices[ written + 1 ] = { b, line.m_color };
+            vertices[ written + 2 ] = { d, line.m_color };
+
+            vertices[ written + 3 ] = { c, line.m_color };
+            vertices[ written + 4 ] = { d, line.m_color };
+            vertices[ written + 5 ] = { a, line.m_color };
+
+            written += 6;
+        }
+
+        // lines the clip rect removed entirely
+        unreserve_vertices( visible * ( thin ? 2 : 6 ) - written );
+    }
+
+    if( !deferred )
+        return;
+
+    for( size_t i = 0; i < count; ++i ) {
+        if( m_batch_clip[ i ] == CLIP_PARTIAL )
+            draw_line( lines[ i ].m_start, lines[ i ].m_end, lines[ i ].m_color, thickness );
+    }
+}
+
+NOINLINE void Renderer::draw_polyline( const Vec2_t *points, size_t count, const Color color, float thickness, bool closed ) {
+    Vec2_t     min, max;
+    ClipResult clip;
+
+    if( !points || count < 2 || !color.a )
+        return;
+
+    PROFILE_FUNCTION();
+
+    // drop repeated points, they have no direction to join
+    m_polyline_points.clear();
+
+    for( size_t i = 0; i < count; ++i ) {
+        if( m_polyline_points.empty() || m_polyline_points.back() != points[ i ] )
+            m_polyline_points.push_back( points[ i ] );
+    }
+
+    if( closed && m_polyline_points.size() > 2 && m_polyline_points.front() == m_polyline_points.back() )
+        m_polyline_points.pop_back();
+
+    const auto point_count = m_polyline_points.size();
+    if( point_count < 2 )
+        return;
+
+    closed = closed && point_count > 2;
+
+    min = max = m_polyline_points[ 0 ];
+
+    for( const auto &point : m_polyline_points ) {
+        min = { std::min( min.x, point.x ), std::min( min.y, point.y ) };
+        max = { std::max( max.x, point.x ), std::max( max.y, point.y ) };
+    }
+
+    // a miter reaches at most polyline_miter_limit * thickness past its point
+    const auto extent = std::max( thickness, 1.f ) * polyline_miter_limit;
+
+    clip = clip_test( { min - extent, max + extent } );
+    if( clip == CLIP_REJECT )
+        return;
+
+    const auto segment_count = closed ? point_count : point_count - 1;
+
+    // 1 pixel polyline
+    if( thickness <= 1.f ) {
+        if( clip == CLIP_PARTIAL ) {
+            if( closed )
+                m_polyline_points.push_back( m_polyline_points.front() );
+
+            add_polyline_segments( m_polyline_points, color, clip );
+            return;
+        }
+
+        const auto vertices = reserve_vertices( segment_count * 2, D3DPT_LINELIST );
+        for( size_t i = 0; i < segment_count; ++i ) {
+            vertices[ i * 2 ]     = { m_polyline_points[ i ], color };
+            vertices[ i * 2 + 1 ] = { m_polyline_points[ ( i + 1 ) % point_count ], color };
+        }
+
+        return;
+    }
+
+    m_polyline_normals.resize( segment_count );
+
+    for( size_t i = 0; i < segment_count; ++i ) {
+        const auto diff = m_polyline_points[ ( i + 1 ) % point_count ] - m_polyline_points[ i ];
+
+        m_polyline_normals[ i ] = Vec2_t( -diff.y, diff.x ).normalized_fast();
+    }
+
+    // offset shared by both segments at a corner, false if the miter is too long and the corner is beveled instead
+    const auto miter = [ & ]( const Vec2_t &n0, const Vec2_t &n1, Vec2_t &offset ) {
+        const auto dir      = ( n0 + n1 ).normalized_fast();
+        const auto cos_half = dir.x * n0.x + dir.y * n0.y;
+
+        if( cos_half < 1.f / polyline_miter_limit )
+            return false;
+
+        offset = dir * ( thickness / cos_half );
+        return true;
+    };
+
+    // quads along the segments, thickness extends to both sides like draw_line
+    const auto build = [ & ]( auto &&emit ) {
+        for( size_t i = 0; i < segment_count; ++i ) {
+            Vec2_t start_offset, end_offset;
+
+            const auto &p0   = m_polyline_points[ i ];
+            const auto &p1   = m_polyline_points[ ( i + 1 ) % point_count ];
+            const auto &norm = m_polyline_normals[ i ];
+
+            const auto has_prev = closed || i > 0;
+            const auto has_next = closed || i + 1 < segment_count;
+            const auto &prev    = m_polyline_normals[ ( i + segment_count - 1 ) % segment_count ];
+            const auto &next    = m_polyline_normals[ ( i + 1 ) % segment_count ];
+
+            if( !has_prev || !miter( prev, norm, start_offset ) ) {
+                start_offset = norm * thickness;
+
+                // bevel fills the gap on the outer side of the turn
+                if( has_prev ) {
+                    const auto side = ( prev.x * norm.y - prev.y * norm.x ) > 0.f ? -thickness : thickness;
+
+                    emit( p0, p0 + prev * side, p0 + norm * side );
+                }
+            }
+
+            if( !has_next || !miter( norm, next, end_offset ) )
+                end_offset = norm * thickness;
+
+            const auto a = p0 - start_offset;
+            const auto b = p0 + start_offset;
+            const auto c = p1 - end_offset;
+            const auto d = p1 + end_offset;
+
+            emit( a, b, d );
+            emit( c, d, a );
+        }
+    };
+
+    if( clip == CLIP_PARTIAL ) {
+        build( [ & ]( const Vec2_t &a, const Vec2_t &b, const Vec2_t &c ) {
+            add_triangle( a, b, c, color, clip );
+        } );
+
+        return;
+    }
+
+    // worst case every corner is beveled, the rest is given back
+    const auto join_count = closed ? point_count : point_count - 2;
+    const auto reserved   = segment_count * 6 + join_count * 3;
+    const auto vertices   = reserve_vertices( reserved, D3DPT_TRIANGLELIST );
+
+    size_t written = 0;
+
+    build( [ & ]( const Vec2_t &a, const Vec2_t &b, const Vec2_t &c ) {
+        vertices[ written ]     = { a, color };
+        vertices[ written + 1 ] = { b, color };
+        vertices[ written + 2 ] = { c, color };
+
+        written += 3;
+    } );
+
+    unreserve_vertices( reserved - written );
+}
+
+NOINLINE void Renderer::draw_circles( const Circle_t *circles, size_t count ) {
+    Vertex_t *vertices;
+    size_t   vertex_count;
+    bool     deferred;
+
+    if( !circles || !count )
+        return;
+
+    PROFILE_FUNCTION();
+
+    m_batch_clip.resize( count );
+    m_batch_segments.resize( count );
+
+    vertex_count = 0;
+    deferred     = false;
+
+    for( size_t i = 0; i < count; ++i ) {
+        const auto &circle = circles[ i ];
+
+        if( !circle.m_color.a || circle.m_radius <= 0.f ) {
+            m_batch_clip[ i ] = CLIP_REJECT;
+            continue;
+        }
+
+        const auto extent = circle.m_radius + 1.f;
+
+        m_batch_clip[ i ] = clip_test( { { circle.m_pos.x - extent, circle.m_pos.y - extent }, { circle.m_pos.x + extent, circle.m_pos.y + extent } } );
+
+        // clipped circles go through draw_circle afterwards
+        if( m_batch_clip[ i ] == CLIP_PARTIAL )
+            deferred = true;
+        else if( m_batch_clip[ i ] == CLIP_ACCEPT ) {
+            m_batch_segments[ i ] = Math::circle_segments( circle.m_radius, m_circle_error );
+            vertex_count         += m_batch_segments[ i ] * 2;
+        }
+    }
+
+    // reserved a chunk at a time. resize zero fills what it adds, a chunk is still in cache when the vertices are
+    // written over it, one reservation for everything would stream megabytes through memory twice
+    for( size_t i = 0, end; vertex_count && i < count; i = end ) {
+        size_t chunk_count = 0;
+
+        for( end = i; end < count && chunk_count < batch_chunk_vertices; ++end ) {
+            if( m_batch_clip[ end ] == CLIP_ACCEPT )
+                chunk_count += m_batch_segments[ end ] * 2;
+        }
+
+        if( !chunk_count )
+            break;
+
+        vertices = reserve_vertices( chunk_count, D3DPT_LINELIST );
+
+        for( ; i < end; ++i ) {
+            if( m_batch_clip[ i ] != CLIP_ACCEPT )
+                continue;
+
+            const auto &circle       = circles[ i ];
+            const auto segment_count = m_batch_segments[ i ];
+            const auto &table        = get_circle_table( segment_count );
+
+            // whole vertices in one pass, every ring point is computed once and ends one segment and starts the next
+            Vec2_t point = { circle.m_pos.x + circle.m_radius * table.m_cos[ 0 ], circle.m_pos.y + circle.m_radius * table.m_sin[ 0 ] };
+
+            for( size_t j = 0; j < segment_count; ++j ) {
+                const Vec2_t next = { circle.m_pos.x + circle.m_radius * table.m_cos[ j + 1 ], circle.m_pos.y + circle.m_radius * table.m_sin[ j + 1 ] };
+
+                vertices[ j * 2 ]     = { point, circle.m_color };
+                vertices[ j * 2 + 1 ] = { next, circle.m_color };
+
+                point = next;
+            }
+
+            vertices += segment_count * 2;
+        }
+    }
+
+    if( !deferred )
+        return;
+
+    for( size_t i = 0; i < count; ++i ) {
+        if( m_batch_clip[ i ] == CLIP_PARTIAL )
+            draw_circle( circles[ i ].m_pos, circles[ i ].m_radius, circles[ i ].m_color );
+    }
+}
+
+NOINLINE void Renderer::draw_filled_circles( const Circle_t *circles, size_t count ) {
+    Vertex_t *vertices;
+    size_t   vertex_count;
+    bool     deferred;
+
+    if( !circles || !count )
+        return;
+
+    PROFILE_FUNCTION();
+
+    m_batch_clip.resize( count );
+    m_batch_segments.resize( count );
+
+    vertex_count = 0;
+    deferred     = false;
+
+    for( size_t i = 0; i < count; ++i ) {
+        const auto &circle = circles[ i ];
+
+        if( !circle.m_color.a || circle.m_radius <= 0.f ) {
+            m_batch_clip[ i ] = CLIP_REJECT;
+            continue;
+        }
+
+        m_batch_clip[ i ] = clip_test( { { circle.m_pos.x - circle.m_radius, circle.m_pos.y - circle.m_radius }, { circle.m_pos.x + circle.m_radius, circle.m_pos.y + circle.m_radius } } );
+
+        // clipped circles go through draw_filled_circle afterwards
+        if( m_batch_clip[ i ] == CLIP_PARTIAL )
+            deferred = true;
+        else if( m_batch_clip[ i ] == CLIP_ACCEPT ) {
+            m_batch_segments[ i ] = Math::circle_segments( circle.m_radius, m_circle_error );
+            vertex_count         += m_batch_segments[ i ] * 3;
+        }
+    }
+
+    // reserved a chunk at a time. resize zero fills what it adds, a chunk is still in cache when the vertices are
+    // written over it, one reservation for everything would stream megabytes through memory twice
+    for( size_t i = 0, end; vertex_count && i < count; i = end ) {
+        size_t chunk_count = 0;
+
+        for( end = i; end < count && chunk_count < batch_chunk_vertices; ++end ) {
+            if( m_batch_clip[ end ] == CLIP_ACCEPT )
+                chunk_count += m_batch_segments[ end ] * 3;
+        }
+
+        if( !chunk_count )
+            break;
+
+        vertices = reserve_vertices( chunk_count, D3DPT_TRIANGLELIST );
+
+        for( ; i < end; ++i ) {
+            if( m_batch_clip[ i ] != CLIP_ACCEPT )
+                continue;
+
+            const auto &circle       = circles[ i ];
+            const auto segment_count = m_batch_segments[ i ];
+            const auto &table        = get_circle_table( segment_count );
+
+            // fan around the center, emitted as a list so consecutive shapes share one batch. one pass like draw_circles
+            Vec2_t point = { circle.m_pos.x + circle.m_radius * table.m_cos[ 0 ], circle.m_pos.y + circle.m_radius * table.m_sin[ 0 ] };
+
+            for( size_t j = 0; j < segment_count; ++j ) {
+                const Vec2_t next = { circle.m_pos.x + circle.m_radius * table.m_cos[ j + 1 ], circle.m_pos.y + circle.m_radius * table.m_sin[ j + 1 ] };
+
+                vertices[ j * 3 ]     = { circle.m_pos, circle.m_color };
+                vertices[ j * 3 + 1 ] = { point, circle.m_color };
+                vertices[ j * 3 + 2 ] = { next, circle.m_color };
+
+                point = next;
+            }
+
+            vertices += segment_count * 3;
+        }
+    }
+
+    if( !deferred )
+        return;
+
+    for( size_t i = 0; i < count; ++i ) {
+        if( m_batch_clip[ i ] == CLIP_PARTIAL )
+            draw_filled_circle( circles[ i ].m_pos, circles[ i ].m_radius, circles[ i ].m_color );
+    }
+}
+
+NOINLINE void Renderer::add_texture_quad( const Vec2_t &pos, const Vec2_t &size, const Color color, IDirect3DTexture9 *texture, const std::array< Vector2, 6 > &uv_coords, 
+    IDirect3DPixelShader9 *pixel_shader, const Vec2_t &shader_params ) {
+    std::array< Vertex_t, 6 > vertices;
+    ClipResult                clip;
+
+    if( !color.a || size.x == 0.f || size.y == 0.f )
+        return;
+
+    clip = clip_test( Rect_t::from_size( pos, size ) );
+    if( clip == CLIP_REJECT )
+        return;
+
+    auto x0  = pos.x;
+    auto y0  = pos.y;
+    auto x1  = pos.x + size.x;
+    auto y1  = pos.y + size.y;
+    auto uvs = uv_coords;
+
+    // clamp corners to the clip rect and move the uvs along with them
+    if( clip == CLIP_PARTIAL ) {
+        const auto rect = get_clip_rect();
+
+        x0 = std::clamp( x0, rect.m_min.x, rect.m_max.x );
+        x1 = std::clamp( x1, rect.m_min.x, rect.m_max.x );
+        y0 = std::clamp( y0, rect.m_min.y, rect.m_max.y );
+        y1 = std::clamp( y1, rect.m_min.y, rect.m_max.y );
+
+        // corner uvs, see vertex layout below
+        const auto sample = [ & ]( float x, float y ) {
+            const auto tx = ( x - pos.x ) / size.x;
+            const auto ty = ( y - pos.y ) / size.y;
+
+            const auto top    = uv_coords[ 2 ] + ( uv_coords[ 4 ] - uv_coords[ 2 ] ) * tx;
+            const auto bottom = uv_coords[ 0 ] + ( uv_coords[ 1 ] - uv_coords[ 0 ] ) * tx;
+
+            return top + ( bottom - top ) * ty;
+        };
+
+        uvs[ 0 ] = sample( x0, y1 );
+        uvs[ 1 ] = sample( x1, y1 );
+        uvs[ 2 ] = sample( x0, y0 );
+        uvs[ 3 ] = uvs[ 1 ];
+        uvs[ 4 ] = sample( x1, y0 );
+        uvs[ 5 ] = uvs[ 2 ];
+    }
+
+    vertices[ 0 ] = { { x0, y1 }, color, uvs[ 0 ] };
+    vertices[ 1 ] = { { x1, y1 }, color, uvs[ 1 ] };
+    vertices[ 2 ] = { { x0, y0 }, color, uvs[ 2 ] };
+
+    vertices[ 3 ] = { { x1, y1 }, color, uvs[ 3 ] };
+    vertices[ 4 ] = { { x1, y0 }, color, uvs[ 4 ] };
+    vertices[ 5 ] = { { x0, y0 }, color, uvs[ 5 ] };
+
+    add_vertices( vertices.data(), 6, D3DPT_TRIANGLELIST, texture, pixel_shader, shader_params );
+}
+
+NOINLINE void Renderer::draw_texture_quad( const Vec2_t &pos, const Vec2_t &size, const Color color, IDirect3DTexture9 *texture, const std::array<Vector2, 6> &uv_coords ) {
+    add_texture_quad( pos, size, color, texture, uv_coords );
+}
+
+NOINLINE void Renderer::draw_texture_quad( float x, float y, float w, float h, const Color color, IDirect3DTexture9 *texture, const std::array<Vector2, 6> &uv_coords ) {
+    draw_texture_quad( { x, y }, { w, h }, color, texture, uv_coords );
+}
+
+NOINLINE void Renderer::draw_sprite( sprite_id_t sprite_id, const Vec2_t &pos, const Vec2_t &size, const Color color ) {
+    const auto sprite = m_sprite_atlas.get_sprite( sprite_id );
+    if( !sprite || sprite->m_page >= m_sprite_pages.size() )
+        return;
+
+    const auto texture = m_texture_manager.acquire( m_sprite_pages[ sprite->m_page ] );
+    if( !texture )
+        return;
+
+    const std::array< Vec2_t, 6 > uv_coords = {
+        {
+            { sprite->m_u0, sprite->m_v1 },
+            { sprite->m_u1, sprite->m_v1 },
+            { sprite->m_u0, sprite->m_v0 },
+            { sprite->m_u1, sprite->m_v1 },
+            { sprite->m_u1, sprite->m_v0 },
+            { sprite->m_u0, sprite->m_v0 }
+        }
+    };
+
+    // same page and shader, consecutive sprites merge into one batch
+    add_texture_quad( pos, size, color, texture, uv_coords, m_sprite_shader );
+}
+
+NOINLINE void Renderer::draw_sprite( sprite_id_t sprite_id, const Vec2_t &pos, const Color color, float scale ) {
+    const auto sprite = m_sprite_atlas.get_sprite( sprite_id );
+    if( !sprite )
+        return;
+
+    draw_sprite( sprite_id, pos, { sprite->m_width * scale, sprite->m_height * scale }, color );
+}
+
+NOINLINE void Renderer::draw_texture_quad( const Vec2_t &pos, const Vec2_t &size, const Color color, texture_handle_t texture, const std::array<Vector2, 6> &uv_coords ) {
+    const auto d3d_texture = m_texture_manager.acquire( texture );
+    if( !d3d_texture )
+        return;
+
+    add_texture_quad( pos, size, color, d3d_texture, uv_coords );
+}
+
+NOINLINE const TextLayout_t &Renderer::get_text_layout( font_id_t font_id, std::string_view str, float max_width ) {
+    static const TextLayout_t empty_layout;
+
+    PROFILE_FUNCTION();
+
+    // measure with the font that would be drawn
+    font_id = resolve_font( font_id );
+    if( font_id == invalid_font_id )
+        return empty_layout;
+
+    const auto &font = m_fonts.at( font_id );
+
+    // a single unwrapped line is one pass over the glyphs, as cheap as the lookup. measuring it every call keeps
+    // text that changes each frame ( counters, timers ) from allocating cache entries
+    if( max_width <= 0.f && str.find( '\n' ) == std::string_view::npos ) {
+        font->layout_text( str, 0.f, m_line_spacing, m_line_layout );
+
+        return m_line_layout;
+    }
+
+    // width in font pixels, so draw scale doesn't split the cache.
+    // the lookup key is reused, copying the text into it doesn't allocate once it has grown
+    m_layout_key.m_font_id   = font_id;
+    m_layout_key.m_max_width = max_width > 0.f ? max_width : 0.f;
+    m_layout_key.m_text.assign( str.data(), str.size() );
+
+    auto it = m_layout_cache.find( m_layout_key );
+    if( it == m_layout_cache.end() ) {
+        // runaway cache ( ex. text that changes every frame ), start over
+        if( m_layout_cache.size() >= max_cached_layouts )
+            m_layout_cache.clear();
+
+        it = m_layout_cache.emplace( m_layout_key, TextLayoutEntry_t{} ).first;
+
+        font->layout_text( str, max_width, m_line_spacing, it->second.m_layout );
+    }
+
+    it->second.m_last_frame = m_layout_frame;
+
+    return it->second.m_layout;
+}
+
+NOINLINE void Renderer::evict_text_layouts() {
+    // drop layouts that weren't drawn or measured for a while
+    for( auto it = m_layout_cache.begin(); it != m_layout_cache.end(); ) {
+        if( m_layout_frame - it->second.m_last_frame > layout_cache_frames )
+            it = m_layout_cache.erase( it );
+        else
+            ++it;
+    }
+}
+
+NOINLINE Vec2_t Renderer::get_text_bounds( font_id_t font_id, std::string_view str, float max_width, float scale ) {
+    return get_text_layout( font_id, str, max_width > 0.f ? max_width / scale : 0.f ).m_size * scale;
+}
+
+NOINLINE void Renderer::add_text_run( const Font *font, std::string_view str, size_t begin, size_t end, const Vec2_t &baseline, uint32_t flags, const Color color, float scale, 
+    const std::vector< TextSpan_t > *spans, size_t &span_index ) {
+    const Font *owner;
+    size_t      index;
+
+    // current drawing position
+    auto pen_pos = baseline;
+
+    // parse through the text string
+    index = begin;
+    while( index < end ) {
+        const auto glyph_begin = index;
+        const auto codepoint   = Utils::decode_utf8( str.data(), end, index );
+
+        // find corresponding glyph, in this font or along its fallback chain
+        const auto glyph = font->resolve_glyph( codepoint, &owner );
+        if( !glyph )
+            continue;
+
+        // don't run rendering code on spaces, the page may have been evicted
+        const auto texture = glyph->m_size.x && glyph->m_size.y ? acquire_glyph_page( owner, glyph->m_page ) : nullptr;
+        if( texture ) {
+            TextQuad_t quad;
+            quad.m_pos     = { pen_pos.x + glyph->m_bearing.x * scale, pen_pos.y - glyph->m_bearing.y * scale };
+            quad.m_size    = glyph->m_size * scale;
+            quad.m_uv_min  = glyph->m_uv_min;
+            quad.m_uv_max  = glyph->m_uv_max;
+            quad.m_texture = texture;
+            quad.m_color   = color;
+            quad.m_colored = glyph->m_colored;
+            quad.m_layer   = 2;
+
+            // span color, spans are sorted and glyphs come in order so the cursor only moves forward
+            if( spans ) {
+                while( span_index < spans->size() && ( *spans )[ span_index ].m_end <= glyph_begin )
+                    ++span_index;
+
+                if( span_index < spans->size() && ( *spans )[ span_index ].m_begin <= glyph_begin )
+                    quad.m_color = ( *spans )[ span_index ].m_color;
+            }
+
+            // distance field glyphs go through the sdf shader, the edge softness covers about one screen pixel
+            if( owner->m_sdf ) {
+                quad.m_pixel_shader  = m_sdf_shader;
+                quad.m_shader_params = { std::min( 0.5f, 0.25f / ( ( float ) owner->m_sdf_spread * scale ) ), 0.5f };
+            }
+
+            m_text_quads.push_back( quad );
+
+            // shadow is the glyph again, offset and tinted. color glyphs don't tint so they don't get one
+            if( ( flags & Font::DROP_SHADOW ) && !glyph->m_colored ) {
+                auto shadow = quad;
+                shadow.m_pos   += m_text_shadow_offset;
+                shadow.m_color  = m_text_shadow_color;
+                shadow.m_layer  = 0;
+
+                m_text_quads.push_back( shadow );
+            }
+
+            if( ( flags & Font::OUTLINE ) && !glyph->m_colored ) {
+                // sdf, same glyph with the edge moved outwards
+                if( owner->m_sdf ) {
+                    const auto width = ( float ) std::max< size_t >( owner->m_outline_width, 1 );
+
+                    auto outline = quad;
+                    outline.m_color           = m_text_outline_color;
+                    outline.m_layer           = 1;
+                    outline.m_shader_params.y = std::max( 0.5f - width / ( 2.f * ( float ) owner->m_sdf_spread ), quad.m_shader_params.x );
+
+                    m_text_quads.push_back( outline );
+                }
+
+                // stroked outline from the atlas
+                else if( glyph->m_outline.m_size.x && glyph->m_outline.m_size.y ) {
+                    const auto &image = glyph->m_outline;
+
+                    auto outline = quad;
+                    outline.m_pos     = { pen_pos.x + image.m_bearing.x * scale, pen_pos.y - image.m_bearing.y * scale };
+                    outline.m_size    = image.m_size * scale;
+                    outline.m_uv_min  = image.m_uv_min;
+                    outline.m_uv_max  = image.m_uv_max;
+                    outline.m_texture = acquire_glyph_page( owner, image.m_page );
+                    outline.m_color   = m_text_outline_color;
+                    outline.m_layer   = 1;
+
+                    if( outline.m_texture )
+                        m_text_quads.push_back( outline );
+                }
+            }
+        }
+
+        // move pen position 
+        pen_pos.x += ( glyph->m_advance >> 6 ) * scale;
+    }
+}
+
+NOINLINE void Renderer::emit_text_quads() {
+    // group quads by atlas page and shader so the whole string lands in as few batches as possible.
+    // glyphs don't overlap, so the draw order within a layer doesn't matter. shadows and outlines
+    // go under every glyph, an outline could otherwise cover the neighbouring glyph
+    std::stable_sort( m_text_quads.begin(), m_text_quads.end(), []( const TextQuad_t &a, const TextQuad_t &b ) {
+        if( a.m_layer != b.m_layer )
+            return a.m_layer < b.m_layer;
+
+        if( a.m_texture != b.m_texture )
+            return a.m_texture < b.m_texture;
+
+        if( a.m_pixel_shader != b.m_pixel_shader )
+            return a.m_pixel_shader < b.m_pixel_shader;
+
+        if( a.m_shader_params.x != b.m_shader_params.x )
+            return a.m_shader_params.x < b.m_shader_params.x;
+
+        return a.m_shader_params.y < b.m_shader_params.y;
+    } );
+
+    for( const auto &quad : m_text_quads ) {
+        // glyph rect inside its atlas page
+        const auto &uv_min = quad.m_uv_min;
+        const auto &uv_max = quad.m_uv_max;
+
+        // bitmap glyphs as instances, clipped glyphs need their uvs moved and stay on the vertex path
+        if( m_instancing && !quad.m_pixel_shader && !quad.m_colored ) {
+            if( !quad.m_color.a || quad.m_size.x == 0.f || quad.m_size.y == 0.f )
+                continue;
+
+            const auto clip = clip_test( Rect_t::from_size( quad.m_pos, quad.m_size ) );
+            if( clip == CLIP_REJECT )
+                continue;
+
+            if( clip == CLIP_ACCEPT ) {
+                *reserve_instances( 1, quad.m_texture ) = { quad.m_pos, quad.m_size, quad.m_color, uv_min, uv_max };
+                continue;
+            }
+        }
+
+        const std::array< Vec2_t, 6 > uv_coords = {
+            {
+                { uv_min.x, uv_max.y },
+                { uv_max.x, uv_max.y },
+                { uv_min.x, uv_min.y },
+                { uv_max.x, uv_max.y },
+                { uv_max.x, uv_min.y },
+                { uv_min.x, uv_min.y }
+            }
+        };
+
+        m_device->SetTextureStageState( 0, D3DTSS_COLOROP, quad.m_colored ? D3DTOP_SELECTARG2 : D3DTOP_SELECTARG1 );
+
+        // draw glyph texture quad
+        add_texture_quad( quad.m_pos, quad.m_size, quad.m_color, quad.m_texture, uv_coords, quad.m_pixel_shader, quad.m_shader_params );
+    }
+
+    m_text_quads.clear();
+}
+
+NOINLINE void Renderer::draw_text_box( font_id_t font_id, std::string_view str, const Vec2_t &pos, float max_width, uint32_t flags, const Color color, float scale ) {
+    draw_text_spans( font_id, str, nullptr, pos, max_width, flags, color, scale );
+}
+
+NOINLINE void Renderer::draw_text_spans( font_id_t font_id, std::string_view str, const std::vector< TextSpan_t > *spans, const Vec2_t &pos, float max_width, uint32_t flags, const Color color, float scale ) {
+    Vec2_t offset;
+    size_t span_index;
+
+    PROFILE_FUNCTION();
+
+    // font still loading and no fallback, skip
+    font_id = resolve_font( font_id );
+    if( font_id == invalid_font_id )
+        return;
+
+    // raster copy at the ui scale
+    font_id = get_scaled_font( font_id, scale );
+
+    const auto &font = get_fonts().at( font_id );
+
+    // line breaks, cached while the text keeps being drawn
+    const auto &layout    = get_text_layout( font_id, str, max_width > 0.f ? max_width / scale : 0.f );
+    const auto &text_size = layout.m_size;
+
+    // does font have align flags?
+    const auto has_align_flag = ( flags & (
+        Font::ALIGN_LEFT | Font::ALIGN_RIGHT | Font::ALIGN_CENTER_X | Font::ALIGN_CENTER_Y | Font::ALIGN_CENTER
+        ) );
+
+    // align font position
+    if( has_align_flag ) {
+        // left align
+        if( ( flags & Font::ALIGN_LEFT ) )
+            offset.x += text_size.x;
+
+        // right align
+        else if( ( flags & Font::ALIGN_RIGHT ) )
+            offset.x -= text_size.x;
+
+        // center only x
+        else if( ( flags & Font::ALIGN_CENTER_X ) )
+            offset.x -= ( text_size.x * 0.5f );
+
+        // center only y
+        else if( ( flags & Font::ALIGN_CENTER_Y ) )
+            offset.y -= ( text_size.y * 0.5f );
+
+        // center on x and y
+        else if( ( flags & Font::ALIGN_CENTER ) ) {
+            offset.x -= ( text_size.x * 0.5f );
+            offset.y -= ( text_size.y * 0.5f );
+        }
+    }
+
+    // cull the whole block, padded by a line height since glyphs hang outside of the line box
+    const auto text_pos = pos + offset * scale;
+    const auto padding  = layout.m_line_height * scale;
+
+    if( clip_test( { { text_pos.x - padding, text_pos.y - padding }, { text_pos.x + ( text_size.x * scale ) + padding, text_pos.y + ( text_size.y * scale ) + padding } } ) == CLIP_REJECT )
         return;
 
-    for( auto i = 0; i <= segment_count; ++i ) {
-        const auto angle = 2.f * Math::pi * ( float ) i / ( float ) segment_count;
+    m_text_quads.clear();
+
+    span_index = 0;
+
+    for( size_t i = 0; i < layout.m_lines.size(); ++i ) {
+        const auto &line = layout.m_lines[ i ];
+
+        // per line alignment inside the block
+        auto line_x = 0.f;
+        if( flags & Font::ALIGN_RIGHT )
+            line_x = text_size.x - line.m_width;
+        else if( flags & ( Font::ALIGN_CENTER_X | Font::ALIGN_CENTER ) )
+            line_x = ( text_size.x - line.m_width ) * 0.5f;
+
+        // skip lines outside the clip rect
+        const auto line_top = text_pos.y + i * layout.m_line_advance * scale;
+        if( clip_test( { { text_pos.x - padding, line_top - padding }, { text_pos.x + ( text_size.x * scale ) + padding, line_top + ( layout.m_line_height * scale ) + padding } } ) == CLIP_REJECT )
+            continue;
+
+        const Vec2_t baseline = { text_pos.x + line_x * scale, line_top + layout.m_ascender * scale };
+
+        add_text_run( font.get(), str, line.m_begin, line.m_end, baseline, flags, color, scale, spans, span_index );
+    }
+
+    emit_text_quads();
+}
+
+NOINLINE void Renderer::draw_text_box( font_id_t font_id, std::string_view str, float x, float y, float max_width, uint32_t flags, const Color color, float scale ) {
+    draw_text_box( font_id, str, { x, y }, max_width, flags, color, scale );
+}
+
+NOINLINE void Renderer::draw_text( font_id_t font_id, std::string_view str, const std::vector< TextSpan_t > &spans, const Vec2_t &pos, uint32_t flags, const Color color, float scale ) {
+    draw_text_spans( font_id, str, &spans, pos, 0.f, flags, color, scale );
+}
+
+NOINLINE void Renderer::draw_text_markup( font_id_t font_id, std::string_view markup, const Vec2_t &pos, float max_width, uint32_t flags, const Color color, float scale ) {
+    PROFILE_FUNCTION();
+
+    parse_text_markup( markup, color, m_markup_text, m_markup_spans );
+
+    draw_text_spans( font_id, m_markup_text, &m_markup_spans, pos, max_width, flags, color, scale );
+}
+
+NOINLINE void Renderer::parse_text_markup( std::string_view markup, const Color color, std::string &text, std::vector< TextSpan_t > &spans ) {
+    size_t index, span_begin;
+    Color  span_color;
+
+    text.clear();
+    spans.clear();
+
+    // hex digit value, -1 if not a digit
+    const auto hex = []( char ch ) {
+        if( ch >= '0' && ch <= '9' )
+            return ch - '0';
+
+        if( ch >= 'a' && ch <= 'f' )
+            return ch - 'a' + 10;
+
+        if( ch >= 'A' && ch <= 'F' )
+            return ch - 'A' + 10;
+
+        return -1;
+    };
+
+    // close the running span, spans with the base color are left out
+    const auto close_span = [ & ]() {
+        if( text.size() > span_begin && ( span_color.a != color.a || span_color.r != color.r || span_color.g != color.g || span_color.b != color.b ) )
+            spans.push_back( { span_begin, text.size(), span_color } );
+
+        span_begin = text.size();
+    };
+
+    span_begin = 0;
+    span_color = color;
+
+    index = 0;
+    while( index < markup.size() ) {
+        const auto ch = markup[ index ];
+
+        // escaped brace
+        if( ch == '{' && index + 1 < markup.size() && markup[ index + 1 ] == '{' ) {
+            text.push_back( '{' );
+            index += 2;
+            continue;
+        }
+
+        if( ch == '{' ) {
+            const auto close = markup.find( '}', index );
+
+            // {/} back to the base color
+            if( close == index + 2 && markup[ index + 1 ] == '/' ) {
+                close_span();
+                span_color = color;
+
+                index = close + 1;
+                continue;
+            }
+
+            // {#rrggbb} or {#aarrggbb}
+            const auto digits = close == std::string::npos ? 0 : close - index - 2;
+            if( close != std::string::npos && markup[ index + 1 ] == '#' && ( digits == 6 || digits == 8 ) ) {
+                uint32_t value = 0;
+                auto     valid = true;
+
+                for( auto i = index + 2; i < close; ++i ) {
+                    const auto digit = hex( markup[ i ] );
+                    if( digit < 0 ) {
+                        valid = false;
+                        break;
+                    }
+
+                    value = ( value << 4 ) | ( uint32_t ) digit;
+                }
+
+                if( valid ) {
+                    close_span();
+
+                    span_color = Color( 
+                        digits == 8 ? ( uint8_t ) ( value >> 24 ) : color.a, 
+                        ( uint8_t ) ( value >> 16 ), 
+                        ( uint8_t ) ( value >> 8 ), 
+                        ( uint8_t ) value 
+                    );
+
+                    index = close + 1;
+                    continue;
+                }
+            }
+        }
+
+        // plain text, malformed tags included
+        text.push_back( ch );
+        index++;
+    }
+
+    close_span();
+}
+
+NOINLINE void Renderer::draw_text( font_id_t font_id, std::string_view str, const Vec2_t &pos, uint32_t flags, const Color color, float scale ) {
+    draw_text_box( font_id, str, pos, 0.f, flags, color, scale );
+}
+
+NOINLINE void Renderer::draw_text( font_id_t font_id, std::string_view str, float x, float y, uint32_t flags, const Color color, float scale ) {
+    draw_text( font_id, str, { x, y }, flags, color, scale );
+}
+
+NOINLINE std::string_view Renderer::format_text( const char *format, va_list args ) {
+    va_list retry;
+    int     length;
+
+    // keep a copy, the arguments are consumed by the first attempt
+    va_copy( retry, args );
+
+    length = std::vsnprintf( m_format_buffer.data(), m_format_buffer.size(), format, args );
+
+    // didn't fit, grow the buffer once and format again
+    if( length >= 0 && ( size_t ) length >= m_format_buffer.size() ) {
+        m_format_buffer.resize( ( size_t ) length + 1 );
+
+        length = std::vsnprintf( m_format_buffer.data(), m_format_buffer.size(), format, retry );
+    }
+
+    va_end( retry );
+
+    if( length < 0 )
+        return {};
+
+    return std::string_view( m_format_buffer.data(), ( size_t ) length );
+}
+
+NOINLINE void Renderer::draw_textf( font_id_t font_id, const Vec2_t &pos, uint32_t flags, const Color color, const char *format, ... ) {
+    va_list args;
+
+    va_start( args, format );
+    const auto str = format_text( format, args );
+    va_end( args );
+
+    draw_text( font_id, str, pos, flags, color );
+}
+
+NOINLINE void Renderer::draw_textf( font_id_t font_id, float x, float y, uint32_t flags, const Color color, const char *format, ... ) {
+    va_list args;
+
+    va_start( args, format );
+    const auto str = format_text( format, args );
+    va_end( args );
+
+    draw_text( font_id, str, { x, y }, flags, color );
+}
+
+namespace {
+
+    NOINLINE bool is_toplogy_list( D3DPRIMITIVETYPE topology ) {
+        return topology == D3DPT_POINTLIST || topology == D3DPT_LINELIST || topology == D3DPT_TRIANGLELIST;
+    }
+
+    NOINLINE bool clip_line( Vec2_t &start, Vec2_t &end, const Rect_t &rect ) {
+        float t0, t1;
+
+        // liang-barsky, clip the parametric segment against each rect edge
+        const auto delta = end - start;
+
+        const float p[ 4 ] = { -delta.x, delta.x, -delta.y, delta.y };
+        const float q[ 4 ] = { start.x - rect.m_min.x, rect.m_max.x - start.x, start.y - rect.m_min.y, rect.m_max.y - start.y };
+
+        t0 = 0.f;
+        t1 = 1.f;
+
+        for( auto i = 0; i < 4; ++i ) {
+            // parallel to this edge
+            if( p[ i ] == 0.f ) {
+                if( q[ i ] < 0.f )
+                    return false;
+
+                continue;
+            }
+
+            const auto t = q[ i ] / p[ i ];
+
+            // entering
+            if( p[ i ] < 0.f )
+                t0 = std::max( t0, t );
+
+            // leaving
+            else
+                t1 = std::min( t1, t );
+
+            if( t0 > t1 )
+                return false;
+        }
+
+        end   = start + delta * t1;
+        start = start + delta * t0;
+
+        return true;
+    }
+
+    NOINLINE void clip_polygon( std::vector< Vec2_t > &points, const Rect_t &rect, std::vector< Vec2_t > &scratch ) {
+        // sutherland-hodgman, one pass per rect edge.
+        // edge: 0 = left, 1 = right, 2 = top, 3 = bottom
+        const auto inside = []( const Vec2_t &point, const Rect_t &rect, int edge ) {
+            switch( edge ) {
+            case 0:  return point.x >= rect.m_min.x;
+            case 1:  return point.x <= rect.m_max.x;
+            case 2:  return point.y >= rect.m_min.y;
+            default: return point.y <= rect.m_max.y;
+            }
+        };
+
+        const auto intersect = []( const Vec2_t &a, const Vec2_t &b, const Rect_t &rect, int edge ) {
+            const auto delta = b - a;
+
+            switch( edge ) {
+            case 0:  return a + delta * ( ( rect.m_min.x - a.x ) / delta.x );
+            case 1:  return a + delta * ( ( rect.m_max.x - a.x ) / delta.x );
+            case 2:  return a + delta * ( ( rect.m_min.y - a.y ) / delta.y );
+            default: return a + delta * ( ( rect.m_max.y - a.y ) / delta.y );
+            }
+        };
+
+        for( auto edge = 0; edge < 4 && !points.empty(); ++edge ) {
+            scratch.clear();
+
+            for( size_t i = 0; i < points.size(); ++i ) {
+                const auto &current  = points[ i ];
+                const auto &previous = points[ ( i + points.size() - 1 ) % points.size() ];
+
+                const auto current_inside  = inside( current, rect, edge );
+                const auto previous_inside = inside( previous, rect, edge );
+
+                // crossing the edge, keep the intersection
+                if( current_inside != previous_inside )
+                    scratch.push_back( intersect( previous, current, rect, edge ) );
+
+                if( current_inside )
+                    scratch.push_back( current );
+            }
+
+            points.swap( scratch );
+        }
+    }
+
+    NOINLINE int get_topology_order( D3DPRIMITIVETYPE topology ) {
+        switch( topology ) {
+        case D3DPT_POINTLIST:
+            return 1;
+        case D3DPT_LINELIST:
+        case D3DPT_LINESTRIP:
+            return 2;
+        case D3DPT_TRIANGLELIST:
+        case D3DPT_TRIANGLESTRIP:
+        case D3DPT_TRIANGLEFAN:
+            return 3;
+        default:
+            return 0;
+        }
+    }
+
+}
+
+NOINLINE bool Font::open( IDirect3DDevice9 *device, FontManager *manager, const std::string &ttf_font, size_t size, bool anti_alias, uint32_t create_flags ) {
+    FT_Error ft_error;
+
+    // store font data
+    store( device, ttf_font, size, anti_alias );
+
+    m_path         = ttf_font;
+    m_create_flags = create_flags;
+
+    m_sdf        = ( create_flags & CREATE_SDF ) != 0;
+    m_sdf_spread = std::max< size_t >( 2, size / 8 );
+
+    // sdf fonts outline in the shader, the outline has to stay inside the distance field range
+    if( m_sdf )
+        m_outline_width = std::max< size_t >( 1, m_sdf_spread / 2 );
+    else if( create_flags & CREATE_OUTLINE )
+        m_outline_width = std::max< size_t >( 1, size / 16 );
+
+    // notes;
+    // a face describes a given typeface and style, it's shared by every font created from the same file.
+    // each font gets its own FT_Size on the face and has to activate it before loading glyphs
+
+    m_manager = manager;
+
+    // get shared library and face
+    if( !m_manager || !m_manager->init() )
+        return false;
+
+    m_ft_library = m_manager->get_library();
+
+    m_ft_face = m_manager->acquire_face( ttf_font );
+    if( !m_ft_face )
+        return false;
+
+    ft_error = FT_New_Size( m_ft_face, &m_ft_size );
+    if( ft_error )
+        return false;
+
+    ft_error = FT_Activate_Size( m_ft_size );
+    if( ft_error )
+        return false;
+
+    // notes;
+    // The horizontal and vertical device resolutions are expressed in dots-per-inch, or dpi. 
+    // Standard values are 72 or 96 dpi for display devices like the screen. 
+    // The resolution is used to compute the character pixel size from the character point size.
+
+    // set char size 
+    ft_error = FT_Set_Char_Size( m_ft_face, 0, get_raster_size() * 64, 96, 0 );
+    if( ft_error )
+        return false;
+
+    // line metrics at font size, 26.6 fixed point
+    const auto &metrics     = m_ft_face->size->metrics;
+    const auto metric_scale = 1.f / ( 64.f * ( float ) ( get_raster_size() / m_size ) );
+
+    m_ascender    = ( float ) metrics.ascender * metric_scale;
+    m_descender   = ( float ) metrics.descender * metric_scale;
+    m_line_height = ( float ) metrics.height * metric_scale;
+
+    // distance fields are built from anti-aliased coverage and carry no color
+    m_ft_flags = FT_LOAD_RENDER;
+    m_ft_flags |= ( anti_alias || m_sdf ) ? FT_LOAD_TARGET_NORMAL : FT_LOAD_TARGET_MONO;
+    m_ft_flags |= ( FT_HAS_COLOR( m_ft_face ) && !m_sdf ) ? FT_LOAD_COLOR : 0;
+
+    return true;
+}
+
+NOINLINE void Font::get_charmap( charmap_t &charmap ) const {
+    FT_ULong ft_charcode;
+    FT_UInt  ft_index; 
+
+    charmap.clear();
+
+    // parse all character codes available in a given charmap, starting from the first charcode
+    ft_charcode = FT_Get_First_Char( m_ft_face, &ft_index );
+    while( ft_index != 0 ) {
+        charmap.emplace_back( ft_charcode, ft_index );
 
-        const auto x_pos = pos.x + ( radius * std::cos( angle ) );
-        const auto y_pos = pos.y + ( radius * std::sin( angle ) );
+        // go to the next character in charmap
+        ft_charcode = FT_Get_Next_Char( m_ft_face, ft_charcode, &ft_index );
+    }
+}
 
-        vertices[ i ] = {
-            { x_pos, y_pos },
-            color
-        };
+NOINLINE FT_Face Font::open_worker_face() {
+    auto face = m_manager->open_private_face( m_ft_face );
+    if( !face )
+        return nullptr;
+
+    if( FT_Set_Char_Size( face, 0, get_raster_size() * 64, 96, 0 ) ) {
+        m_manager->close_private_face( m_ft_face, face );
+        return nullptr;
     }
 
-    add_vertices( vertices.data(), vertices.size(), D3DPT_LINESTRIP );
+    return face;
 }
 
-NOINLINE void Renderer::draw_circle( float x, float y, float radius, const Color color ) {
-    draw_circle( { x, y }, radius, color );
+NOINLINE void Font::close_worker_face( FT_Face face ) {
+    m_manager->close_private_face( m_ft_face, face );
 }
 
-NOINLINE void Renderer::draw_filled_circle( const Vec2_t &pos, float radius, const Color color ) {
-    static constexpr auto segment_count = 32;
-    std::array< Vertex_t, segment_count + 1 > vertices;
-
-    if( !color.a )
-        return;
+NOINLINE bool Font::add_glyph( RasterGlyph_t &raster ) {
+    auto &glyph = raster.m_glyph;
 
-    for( auto i = 0; i <= segment_count; ++i) {
-        const auto angle = 2.f * Math::pi * ( float ) i / ( float ) segment_count;
+    if( !raster.m_ok )
+        return false;
 
-        const auto x_pos = pos.x + ( radius * std::cos( angle ) );
-        const auto y_pos = pos.y + ( radius * std::sin( angle ) );
+    if( !add_to_atlas( glyph.m_page, glyph.m_uv_min, glyph.m_uv_max, raster.m_pixels.data(), raster.m_width, raster.m_height, raster.m_pitch, raster.m_format ) )
+        return false;
 
-        vertices[ i ] = { { x_pos, y_pos }, color };
+    // outline goes into the same pages as the glyphs
+    if( !raster.m_outline_pixels.empty() ) {
+        auto &outline = glyph.m_outline;
+        if( !add_to_atlas( outline.m_page, outline.m_uv_min, outline.m_uv_max, raster.m_outline_pixels.data(), raster.m_outline_width, raster.m_outline_height, raster.m_outline_width, D3DFMT_A8 ) )
+            return false;
     }
 
-    add_vertices( vertices.data(), vertices.size(), D3DPT_TRIANGLEFAN );
-}
+    // save glyph data
+    m_glyphs.emplace( raster.m_glyph.m_charcode, std::move( raster.m_glyph ) );
 
-NOINLINE void Renderer::draw_filled_circle( float x, float y, float radius, const Color color ) {
-    draw_filled_circle( { x, y }, radius, color );
+    return true;
 }
 
-NOINLINE void Renderer::draw_texture_quad( const Vec2_t &pos, const Vec2_t &size, const Color color, IDirect3DTexture9 *texture, const std::array<Vector2, 6> &uv_coords ) {
-    std::array< Vertex_t, 6 > vertices;
+NOINLINE bool Font::init( IDirect3DDevice9 *device, FontManager *manager, ThreadPool *thread_pool, const std::string &ttf_font, size_t size, bool anti_alias, uint32_t create_flags ) {
+    charmap_t                    charmap;
+    std::vector< RasterGlyph_t > rasters;
+    std::vector< FT_Face >       worker_faces;
 
-    if( !color.a )
-        return;
+    PROFILE_FUNCTION();
 
-    vertices[ 0 ] = { { pos.x,          pos.y + size.y }, color, uv_coords[ 0 ] };
-    vertices[ 1 ] = { { pos.x + size.x, pos.y + size.y }, color, uv_coords[ 1 ] };
-    vertices[ 2 ] = { { pos.x,          pos.y          }, color, uv_coords[ 2 ] };
+    if( !open( device, manager, ttf_font, size, anti_alias, create_flags ) )
+        return false;
 
-    vertices[ 3 ] = { { pos.x + size.x, pos.y + size.y }, color, uv_coords[ 3 ] };
-    vertices[ 4 ] = { { pos.x + size.x, pos.y          }, color, uv_coords[ 4 ] };
-    vertices[ 5 ] = { { pos.x,          pos.y          }, color, uv_coords[ 5 ] };
+    get_charmap( charmap );
 
-    add_vertices( vertices.data(), 6, D3DPT_TRIANGLELIST, texture );
-}
+    rasters.resize( charmap.size() );
 
-NOINLINE void Renderer::draw_texture_quad( float x, float y, float w, float h, const Color color, IDirect3DTexture9 *texture, const std::array<Vector2, 6> &uv_coords ) {
-    draw_texture_quad( { x, y }, { w, h }, color, texture, uv_coords );
-}
+    // faces aren't thread safe, every extra worker gets its own face on the same font data.
+    // they're opened here since creating faces isn't thread safe either
+    const auto max_workers = thread_pool ? thread_pool->get_worker_count() : 0;
+    const auto chunk_count = std::min( max_workers + 1, ( charmap.size() + min_glyphs_per_worker - 1 ) / min_glyphs_per_worker );
 
-NOINLINE void Renderer::draw_text( font_id_t font_id, const std::string &str, const Vec2_t &pos, uint32_t flags, const Color color, float scale ) {
-    std::array< Vertex_t, 6 > vertices;
-    Vec2_t offset;
+    for( size_t i = 1; i < chunk_count; ++i ) {
+        auto face = open_worker_face();
+        if( !face )
+            break;
 
-    const auto &font = get_fonts().at( font_id );
+        worker_faces.push_back( face );
+    }
 
-    // get size of text string
-    const auto text_size = font->get_text_size( str );
+    // rasterize in parallel, chunk 0 runs here on the shared face
+    const auto rasterize_range = [ & ]( size_t chunk, size_t begin, size_t end ) {
+        PROFILE_SCOPE( "Font::init rasterize" );
 
-    // texture UV coords
-    const std::array< Vec2_t, 6 > &uv_coords = {
-        {
-            { 0.f, 1.f },
-            { 1.f, 1.f },
-            { 0.f, 0.f },
-            { 1.f, 1.f },
-            { 1.f, 0.f },
-            { 0.f, 0.f }
-        }
-    };
+        const auto face = chunk ? worker_faces[ chunk - 1 ] : m_ft_face;
 
-    // does font have align flags?
-    const auto has_align_flag = ( flags & (
-        Font::ALIGN_LEFT | Font::ALIGN_RIGHT | Font::ALIGN_CENTER_X | Font::ALIGN_CENTER_Y | Font::ALIGN_CENTER
-        ) );
+        for( auto i = begin; i < end; ++i ) {
+            PROFILE_SCOPE( "Font::init glyph" );
 
-    // align font position
-    if( has_align_flag ) {
-        // left align
-        if( ( flags & Font::ALIGN_LEFT ) )
-            offset.x += text_size.x;
+            rasters[ i ].m_ok = rasterize_glyph( face, charmap[ i ].first, charmap[ i ].second, rasters[ i ] );
+        }
+    };
 
-        // right align
-        else if( ( flags & Font::ALIGN_RIGHT ) )
-            offset.x -= text_size.x;
+    if( thread_pool && !worker_faces.empty() )
+        thread_pool->parallel_for( charmap.size(), worker_faces.size() + 1, min_glyphs_per_worker, rasterize_range );
+    else
+        rasterize_range( 0, 0, charmap.size() );
 
-        // center only x
-        else if( ( flags & Font::ALIGN_CENTER_X ) )
-            offset.x -= ( text_size.x * 0.5f );
+    for( auto face : worker_faces )
+        close_worker_face( face );
 
-        // center only y
-        else if( ( flags & Font::ALIGN_CENTER_Y ) )
-            offset.y -= ( text_size.y * 0.5f );
+    // pack into atlas pages in charmap order, on the device thread
+    {
+        PROFILE_SCOPE( "Font::init pack" );
 
-        // center on x and y
-        else if( ( flags & Font::ALIGN_CENTER ) ) {
-            offset.x -= ( text_size.x * 0.5f );
-            offset.y -= ( text_size.y * 0.5f );
+        for( auto &raster : rasters ) {
+            if( !add_glyph( raster ) )
+                return false;
         }
     }
 
-    // current drawing position
-    auto pen_pos = pos;
+    // create textures for all pages at once
+    if( !upload_atlas() )
+        return false;
 
-    // parse through the text string
-    for( const auto &ch : str ) {
-        // find corresponding glyph
-        const auto &glyph = font->get_glyphs().at( ch );
-        if( !glyph.valid() )
-            continue;
+    m_loaded = true;
+
+    return true;
+}
+
+NOINLINE bool Font::rasterize_glyph( FT_Face face, FT_ULong charcode, FT_UInt index, RasterGlyph_t &raster ) const {
+    FT_Error ft_error;
+    size_t   sdf_width, sdf_height;
+
+    // supersampled coverage for the distance field, reused by every glyph rasterized on this thread
+    thread_local std::vector< uint8_t > sdf_scratch;
 
-        // don't run rendering code on spaces
-        if( ch != ' ' ) {
-            // calculate render pos
-            auto x = pen_pos.x + ( glyph.m_bearing.x * scale );
-            auto y = pen_pos.y + ( text_size.y * scale ) - ( glyph.m_bearing.y * scale );
+    // load character glyph
+    ft_error = FT_Load_Glyph( face, index, m_ft_flags );
+    if( ft_error )
+        return false;
 
-            // apply alignment 
-            x += offset.x * scale;
-            y += offset.y * scale;
+    const auto &slot   = face->glyph;
+    const auto &bitmap = slot->bitmap;
+
+    auto &glyph_data = raster.m_glyph;
+    glyph_data.m_charcode    = charcode;
+    glyph_data.m_glyph_index = index;
+    glyph_data.m_size        = { ( float ) bitmap.width, ( float ) bitmap.rows };
+    glyph_data.m_bearing     = { ( float ) slot->bitmap_left, ( float ) slot->bitmap_top };
+    glyph_data.m_advance     = slot->advance.x;
+    glyph_data.m_colored     = ( bitmap.pixel_mode == FT_PIXEL_MODE_BGRA );
+
+    // bits per pixel of a coverage bitmap, 0 for formats that aren't ( lcd )
+    size_t bits;
+    switch( bitmap.pixel_mode ) {
+        case FT_PIXEL_MODE_MONO:  bits = 1; break;
+        case FT_PIXEL_MODE_GRAY2: bits = 2; break;
+        case FT_PIXEL_MODE_GRAY4: bits = 4; break;
+        case FT_PIXEL_MODE_GRAY:  bits = 8; break;
+        default:                  bits = 0; break;
+    }
 
-            // calculate width, height of texture
-            const auto w = glyph.m_size.x * scale;
-            const auto h = glyph.m_size.y * scale;
+    // sdf, metrics are scaled back to font size and grow by the padding around the field
+    if( m_sdf ) {
+        const uint8_t *coverage = bitmap.buffer;
+        ptrdiff_t      pitch    = bitmap.pitch;
 
-            m_device->SetTextureStageState( 0, D3DTSS_COLOROP, glyph.m_colored ? D3DTOP_SELECTARG2 : D3DTOP_SELECTARG1 );
+        // 8 bit top down coverage is read in place, anything else is expanded into the scratch first
+        if( bits != 8 || pitch < 0 ) {
+            if( !GlyphBitmap::to_coverage( bitmap.buffer, bitmap.pitch, bitmap.width, bitmap.rows, bits, sdf_scratch ) )
+                return false;
 
-            // draw glyph texture quad
-            draw_texture_quad( x, y, w, h, color, glyph.m_texture, uv_coords );
+            coverage = sdf_scratch.data();
+            pitch    = ( ptrdiff_t ) bitmap.width;
         }
 
-        // move pen position 
-        pen_pos.x += ( glyph.m_advance >> 6 ) * scale;
+        ft_error = Sdf::generate( coverage, bitmap.width, bitmap.rows, pitch, sdf_supersample, m_sdf_spread, raster.m_pixels, sdf_width, sdf_height ) ? 0 : 1;
+
+        raster.m_width  = sdf_width;
+        raster.m_height = sdf_height;
+        raster.m_pitch  = ( ptrdiff_t ) sdf_width;
+        raster.m_format = D3DFMT_A8;
+
+        glyph_data.m_size    = { ( float ) sdf_width, ( float ) sdf_height };
+        glyph_data.m_bearing = { 
+            ( float ) slot->bitmap_left / sdf_supersample - m_sdf_spread, 
+            ( float ) slot->bitmap_top / sdf_supersample + m_sdf_spread 
+        };
+        glyph_data.m_advance = slot->advance.x / sdf_supersample;
     }
-}
 
-NOINLINE void Renderer::draw_text( font_id_t font_id, const std::string & str, float x, float y, uint32_t flags, const Color color, float scale ) {
-    draw_text( font_id, str, { x, y }, flags, color, scale );
-}
+    // colored glyphs keep their BGRA pixels ( ARGB words on little endian )
+    else if( glyph_data.m_colored ) {
+        raster.m_width  = bitmap.width;
+        raster.m_height = bitmap.rows;
+        raster.m_pitch  = ( ptrdiff_t ) bitmap.width * 4;
+        raster.m_format = D3DFMT_A8R8G8B8;
 
-namespace {
+        raster.m_pixels.resize( bitmap.width * 4 * bitmap.rows );
+        if( !raster.m_pixels.empty() ) {
+            // bottom up rows start at the last row in memory
+            const auto top = bitmap.pitch < 0 ? bitmap.buffer - bitmap.pitch * ( ptrdiff_t ) ( bitmap.rows - 1 ) : bitmap.buffer;
 
-    NOINLINE bool is_toplogy_list( D3DPRIMITIVETYPE topology ) {
-        return topology == D3DPT_POINTLIST || topology == D3DPT_LINELIST || topology == D3DPT_TRIANGLELIST;
+            GlyphBitmap::copy_rows( top, bitmap.pitch, bitmap.width * 4, bitmap.rows, raster.m_pixels.data(), raster.m_pitch );
+        }
     }
 
-    NOINLINE int get_topology_order( D3DPRIMITIVETYPE topology ) {
-        switch( topology ) {
-        case D3DPT_POINTLIST:
-            return 1;
-        case D3DPT_LINELIST:
-        case D3DPT_LINESTRIP:
-            return 2;
-        case D3DPT_TRIANGLELIST:
-        case D3DPT_TRIANGLESTRIP:
-        case D3DPT_TRIANGLEFAN:
-            return 3;
-        default:
-            return 0;
-        }
+    // expanded straight from the slot to tightly packed A8, mono glyphs ( anti-aliasing off ) become 0 / 255
+    else {
+        raster.m_width  = bitmap.width;
+        raster.m_height = bitmap.rows;
+        raster.m_pitch  = ( ptrdiff_t ) bitmap.width;
+        raster.m_format = D3DFMT_A8;
+
+        if( !GlyphBitmap::to_coverage( bitmap.buffer, bitmap.pitch, bitmap.width, bitmap.rows, bits, raster.m_pixels ) )
+            return false;
     }
 
+    if( ft_error )
+        return false;
+
+    // stroked outline, reloads the glyph so it has to come last
+    if( m_outline_width && !m_sdf && !glyph_data.m_colored && glyph_data.m_size.x && glyph_data.m_size.y )
+        return rasterize_outline( face, index, raster );
+
+    return true;
 }
 
-NOINLINE bool Font::init( IDirect3DDevice9 *device, const std::string &ttf_font, size_t size, bool anti_alias ) {
+NOINLINE bool Font::rasterize_outline( FT_Face face, FT_UInt index, RasterGlyph_t &raster ) const {
     FT_Error   ft_error;
-    FT_ULong   ft_charcode;
-    FT_UInt    ft_index; 
-    FT_Bitmap  ft_bitmap;
+    FT_Stroker ft_stroker;
+    FT_Glyph   ft_glyph;
 
-    auto glyphs = &m_glyphs;
+    // outline needs the vector glyph, not the rendered one
+    ft_error = FT_Load_Glyph( face, index, ( m_ft_flags & ~( FT_LOAD_RENDER | FT_LOAD_COLOR ) ) | FT_LOAD_NO_BITMAP );
+    if( ft_error )
+        return false;
 
-    // store font data
-    store( device, ttf_font, size, anti_alias );
+    // bitmap only font, no outline to stroke
+    if( face->glyph->format != FT_GLYPH_FORMAT_OUTLINE )
+        return true;
 
-    // initialize freetype
-    ft_error = FT_Init_FreeType( &m_ft_library );
+    ft_error = FT_Get_Glyph( face->glyph, &ft_glyph );
     if( ft_error )
         return false;
 
-    // notes;
-    // a face describes a given typeface and style 
-    // FT_Err_Unknown_File_Format - the font file could be opened and read, but it appears that the format isn't supported
-
-    // initialize the new font face
-    ft_error = FT_New_Face( m_ft_library, ttf_font.c_str(), 0, &m_ft_face );
-    if( ft_error == FT_Err_Unknown_File_Format || ft_error )
+    ft_error = FT_Stroker_New( m_ft_library, &ft_stroker );
+    if( ft_error ) {
+        FT_Done_Glyph( ft_glyph );
         return false;
+    }
 
-    // notes;
-    // The horizontal and vertical device resolutions are expressed in dots-per-inch, or dpi. 
-    // Standard values are 72 or 96 dpi for display devices like the screen. 
-    // The resolution is used to compute the character pixel size from the character point size.
+    // radius in 26.6, the outside border is the glyph grown by the outline width, drawn under the glyph
+    FT_Stroker_Set( ft_stroker, ( FT_Fixed ) ( m_outline_width * 64 ), FT_STROKER_LINECAP_ROUND, FT_STROKER_LINEJOIN_ROUND, 0 );
 
-    // set char size 
-    ft_error = FT_Set_Char_Size( m_ft_face, 0, size * 64, 96, 0 );
-    if( ft_error )
+    ft_error = FT_Glyph_StrokeBorder( &ft_glyph, ft_stroker, false, true );
+
+    FT_Stroker_Done( ft_stroker );
+
+    if( !ft_error )
+        ft_error = FT_Glyph_To_Bitmap( &ft_glyph, m_anti_alias ? FT_RENDER_MODE_NORMAL : FT_RENDER_MODE_MONO, nullptr, true );
+
+    if( ft_error ) {
+        FT_Done_Glyph( ft_glyph );
         return false;
+    }
 
-    m_ft_flags = FT_LOAD_RENDER;
-    m_ft_flags |= anti_alias ? FT_LOAD_TARGET_NORMAL : FT_LOAD_TARGET_MONO;
-    m_ft_flags |= FT_HAS_COLOR( m_ft_face ) ? FT_LOAD_COLOR : 0;
+    const auto  bitmap_glyph = ( FT_BitmapGlyph ) ft_glyph;
+    const auto &bitmap       = bitmap_glyph->bitmap;
 
-    // parse all character codes available in a given charmap, starting from the first charcode
-    // generate textures for them
-    ft_charcode = FT_Get_First_Char( m_ft_face, &ft_index );
-    while( ft_index != 0 ) {
-        // load character glyph
-        ft_error = FT_Load_Glyph( m_ft_face, ft_index, m_ft_flags );
-        if( ft_error )
+    auto &outline = raster.m_glyph.m_outline;
+    outline.m_size    = { ( float ) bitmap.width, ( float ) bitmap.rows };
+    outline.m_bearing = { ( float ) bitmap_glyph->left, ( float ) bitmap_glyph->top };
+
+    raster.m_outline_width  = bitmap.width;
+    raster.m_outline_height = bitmap.rows;
+
+    // rendered as mono or 8 bit gray, expanded straight to A8
+    const auto ok = GlyphBitmap::to_coverage( bitmap.buffer, bitmap.pitch, bitmap.width, bitmap.rows, bitmap.pixel_mode == FT_PIXEL_MODE_MONO ? 1 : 8, raster.m_outline_pixels );
+
+    FT_Done_Glyph( ft_glyph );
+
+    return ok;
+}
+
+NOINLINE bool Font::add_to_atlas( size_t &page_index_out, Vec2_t &uv_min, Vec2_t &uv_max, const uint8_t *pixels, size_t width, size_t height, ptrdiff_t pitch, D3DFORMAT format ) {
+    size_t x = 0, y = 0, page_index;
+
+    // nothing to draw ( space, etc. )
+    if( !width || !height )
+        return true;
+
+    // find a page of the same format with room left
+    for( page_index = 0; page_index < m_pages.size(); ++page_index ) {
+        auto &page = m_pages[ page_index ];
+
+        if( page.m_format == format && !page.m_texture && page.m_handle == invalid_texture_handle && page.m_packer.pack( width, height, x, y ) )
+            break;
+    }
+
+    // open a new page, grown for glyphs that wouldn't fit into a default sized one
+    if( page_index == m_pages.size() ) {
+        size_t page_width  = atlas_page_size;
+        size_t page_height = atlas_page_size;
+
+        while( page_width < width + atlas_padding * 2 )
+            page_width *= 2;
+
+        while( page_height < height + atlas_padding * 2 )
+            page_height *= 2;
+
+        m_pages.emplace_back( format, page_width, page_height, atlas_padding );
+
+        if( !m_pages.back().m_packer.pack( width, height, x, y ) )
             return false;
-        
-        // create bitmap for current glpyh
-        FT_Bitmap_New( &ft_bitmap );
-   
-        // http://paulbourke.net/dataformats/bitmaps/
-        //  32 bit RGB - This is normally the same as 24 bit colour but with an extra 8 bit bitmap known as an alpha channel.
-        // This channel can be used to create masked areas or represent transparency.
-        // http://prntscr.com/ns5r4i
-        ft_error = FT_Bitmap_Convert( m_ft_library, &m_ft_face->glyph->bitmap, &ft_bitmap, 4 );
-        if( ft_error )
+    }
+
+    auto &page = m_pages[ page_index ];
+
+    // copy rows into the staging pixels
+    const auto row_size = width * page.m_bytes_per_pixel;
+    for( size_t row = 0; row < height; ++row )
+        std::memcpy( &page.m_pixels[ ( ( y + row ) * page.m_width + x ) * page.m_bytes_per_pixel ], pixels + ( ptrdiff_t ) row * pitch, row_size );
+
+    page_index_out = page_index;
+    uv_min         = { ( float ) x / page.m_width, ( float ) y / page.m_height };
+    uv_max         = { ( float ) ( x + width ) / page.m_width, ( float ) ( y + height ) / page.m_height };
+
+    return true;
+}
+
+NOINLINE bool Font::upload_atlas() {
+    PROFILE_FUNCTION();
+
+    for( auto &page : m_pages ) {
+        // already uploaded
+        if( page.m_texture || page.m_handle != invalid_texture_handle )
+            continue;
+
+        if( !upload_page( page ) )
             return false;
+    }
+
+    // point glyphs at their page textures
+    for( auto &glyph : m_glyphs ) {
+        auto &data = glyph.second;
+
+        if( data.m_size.x && data.m_size.y )
+            data.m_texture = m_pages[ data.m_page ].m_texture;
+
+        if( data.m_outline.m_size.x && data.m_outline.m_size.y )
+            data.m_outline.m_texture = m_pages[ data.m_outline.m_page ].m_texture;
 
-        GlyphData_t glyph_data;
-        glyph_data.m_charcode    = ft_charcode;
-        glyph_data.m_glyph_index = ft_index;
-        glyph_data.m_size        = { ( float ) ft_bitmap.width, ( float ) ft_bitmap.rows };
-        glyph_data.m_bearing     = { ( float ) m_ft_face->glyph->bitmap_left, ( float ) m_ft_face->glyph->bitmap_top };
-        glyph_data.m_advance     = m_ft_face->glyph->advance.x;
+        data.m_ready = true;
+    }
+
+    return true;
+}
+
+NOINLINE bool Font::upload_page( AtlasPage_t &page ) {
+    D3DLOCKED_RECT locked_rect;
+
+    // create page texture
+    if( D3DXCreateTexture( m_device, page.m_width, page.m_height, 1, 0, page.m_format, D3DPOOL_MANAGED, &page.m_texture ) != D3D_OK )
+        return false;
+
+    if( page.m_texture->LockRect( 0, &locked_rect, nullptr, 0 ) != D3D_OK ) {
+        Utils::safe_release( &page.m_texture );
+        return false;
+    }
+
+    // rows of the locked rect may be padded
+    const auto row_size = page.m_width * page.m_bytes_per_pixel;
+    for( size_t row = 0; row < page.m_height; ++row )
+        std::memcpy( ( uint8_t * ) locked_rect.pBits + ( ptrdiff_t ) row * locked_rect.Pitch, &page.m_pixels[ row * row_size ], row_size );
+
+    page.m_texture->UnlockRect( 0 );
+
+    // staging copy no longer needed
+    page.m_pixels.clear();
+    page.m_pixels.shrink_to_fit();
+
+    return true;
+}
 
-        // is rendering in monochrome mode ( anti-aliasing off )
-        if( !anti_alias ) {
-            // convert to 0-255 alpha for A8 format
-            for( auto it = ft_bitmap.buffer; it != &ft_bitmap.buffer[ ft_bitmap.rows * ft_bitmap.pitch ]; it++ ) 
-                *it *= 255;
+NOINLINE IDirect3DTexture9 *Font::restore_page( size_t page_index ) {
+    RasterGlyph_t raster;
+
+    PROFILE_FUNCTION();
+
+    auto &page = m_pages[ page_index ];
+
+    // another font on the shared face may have activated its size
+    if( FT_Activate_Size( m_ft_size ) )
+        return nullptr;
+
+    page.m_pixels.assign( page.m_width * page.m_height * page.m_bytes_per_pixel, 0 );
+
+    // glyphs go back to the spots they were packed into, uvs stay valid
+    const auto copy_to_page = [ & ]( const Vec2_t &uv_min, const uint8_t *pixels, size_t width, size_t height, ptrdiff_t pitch ) {
+        const auto x        = ( size_t ) std::lround( uv_min.x * page.m_width );
+        const auto y        = ( size_t ) std::lround( uv_min.y * page.m_height );
+        const auto row_size = width * page.m_bytes_per_pixel;
+
+        for( size_t row = 0; row < height; ++row )
+            std::memcpy( &page.m_pixels[ ( ( y + row ) * page.m_width + x ) * page.m_bytes_per_pixel ], pixels + ( ptrdiff_t ) row * pitch, row_size );
+    };
+
+    for( const auto &glyph : m_glyphs ) {
+        const auto &data = glyph.second;
+
+        const auto glyph_on_page   = data.m_size.x && data.m_size.y && data.m_page == page_index;
+        const auto outline_on_page = data.m_outline.m_size.x && data.m_outline.m_size.y && data.m_outline.m_page == page_index;
+
+        if( !glyph_on_page && !outline_on_page )
+            continue;
+
+        if( !rasterize_glyph( m_ft_face, data.m_charcode, data.m_glyph_index, raster ) ) {
+            page.m_pixels.clear();
+            return nullptr;
         }
 
-        glyph_data.m_colored = ( m_ft_face->glyph->bitmap.pixel_mode == FT_PIXEL_MODE_BGRA );
+        if( glyph_on_page )
+            copy_to_page( data.m_uv_min, raster.m_pixels.data(), raster.m_width, raster.m_height, raster.m_pitch );
 
-        // create glyph texture
-        if( D3DXCreateTexture( m_device, ft_bitmap.width, ft_bitmap.rows, 1, 0, glyph_data.m_colored ? D3DFMT_A8R8G8B8 : D3DFMT_A8, D3DPOOL_MANAGED, &glyph_data.m_texture ) != D3D_OK )
-            return false;
+        if( outline_on_page )
+            copy_to_page( data.m_outline.m_uv_min, raster.m_outline_pixels.data(), raster.m_outline_width, raster.m_outline_height, ( ptrdiff_t ) raster.m_outline_width );
+    }
+
+    if( !upload_page( page ) ) {
+        page.m_pixels.clear();
+        return nullptr;
+    }
 
-        D3DLOCKED_RECT locked_rect;
-        glyph_data.m_texture->LockRect( 0, &locked_rect, nullptr, D3DLOCK_DISCARD );
+    for( auto &glyph : m_glyphs ) {
+        auto &data = glyph.second;
+
+        if( data.m_size.x && data.m_size.y && data.m_page == page_index )
+            data.m_texture = page.m_texture;
+
+        if( data.m_outline.m_size.x && data.m_outline.m_size.y && data.m_outline.m_page == page_index )
+            data.m_outline.m_texture = page.m_texture;
+    }
+
+    return page.m_texture;
+}
+
+NOINLINE void Font::evict_page( size_t page_index ) {
+    m_pages[ page_index ].m_texture = nullptr;
+
+    for( auto &glyph : m_glyphs ) {
+        auto &data = glyph.second;
+
+        if( data.m_page == page_index )
+            data.m_texture = nullptr;
+
+        if( data.m_outline.m_page == page_index )
+            data.m_outline.m_texture = nullptr;
+    }
+}
+
+NOINLINE void Font::release() {
+    for( auto &page : m_pages ) {
+        // uploaded pages belong to the texture manager
+        if( m_textures && page.m_handle != invalid_texture_handle ) {
+            m_textures->remove( page.m_handle );
+
+            page.m_texture = nullptr;
+        }
 
-        // if glyph is colored use original non-converted bitmap using ARGB/BRGA format
-        if( glyph_data.m_colored )
-            std::memcpy( locked_rect.pBits, m_ft_face->glyph->bitmap.buffer, m_ft_face->glyph->bitmap.rows * m_ft_face->glyph->bitmap.pitch );
         else
-            std::memcpy( locked_rect.pBits, ft_bitmap.buffer, ( size_t ) glyph_data.m_size.y * ft_bitmap.pitch );
+            Utils::safe_release( &page.m_texture );
+    }
 
-        glyph_data.m_texture->UnlockRect( 0 );
-        
-        // save glyph data
-        glyphs->emplace( ft_charcode, std::move( glyph_data ) );
+    m_pages.clear();
 
-        // go to the next character in charmap
-        ft_charcode = FT_Get_Next_Char( m_ft_face, ft_charcode, &ft_index );
+    for( auto &glyph : m_glyphs ) {
+        glyph.second.m_texture           = nullptr;
+        glyph.second.m_outline.m_texture = nullptr;
+        glyph.second.m_ready             = false;
+    }
+}
+
+NOINLINE const GlyphData_t *Font::find_glyph( FT_ULong codepoint ) const {
+    const auto it = m_glyphs.find( codepoint );
+    if( it == m_glyphs.end() || !it->second.valid() )
+        return nullptr;
+
+    return &it->second;
+}
+
+NOINLINE const GlyphData_t *Font::resolve_glyph( FT_ULong codepoint, const Font **owner ) const {
+    const GlyphData_t *glyph;
+    bool               cacheable;
+
+    *owner = this;
+
+    // own glyphs first
+    glyph = find_glyph( codepoint );
+    if( glyph )
+        return glyph;
+
+    // resolved through the fallback chain before
+    const auto it = m_resolved.find( codepoint );
+    if( it != m_resolved.end() ) {
+        *owner = it->second.m_font;
+        return it->second.m_glyph;
+    }
+
+    // fonts that are still loading may get the glyph later, don't remember misses until they're done
+    cacheable = true;
+
+    for( const auto fallback : m_fallbacks ) {
+        if( !fallback->is_loaded() ) {
+            cacheable = false;
+            continue;
+        }
+
+        glyph = fallback->find_glyph( codepoint );
+        if( glyph ) {
+            *owner = fallback;
+            m_resolved[ codepoint ] = { fallback, glyph };
+
+            return glyph;
+        }
     }
 
-    FT_Bitmap_Done( m_ft_library, &ft_bitmap );
+    if( cacheable )
+        m_resolved[ codepoint ] = { nullptr, nullptr };
+
+    *owner = nullptr;
+
+    return nullptr;
+}
+
+NOINLINE bool Font::add_fallback( const Font *fallback ) {
+    if( !fallback || fallback == this || std::find( m_fallbacks.begin(), m_fallbacks.end(), fallback ) != m_fallbacks.end() )
+        return false;
+
+    m_fallbacks.push_back( fallback );
+    m_resolved.clear();
 
     return true;
 }
 
-NOINLINE Vec2_t Font::get_text_size( const std::string &str ) const {
-    Vec2_t size;
-    
-    // parse through the text string
-    for( const auto &ch : str ) {
-        // find corresponding glyph
-        const auto &glyph = get_glyphs().at( ch );
-        if( !glyph.valid() )
+NOINLINE void Font::layout_text( std::string_view str, float max_width, float line_spacing, TextLayout_t &layout ) const {
+    const Font *owner;
+    size_t      index, line_begin, break_begin, break_end;
+    float       width, break_width, break_width_after;
+
+    layout.m_lines.clear();
+
+    // face metrics, not the glyphs of this particular text
+    layout.m_ascender     = m_ascender;
+    layout.m_line_height  = m_line_height;
+    layout.m_line_advance = m_line_height * line_spacing;
+
+    index             = 0;
+    line_begin        = 0;
+    width             = 0.f;
+    break_begin       = std::string::npos;
+    break_end         = 0;
+    break_width       = 0.f;
+    break_width_after = 0.f;
+
+    while( index < str.size() ) {
+        const auto begin     = index;
+        const auto codepoint = Utils::decode_utf8( str.data(), str.size(), index );
+
+        // hard break
+        if( codepoint == '\n' ) {
+            layout.m_lines.push_back( { line_begin, begin, width } );
+
+            line_begin  = index;
+            width       = 0.f;
+            break_begin = std::string::npos;
+
             continue;
+        }
+
+        const auto glyph   = resolve_glyph( codepoint, &owner );
+        const auto advance = glyph ? ( float ) ( glyph->m_advance >> 6 ) : 0.f;
+
+        // wrap at the last space on this line, or inside the word if there was none. spaces never wrap
+        if( max_width > 0.f && codepoint != ' ' && width + advance > max_width && begin > line_begin ) {
+            if( break_begin != std::string::npos ) {
+                layout.m_lines.push_back( { line_begin, break_begin, break_width } );
+
+                // the space itself is dropped, the rest of the word moves down
+                line_begin = break_end;
+                width     -= break_width_after;
+            }
+            else {
+                layout.m_lines.push_back( { line_begin, begin, width } );
+
+                line_begin = begin;
+                width      = 0.f;
+            }
+
+            break_begin = std::string::npos;
+        }
 
-        // length of text is the glyph width
-        size.x += ( glyph.m_advance >> 6 );
+        width += advance;
 
-        // height of text is the tallest letter
-        if( size.y < glyph.m_size.y )
-            size.y = glyph.m_size.y;
+        // remember break opportunity
+        if( codepoint == ' ' ) {
+            break_begin       = begin;
+            break_end         = index;
+            break_width       = width - advance;
+            break_width_after = width;
+        }
     }
 
-    return size;
+    layout.m_lines.push_back( { line_begin, str.size(), width } );
+
+    // block size, the last line only adds its own height
+    layout.m_size = {};
+
+    for( const auto &line : layout.m_lines )
+        layout.m_size.x = std::max( layout.m_size.x, line.m_width );
+
+    layout.m_size.y = ( float ) ( layout.m_lines.size() - 1 ) * layout.m_line_advance + layout.m_line_height;
+}
+
+NOINLINE Vec2_t Font::get_text_size( std::string_view str ) const {
+    TextLayout_t layout;
+
+    layout_text( str, 0.f, 1.f, layout );
+
+    return layout.m_size;
 }
@@ -8,15 +8,8 @@ using Vec2_t = Vector2;
 
 using font_id_t = size_t;
 
-namespace {
-
-    // is primitve type a list?
-    NOINLINE bool is_toplogy_list( D3DPRIMITIVETYPE topology );
-
-    // primitive type grouping order
-    NOINLINE int get_topology_order( D3DPRIMITIVETYPE topology );
-
-}
+// font id that doesn't name a font
+constexpr font_id_t invalid_font_id = ~( font_id_t ) 0;
 
 class Color {
 public:
@@ -31,9 +24,24 @@ public:
 
     }
 
+    // unpack argb, the inverse of get
+    static FORCEINLINE Color from_argb( uint32_t argb ) {
+        return Color( ( uint8_t ) ( argb >> 24 ), ( uint8_t ) ( argb >> 16 ), ( uint8_t ) ( argb >> 8 ), ( uint8_t ) argb );
+    }
+
     FORCEINLINE uint32_t get() {
         return ( uint32_t ) ( ( ( a & 0xff ) << 24 ) | ( ( r & 0xff ) << 16 ) | ( ( g & 0xff ) << 8 ) | ( b & 0xff ) );
     }
+
+    // linear interpolation between colors, t in [0, 1]
+    FORCEINLINE Color lerp( const Color &other, float t ) const {
+        return Color( 
+            ( uint8_t ) ( a + ( other.a - a ) * t ), 
+            ( uint8_t ) ( r + ( other.r - r ) * t ), 
+            ( uint8_t ) ( g + ( other.g - g ) * t ), 
+            ( uint8_t ) ( b + ( other.b - b ) * t ) 
+        );
+    }
 };
 
 class ColorRect {
@@ -56,6 +64,109 @@ public:
     }
 };
 
+//
+// Axis aligned rectangle
+//
+struct Rect_t {
+    Vec2_t m_min; // top left
+    Vec2_t m_max; // bottom right
+
+    // ctor(s)
+    FORCEINLINE Rect_t() : m_min{}, m_max{} {
+
+    }
+
+    FORCEINLINE Rect_t( const Vec2_t &min, const Vec2_t &max ) : m_min{ min }, m_max{ max } {
+
+    }
+
+    // rect from position and size, negative sizes are flipped
+    static FORCEINLINE Rect_t from_size( const Vec2_t &pos, const Vec2_t &size ) {
+        const auto end = pos + size;
+
+        return { { std::min( pos.x, end.x ), std::min( pos.y, end.y ) }, { std::max( pos.x, end.x ), std::max( pos.y, end.y ) } };
+    }
+
+    FORCEINLINE bool intersects( const Rect_t &other ) const {
+        return m_min.x < other.m_max.x && m_max.x > other.m_min.x && m_min.y < other.m_max.y && m_max.y > other.m_min.y;
+    }
+
+    FORCEINLINE bool contains( const Rect_t &other ) const {
+        return other.m_min.x >= m_min.x && other.m_max.x <= m_max.x && other.m_min.y >= m_min.y && other.m_max.y <= m_max.y;
+    }
+
+    FORCEINLINE Rect_t intersection( const Rect_t &other ) const {
+        return { { std::max( m_min.x, other.m_min.x ), std::max( m_min.y, other.m_min.y ) }, { std::min( m_max.x, other.m_max.x ), std::min( m_max.y, other.m_max.y ) } };
+    }
+};
+
+//
+// Unit circle points for a segment count, stored as separate cos / sin arrays for vectorized generation
+//
+struct CircleTable_t {
+    std::vector< float > m_cos; // segment_count + 1 entries, the last one closes the circle
+    std::vector< float > m_sin;
+
+    // ctor(s)
+    FORCEINLINE CircleTable_t() : m_cos{}, m_sin{} {
+
+    }
+};
+
+//
+// Solid rect for Renderer::draw_filled_rects
+//
+struct FilledRect_t {
+    Vec2_t m_pos;
+    Vec2_t m_size;
+    Color  m_color;
+
+    // ctor(s)
+    FORCEINLINE FilledRect_t() : m_pos{}, m_size{}, m_color{} {
+
+    }
+
+    FORCEINLINE FilledRect_t( const Vec2_t &pos, const Vec2_t &size, const Color color ) : m_pos{ pos }, m_size{ size }, m_color{ color } {
+
+    }
+};
+
+//
+// Line segment for Renderer::draw_lines
+//
+struct LineSegment_t {
+    Vec2_t m_start;
+    Vec2_t m_end;
+    Color  m_color;
+
+    // ctor(s)
+    FORCEINLINE LineSegment_t() : m_start{}, m_end{}, m_color{} {
+
+    }
+
+    FORCEINLINE LineSegment_t( const Vec2_t &start, const Vec2_t &end, const Color color ) : m_start{ start }, m_end{ end }, m_color{ color } {
+
+    }
+};
+
+//
+// Circle for Renderer::draw_circles / draw_filled_circles
+//
+struct Circle_t {
+    Vec2_t m_pos;
+    float  m_radius;
+    Color  m_color;
+
+    // ctor(s)
+    FORCEINLINE Circle_t() : m_pos{}, m_radius{}, m_color{} {
+
+    }
+
+    FORCEINLINE Circle_t( const Vec2_t &pos, float radius, const Color color ) : m_pos{ pos }, m_radius{ radius }, m_color{ color } {
+
+    }
+};
+
 struct Vertex_t {
     Vec4_t   m_pos;           // x, y, z, rhw
     uint32_t m_color;         // diffuse
@@ -87,34 +198,243 @@ struct Vertex_t {
     }
 };
 
+// vertex is uploaded as is, must match CUSTOM_VERTEX_TYPE
+static_assert( sizeof( Vertex_t ) == 28, "Vertex_t layout doesn't match the fvf" );
+
+// overlay vertex runs are copied as is
+static_assert( sizeof( Overlay::Vertex_t ) == sizeof( Vertex_t ), "Overlay::Vertex_t layout doesn't match Vertex_t" );
+
+//
+// Quad of the instanced path, expanded to its 4 corners by the instancing vertex shader
+//
+struct Instance_t {
+    Vec2_t   m_pos;    // top left in pixels
+    Vec2_t   m_size;   // size in pixels
+    uint32_t m_color;  // packed like Vertex_t
+    Vec2_t   m_uv_min; // top left uv, unused without a texture
+    Vec2_t   m_uv_max; // bottom right uv
+
+    // ctor(s)
+    FORCEINLINE Instance_t() : m_pos{}, m_size{}, m_color{}, m_uv_min{}, m_uv_max{} {
+
+    }
+
+    FORCEINLINE Instance_t( const Vec2_t &pos, const Vec2_t &size, Color color, const Vec2_t &uv_min = {}, const Vec2_t &uv_max = {} ) : 
+        m_pos{ pos }, m_size{ size }, m_color{ color.get() }, m_uv_min{ uv_min }, m_uv_max{ uv_max } {
+
+    }
+};
+
+// instance is uploaded as is, must match the instance vertex declaration
+static_assert( sizeof( Instance_t ) == 36, "Instance_t layout doesn't match the vertex declaration" );
+
+//
+// batch kernels over vertex runs, simd on the position with a scalar fallback
+//
+namespace VertexKernels {
+
+    // move positions by delta
+    FORCEINLINE void translate( Vertex_t *vertices, size_t count, const Vec2_t &delta ) {
+#ifdef VECTOR_SIMD
+        const auto delta4 = Simd::set( delta.x, delta.y, 0.f, 0.f );
+
+        for( size_t i = 0; i < count; ++i )
+            vertices[ i ].m_pos.store( Simd::add( vertices[ i ].m_pos.load(), delta4 ) );
+#else
+        for( size_t i = 0; i < count; ++i ) {
+            vertices[ i ].m_pos.x += delta.x;
+            vertices[ i ].m_pos.y += delta.y;
+        }
+#endif
+    }
+
+    // scale positions about origin
+    FORCEINLINE void scale( Vertex_t *vertices, size_t count, const Vec2_t &origin, float factor ) {
+        const auto offset = origin - origin * factor;
+
+#ifdef VECTOR_SIMD
+        // z / rhw pass through untouched
+        const auto factor4 = Simd::set( factor, factor, 1.f, 1.f );
+        const auto offset4 = Simd::set( offset.x, offset.y, 0.f, 0.f );
+
+        for( size_t i = 0; i < count; ++i )
+            vertices[ i ].m_pos.store( Simd::add( Simd::mul( vertices[ i ].m_pos.load(), factor4 ), offset4 ) );
+#else
+        for( size_t i = 0; i < count; ++i ) {
+            vertices[ i ].m_pos.x = vertices[ i ].m_pos.x * factor + offset.x;
+            vertices[ i ].m_pos.y = vertices[ i ].m_pos.y * factor + offset.y;
+        }
+#endif
+    }
+
+    // set diffuse color of every vertex
+    FORCEINLINE void fill_color( Vertex_t *vertices, size_t count, Color color ) {
+        const auto packed = color.get();
+
+        for( size_t i = 0; i < count; ++i )
+            vertices[ i ].m_color = packed;
+    }
+
+    // points on a circle from unit circle cos / sin entries, 4 per step
+    FORCEINLINE void from_unit_circle( Vec2_t *points, const float *cos, const float *sin, size_t count, const Vec2_t &pos, float radius ) {
+        size_t i = 0;
+
+#ifdef VECTOR_SIMD
+        const auto radius4 = Simd::set1( radius );
+        const auto x4      = Simd::set1( pos.x );
+        const auto y4      = Simd::set1( pos.y );
+
+        for( ; i + 4 <= count; i += 4 ) {
+            const auto xs = Simd::add( Simd::mul( Simd::load( &cos[ i ] ), radius4 ), x4 );
+            const auto ys = Simd::add( Simd::mul( Simd::load( &sin[ i ] ), radius4 ), y4 );
+
+            Simd::store( &points[ i ].x, Simd::interleave_low( xs, ys ) );
+            Simd::store( &points[ i + 2 ].x, Simd::interleave_high( xs, ys ) );
+        }
+#endif
+
+        for( ; i < count; ++i ) {
+            points[ i ].x = cos[ i ] * radius + pos.x;
+            points[ i ].y = sin[ i ] * radius + pos.y;
+        }
+    }
+
+    // build untextured vertices from points
+    FORCEINLINE void from_points( Vertex_t *vertices, const Vec2_t *points, size_t count, Color color ) {
+        size_t i = 0;
+
+        const auto packed = color.get();
+
+#ifdef VECTOR_SIMD
+        // widen 2 points per load
+        const auto zw = Simd::set( 1.f, 1.f, 1.f, 1.f );
+
+        for( ; i + 2 <= count; i += 2 ) {
+            const auto pair = Simd::load( &points[ i ].x );
+
+            vertices[ i ].m_pos.store( Simd::low_pairs( pair, zw ) );
+            vertices[ i + 1 ].m_pos.store( Simd::high_low_pairs( pair, zw ) );
+
+            vertices[ i ].m_color         = vertices[ i + 1 ].m_color         = packed;
+            vertices[ i ].m_texture_coord = vertices[ i + 1 ].m_texture_coord = {};
+        }
+#endif
+
+        for( ; i < count; ++i ) {
+            vertices[ i ].m_pos.init( points[ i ].x, points[ i ].y, 1.f, 1.f );
+            vertices[ i ].m_color         = packed;
+            vertices[ i ].m_texture_coord = {};
+        }
+    }
+
+}
+
 struct Batch_t {
-    size_t            m_count;
-    D3DPRIMITIVETYPE  m_topology;
-    IDirect3DTexture9 *m_texture;
+    size_t                m_count;
+    D3DPRIMITIVETYPE      m_topology;
+    IDirect3DTexture9     *m_texture;
+    IDirect3DPixelShader9 *m_pixel_shader; // optional pixel shader
+    Vec2_t                m_shader_params; // passed to the pixel shader in c0.xy
+    bool                  m_instanced;     // m_count is a number of RenderList::m_instances
 
     // ctor(s)
-    FORCEINLINE Batch_t( D3DPRIMITIVETYPE topology, IDirect3DTexture9 *texture, size_t count = 0 ) : m_count{ count }, m_topology{ topology }, m_texture{ texture } {
+    FORCEINLINE Batch_t( D3DPRIMITIVETYPE topology, IDirect3DTexture9 *texture, size_t count = 0, IDirect3DPixelShader9 *pixel_shader = nullptr, const Vec2_t &shader_params = {}, 
+        bool instanced = false ) : m_count{ count }, m_topology{ topology }, m_texture{ texture }, m_pixel_shader{ pixel_shader }, m_shader_params{ shader_params }, m_instanced{ instanced } {
 
     }
 };
 
 class RenderList {
 public:
-    std::vector< Vertex_t > m_vertices;
-    std::vector< Batch_t >  m_batches;
+    std::vector< Vertex_t >   m_vertices;
+    std::vector< Instance_t > m_instances;
+    std::vector< Batch_t >    m_batches;
 
     // ctor(s)
-    FORCEINLINE RenderList() : m_vertices{}, m_batches{} {
+    FORCEINLINE RenderList() : m_vertices{}, m_instances{}, m_batches{} {
         
     }
 
     // clear draw lists
     FORCEINLINE void clear() {
         m_vertices.clear();
+        m_instances.clear();
         m_batches.clear();
     }
 };
 
+using layer_id_t = size_t;
+
+constexpr layer_id_t invalid_layer_id = ~( layer_id_t ) 0;
+
+//
+// Retained layer, draw calls are recorded once and reused until the layer is invalidated
+//
+struct Layer_t {
+    enum LayerMode : uint8_t {
+        TEXTURE = 0, // rendered once into a texture and composited as a single quad
+        VERTICES     // recorded vertices are appended every frame, no extra fill but no fewer vertices either
+    };
+
+    std::string       m_name;    // unique name
+    LayerMode         m_mode;
+    Vec2_t            m_pos;     // top left on screen, contents are drawn relative to it
+    Vec2_t            m_size;    // contents outside are clipped
+    RenderList        m_list;    // recorded draw calls
+    IDirect3DTexture9 *m_texture; // render target of TEXTURE layers
+    bool              m_dirty;   // contents have to be recorded again
+    bool              m_pending; // recorded but not rendered into the texture yet
+
+    // ctor(s)
+    FORCEINLINE Layer_t() : m_name{}, m_mode{ TEXTURE }, m_pos{}, m_size{}, m_list{}, m_texture{ nullptr }, m_dirty{ true }, m_pending{} {
+
+    }
+};
+
+using layer_ptr_t = std::unique_ptr< Layer_t >;
+
+//
+// Renderer counters, accumulated until reset
+//
+struct RenderStats_t {
+    uint64_t m_frames;      // frames rendered
+    uint64_t m_submissions; // add_vertices calls
+    uint64_t m_vertices;    // vertices submitted
+    uint64_t m_instances;   // quads submitted as instances
+    uint64_t m_batches;     // batches flushed
+    uint64_t m_draw_calls;  // DrawPrimitive calls issued
+    uint64_t m_flush_ns;    // time spent in flush
+    uint64_t m_upload_skips; // frames that matched the previous frame and skipped the buffer upload
+    uint64_t m_resets;       // device resets recovered from
+    uint64_t m_reset_ns;     // time spent recreating resources in on_reset
+
+    // ctor(s)
+    FORCEINLINE RenderStats_t() : m_frames{}, m_submissions{}, m_vertices{}, m_instances{}, m_batches{}, m_draw_calls{}, m_flush_ns{}, m_upload_skips{}, m_resets{}, m_reset_ns{} {
+
+    }
+
+    FORCEINLINE void reset() {
+        *this = {};
+    }
+};
+
+//
+// Extra glyph image packed next to the glyph, ex. the stroked outline
+//
+struct GlyphImage_t {
+    Vec2_t             m_size;    // pixel size
+    Vec2_t             m_bearing; // offset from the pen position, like GlyphData_t
+    size_t             m_page;    // atlas page index
+    Vec2_t             m_uv_min;  // top left uv in atlas page
+    Vec2_t             m_uv_max;  // bottom right uv in atlas page
+    IDirect3DTexture9 *m_texture; // d3d9 atlas page texture, null if there's no image
+
+    // ctor(s)
+    FORCEINLINE GlyphImage_t() : m_size{}, m_bearing{}, m_page{}, m_uv_min{}, m_uv_max{}, m_texture{} {
+
+    }
+};
+
 //
 // Stores information about glyph in a bitmap font
 //
@@ -128,16 +448,148 @@ struct GlyphData_t {
     size_t m_advance; 
 
     bool m_colored;               // glyph colored?
+    bool m_ready;                 // glyph loaded and uploaded?
+
+    IDirect3DTexture9 *m_texture; // d3d9 atlas page texture, null for empty glyphs
+    size_t             m_page;    // atlas page index
+    Vec2_t             m_uv_min;  // top left uv in atlas page
+    Vec2_t             m_uv_max;  // bottom right uv in atlas page
 
-    IDirect3DTexture9 *m_texture; // d3d9 glyph texture
+    GlyphImage_t       m_outline; // stroked outline, only with Font::CREATE_OUTLINE
 
     // ctor(s))
-    FORCEINLINE GlyphData_t() : m_charcode{}, m_glyph_index{}, m_size{}, m_bearing{}, m_advance{}, m_colored{}, m_texture{} {
+    FORCEINLINE GlyphData_t() : m_charcode{}, m_glyph_index{}, m_size{}, m_bearing{}, m_advance{}, m_colored{}, m_ready{}, m_texture{}, m_page{}, m_uv_min{}, m_uv_max{}, m_outline{} {
 
     }
 
     FORCEINLINE bool valid() const {
-        return ( m_texture != nullptr );
+        return m_ready;
+    }
+};
+
+//
+// Glyph quad collected by draw_text before it's emitted
+//
+struct TextQuad_t {
+    Vec2_t                m_pos;          // top left screen position
+    Vec2_t                m_size;         // scaled size
+    Vec2_t                m_uv_min;       // top left uv in atlas page
+    Vec2_t                m_uv_max;       // bottom right uv in atlas page
+    IDirect3DTexture9     *m_texture;     // atlas page
+    IDirect3DPixelShader9 *m_pixel_shader; // sdf shader or null
+    Vec2_t                m_shader_params; // sdf edge softness, edge
+    Color                 m_color;        // vertex color
+    bool                  m_colored;      // color glyph?
+    uint32_t              m_layer;        // 0 shadow, 1 outline, 2 glyph, lower layers draw first
+
+    // ctor(s)
+    FORCEINLINE TextQuad_t() : m_pos{}, m_size{}, m_uv_min{}, m_uv_max{}, m_texture{}, m_pixel_shader{}, m_shader_params{}, m_color{}, m_colored{}, m_layer{} {
+
+    }
+};
+
+//
+// Colored range of a text string
+//
+struct TextSpan_t {
+    size_t m_begin; // first byte
+    size_t m_end;   // one past the last byte
+    Color  m_color; // glyph color
+};
+
+//
+// Line of laid out text
+//
+struct TextLine_t {
+    size_t m_begin; // first byte of the line in the text
+    size_t m_end;   // one past the last byte, the wrapping space or newline isn't part of the line
+    float  m_width; // advance width in font pixels
+};
+
+//
+// Text broken into lines, in font pixels ( multiply by draw scale )
+//
+struct TextLayout_t {
+    std::vector< TextLine_t > m_lines;        // lines top to bottom
+    Vec2_t                    m_size;         // block size, widest line by total height
+    float                     m_ascender;     // baseline offset from the line top
+    float                     m_line_height;  // face line height
+    float                     m_line_advance; // distance between baselines, line height times line spacing
+
+    // ctor(s)
+    FORCEINLINE TextLayout_t() : m_lines{}, m_size{}, m_ascender{}, m_line_height{}, m_line_advance{} {
+
+    }
+};
+
+//
+// Text layout cache key, one layout per ( font, text, width )
+//
+struct TextLayoutKey_t {
+    font_id_t   m_font_id;
+    float       m_max_width;
+    std::string m_text;
+
+    FORCEINLINE bool operator==( const TextLayoutKey_t &other ) const {
+        return m_font_id == other.m_font_id && m_max_width == other.m_max_width && m_text == other.m_text;
+    }
+};
+
+struct TextLayoutKeyHash_t {
+    FORCEINLINE size_t operator()( const TextLayoutKey_t &key ) const {
+        auto hash = std::hash< std::string >{}( key.m_text );
+
+        hash ^= std::hash< font_id_t >{}( key.m_font_id ) + 0x9e3779b9 + ( hash << 6 ) + ( hash >> 2 );
+        hash ^= std::hash< float >{}( key.m_max_width ) + 0x9e3779b9 + ( hash << 6 ) + ( hash >> 2 );
+
+        return hash;
+    }
+};
+
+struct TextLayoutEntry_t {
+    TextLayout_t m_layout;     // cached line breaks
+    uint64_t     m_last_frame; // last frame the layout was used, see Renderer::m_layout_frame
+};
+
+//
+// Glyph rasterized off the device thread, waiting to be packed
+//
+struct RasterGlyph_t {
+    GlyphData_t            m_glyph;  // glyph metrics
+    std::vector< uint8_t > m_pixels; // tightly packed pixels
+    size_t                 m_width;  // pixel width
+    size_t                 m_height; // pixel height
+    ptrdiff_t              m_pitch;  // bytes per row
+    D3DFORMAT              m_format; // pixel format
+    bool                   m_ok;     // rasterized without error?
+
+    std::vector< uint8_t > m_outline_pixels; // tightly packed A8 outline pixels
+    size_t                 m_outline_width;  // outline pixel width
+    size_t                 m_outline_height; // outline pixel height
+
+    // ctor(s)
+    FORCEINLINE RasterGlyph_t() : m_glyph{}, m_pixels{}, m_width{}, m_height{}, m_pitch{}, m_format{ D3DFMT_A8 }, m_ok{}, 
+        m_outline_pixels{}, m_outline_width{}, m_outline_height{} {
+
+    }
+};
+
+//
+// Glyph atlas page, glyphs are packed into the staging pixels and uploaded in one go
+//
+struct AtlasPage_t {
+    IDirect3DTexture9      *m_texture;        // d3d9 page texture
+    D3DFORMAT              m_format;          // A8 or A8R8G8B8 for colored glyphs
+    size_t                 m_width, m_height; // page dimensions
+    size_t                 m_bytes_per_pixel; // staging pixel size
+    RectPacker             m_packer;          // free space
+    std::vector< uint8_t > m_pixels;          // staging pixels, released after upload
+    texture_handle_t       m_handle;          // texture manager handle once uploaded, m_texture is null while evicted
+
+    // ctor(s)
+    FORCEINLINE AtlasPage_t( D3DFORMAT format, size_t width, size_t height, size_t padding ) : m_texture{}, m_format{ format }, m_width{ width }, m_height{ height }, 
+        m_bytes_per_pixel{ format == D3DFMT_A8R8G8B8 ? 4u : 1u }, m_packer{ width, height, padding }, m_pixels( width * height * m_bytes_per_pixel, 0 ), m_handle{ invalid_texture_handle } {
+
     }
 };
 
@@ -147,18 +599,57 @@ struct GlyphData_t {
 class Font {
 public:
     IDirect3DDevice9 *m_device;
+    FontManager      *m_manager; // owner of the shared library and face
+    TextureManager   *m_textures; // owner of uploaded page textures, see Renderer::manage_font_pages
 
-    FT_Library  m_ft_library; // freetype library
-    FT_Face     m_ft_face;    // freetype font face
+    FT_Library  m_ft_library; // shared freetype library
+    FT_Face     m_ft_face;    // shared freetype font face
+    FT_Size     m_ft_size;    // our size on the shared face
 
     std::string m_name;       // ttf font name
+    std::string m_path;       // ttf file, raster copies at another size are created from it
+    uint32_t    m_create_flags; // see FontCreateFlags
     size_t      m_size;       // font render size
     bool        m_anti_alias; // font render anti-aliasing
     uint32_t    m_ft_flags;   // font load flags
+    bool        m_sdf;        // glyphs are signed distance fields
+    bool        m_loaded;     // all glyphs uploaded, ready to draw
+    size_t      m_sdf_spread; // distance field range in pixels at font size
+    size_t      m_outline_width; // outline thickness in pixels at font size, 0 without outlines
+    float       m_ascender;   // baseline offset from the line top, at font size
+    float       m_descender;  // lowest point below the baseline ( negative ), at font size
+    float       m_line_height; // distance between baselines, at font size
 
     using glyphmap_t = std::unordered_map< FT_ULong, GlyphData_t >;
+    using charmap_t  = std::vector< std::pair< FT_ULong, FT_UInt > >;
+
+    // glyph found along the fallback chain
+    struct ResolvedGlyph_t {
+        const Font        *m_font;  // font owning the glyph, null if no font has it
+        const GlyphData_t *m_glyph; // glyph in the owning font's glyph map
+    };
+
+    using fallbacks_t   = std::vector< const Font * >;
+    using resolvemap_t  = std::unordered_map< FT_ULong, ResolvedGlyph_t >;
+    using pages_t    = std::vector< AtlasPage_t >;
 
     glyphmap_t m_glyphs; // glyph info
+    pages_t    m_pages;  // glyph atlas pages
+
+    fallbacks_t          m_fallbacks; // fonts searched in order for glyphs we don't have
+    mutable resolvemap_t m_resolved;  // codepoints resolved through the fallback chain
+
+    static constexpr size_t atlas_page_size = 1024; // default atlas page dimensions
+    static constexpr size_t atlas_padding   = 1;    // empty pixels around glyphs, keeps bilinear filtering from bleeding
+    static constexpr size_t sdf_supersample = 4;    // sdf glyphs are rasterized at this multiple of the font size
+
+    static constexpr size_t min_glyphs_per_worker = 64; // smaller charsets aren't worth another face
+
+    enum FontCreateFlags : uint32_t {
+        CREATE_NONE = 0,
+        CREATE_SDF  = ( 1 << 0 ), // signed distance field glyphs, one rasterization renders crisp at any scale
+        CREATE_OUTLINE = ( 1 << 1 ) // stroke glyph outlines for the OUTLINE render flag ( sdf fonts outline in the shader and don't need it )
+    };
 
     enum FontRenderFlags : uint32_t {
         NONE = 0,
@@ -166,11 +657,13 @@ public:
         ALIGN_CENTER_Y = ( 1 << 1 ),
         ALIGN_CENTER = ( 1 << 2 ),
         ALIGN_LEFT = ( 1 << 3 ),
-        ALIGN_RIGHT = ( 1 << 4 )
+        ALIGN_RIGHT = ( 1 << 4 ),
+        OUTLINE = ( 1 << 5 ),     // outline glyphs, needs CREATE_OUTLINE or an sdf font
+        DROP_SHADOW = ( 1 << 6 )  // shadow behind glyphs, see Renderer::set_text_shadow
     };
 
     // ctor(s)
-    FORCEINLINE Font() : m_device{}, m_ft_library {}, m_ft_face{}, m_size{}, m_anti_alias{}, m_ft_flags{}, m_glyphs{} {
+    FORCEINLINE Font() : m_device{}, m_manager{}, m_textures{}, m_ft_library{}, m_ft_face{}, m_ft_size{}, m_create_flags{}, m_size{}, m_anti_alias{}, m_ft_flags{}, m_sdf{}, m_loaded{}, m_sdf_spread{}, m_outline_width{}, m_ascender{}, m_descender{}, m_line_height{}, m_glyphs{}, m_pages{}, m_fallbacks{}, m_resolved{} {
 
     }
 
@@ -178,8 +671,12 @@ public:
     FORCEINLINE ~Font() {
         m_device = nullptr;
 
-        FT_Done_FreeType( m_ft_library );
-        FT_Done_Face( m_ft_face );      
+        // the face and library are shared, only our size is ours to free
+        if( m_ft_size )
+            FT_Done_Size( m_ft_size );
+
+        if( m_manager )
+            m_manager->release_face( m_ft_face );
     }
 
     FORCEINLINE void store( IDirect3DDevice9 *device, const std::string &name, size_t size, bool anti_alias ) {
@@ -189,19 +686,130 @@ public:
         m_anti_alias = anti_alias;
     }
 
-    // initialize font
-    NOINLINE bool init( IDirect3DDevice9 *device, const std::string &ttf_font, size_t size, bool anti_alias );
+    // open face and set up load flags, the first step of init
+    NOINLINE bool open( IDirect3DDevice9 *device, FontManager *manager, const std::string &ttf_font, size_t size, bool anti_alias, uint32_t create_flags );
+
+    // character codes and glyph indices of the face
+    NOINLINE void get_charmap( charmap_t &charmap ) const;
+
+    // private face at our raster size for use on another thread, must be opened and closed on the device thread
+    NOINLINE FT_Face open_worker_face();
+
+    // close face from open_worker_face
+    NOINLINE void close_worker_face( FT_Face face );
+
+    // pack rasterized glyph and add it to the glyph map
+    NOINLINE bool add_glyph( RasterGlyph_t &raster );
+
+    // initialize font, blocks until all glyphs are uploaded
+    NOINLINE bool init( IDirect3DDevice9 *device, FontManager *manager, ThreadPool *thread_pool, const std::string &ttf_font, size_t size, bool anti_alias, uint32_t create_flags = CREATE_NONE );
+
+    // rasterize glyph on the given face, safe to call from any thread that owns the face
+    NOINLINE bool rasterize_glyph( FT_Face face, FT_ULong charcode, FT_UInt index, RasterGlyph_t &raster ) const;
+
+    // pixel size glyphs are rasterized at
+    FORCEINLINE size_t get_raster_size() const {
+        return m_sdf ? m_size * sdf_supersample : m_size;
+    }
+
+    // pack glyph pixels into an atlas page of matching format
+    NOINLINE bool add_to_atlas( size_t &page_index, Vec2_t &uv_min, Vec2_t &uv_max, const uint8_t *pixels, size_t width, size_t height, ptrdiff_t pitch, D3DFORMAT format );
+
+    // rasterize stroked outline of the glyph into the raster
+    NOINLINE bool rasterize_outline( FT_Face face, FT_UInt index, RasterGlyph_t &raster ) const;
+
+    // create page textures and upload the staged pixels
+    NOINLINE bool upload_atlas();
+
+    // create page texture from the staged pixels
+    NOINLINE bool upload_page( AtlasPage_t &page );
+
+    // rasterize the glyphs of an evicted page into their old spots and upload it again
+    NOINLINE IDirect3DTexture9 *restore_page( size_t page_index );
+
+    // page texture is about to be released by the texture manager, forget pointers to it
+    NOINLINE void evict_page( size_t page_index );
+
+    // release page textures
+    NOINLINE void release();
+
+    // glyph for codepoint in this font, null if missing or not loaded
+    NOINLINE const GlyphData_t *find_glyph( FT_ULong codepoint ) const;
+
+    // glyph for codepoint in this font or the first fallback that has it, owner receives the font it came from.
+    // fallback results are cached per codepoint
+    NOINLINE const GlyphData_t *resolve_glyph( FT_ULong codepoint, const Font **owner ) const;
+
+    // append font to the fallback chain
+    NOINLINE bool add_fallback( const Font *fallback );
+
+    // forget cached fallback results
+    FORCEINLINE void clear_resolve_cache() {
+        m_resolved.clear();
+    }
+
+    // break text into lines at newlines and, if max_width is positive, at spaces to fit the width ( in font pixels )
+    NOINLINE void layout_text( std::string_view str, float max_width, float line_spacing, TextLayout_t &layout ) const;
 
-    // get size of glyphs for given text string
-    NOINLINE Vec2_t get_text_size( const std::string &str ) const;
+    // get size of the text block, no wrapping
+    NOINLINE Vec2_t get_text_size( std::string_view str ) const;
 
     // get const reference to glyph map
     FORCEINLINE const glyphmap_t &get_glyphs() const {
         return m_glyphs;
     }
+
+    // all glyphs uploaded?
+    FORCEINLINE bool is_loaded() const {
+        return m_loaded;
+    }
 };
 
-using font_ptr_t = std::unique_ptr< Font >;
+using font_ptr_t      = std::unique_ptr< Font >;
+using font_callback_t = std::function< void( font_id_t font_id, bool success ) >;
+
+//
+// Font being rasterized in the background
+//
+// the worker is the only producer and the render thread the only consumer of the glyph queue. a job never
+// waits on a full queue while holding a pool worker, it keeps the glyph it couldn't push and queues itself
+// again to resume there, so font creation on the render thread always gets workers for its own tasks.
+// the job is owned by the renderer and outlives the worker task, see Renderer::cancel_font_loads
+//
+struct FontLoad_t {
+    static constexpr size_t queue_capacity = 256;
+
+    font_id_t                   m_font_id;  // id handed out by create_font_async
+    Font                        *m_font;    // font being loaded
+    FT_Face                     m_face;     // private face used by the worker
+    Font::charmap_t             m_charmap;  // glyphs to rasterize
+    SpscQueue< RasterGlyph_t >  m_glyphs;   // rasterized glyphs waiting to be packed
+    std::atomic< bool >         m_done;     // worker finished
+    std::atomic< bool >         m_cancel;   // worker should stop
+    size_t                      m_packed;   // glyphs taken from the queue
+    bool                        m_failed;   // a glyph failed to rasterize or pack
+    font_callback_t             m_callback; // called on the render thread once loaded
+    size_t                      m_next;     // worker side, charmap entry to rasterize when the job resumes
+    RasterGlyph_t               m_held;     // worker side, rasterized glyph that didn't fit the queue
+    bool                        m_holding;  // m_held is waiting to be pushed
+
+    // ctor(s)
+    FORCEINLINE FontLoad_t() : m_font_id{ invalid_font_id }, m_font{}, m_face{}, m_charmap{}, m_glyphs{ queue_capacity }, m_done{}, m_cancel{}, m_packed{}, m_failed{}, m_callback{}, 
+        m_next{}, m_held{}, m_holding{} {
+
+    }
+};
+
+using font_load_ptr_t = std::unique_ptr< FontLoad_t >;
+
+//
+// Raster copy of a bitmap font at the ui scale
+//
+struct FontScale_t {
+    font_id_t m_current; // copy drawn now, invalid_font_id draws the font itself
+    font_id_t m_target;  // copy at the current ui scale, replaces m_current once it's loaded
+    bool      m_copy;    // the font is itself a copy
+};
 
 //
 // Direct3D 9 renderer implementation
@@ -211,13 +819,215 @@ private:
     IDirect3DDevice9          *m_device;             // current d3d device
     IDirect3DVertexBuffer9    *m_vertex_buffer;      // buffer for storing verticies
     IDirect3DStateBlock9      *m_render_state_block; // current render state
+    IDirect3DPixelShader9     *m_sdf_shader;         // distance field text shader
+    IDirect3DPixelShader9     *m_layer_shader;       // composites layer textures
+    IDirect3DPixelShader9     *m_sprite_shader;      // texture color times vertex color
+    IDirect3DVertexBuffer9    *m_instance_buffer;    // per instance stream
+    IDirect3DVertexBuffer9    *m_quad_buffer;        // unit quad corners, per vertex stream of instanced draws
+    IDirect3DIndexBuffer9     *m_quad_indices;       // unit quad triangles
+    IDirect3DVertexDeclaration9 *m_instance_declaration; // unit quad and instance streams
+    IDirect3DVertexShader9    *m_instance_vs;        // expands instances to screen quads
+    IDirect3DPixelShader9     *m_instance_ps;        // vs_3_0 can't be paired with the fixed function pipeline
+    bool                      m_instancing_supported; // device runs shader model 3
+    bool                      m_instancing;          // solid rects and bitmap glyphs are submitted as instances
+    size_t                    m_max_instances;       // max amount of instances we can draw
+    bool                      m_reuse_uploads;       // skip the upload when the render list didn't change
+    bool                      m_upload_valid;        // buffers hold the render list of m_upload_hash
+    uint64_t                  m_upload_hash;         // fingerprint of the uploaded render list
+    bool                      m_device_lost;         // default pool resources are released until on_reset
+    FontManager               m_font_manager;        // shared freetype library and faces
+    TextureManager            m_texture_manager;     // glyph pages and user textures
+    FontCatalog               m_font_catalog;        // font name -> file path
+    std::vector< TextQuad_t > m_text_quads;          // draw_text scratch
+    float                     m_line_spacing;        // line advance multiplier
+    std::string               m_markup_text;         // draw_text_markup scratch, text without tags
+    std::vector< TextSpan_t > m_markup_spans;        // draw_text_markup scratch, spans from tags
+
+    using layout_cache_t = std::unordered_map< TextLayoutKey_t, TextLayoutEntry_t, TextLayoutKeyHash_t >;
+
+    layout_cache_t  m_layout_cache;  // line breaks of recently drawn text
+    TextLayoutKey_t m_layout_key;    // reused cache lookup key
+    TextLayout_t    m_line_layout;   // single unwrapped lines are measured into this instead of the cache
+    uint64_t        m_layout_frame;  // render calls so far, the clock of the layout cache
+    std::vector< char > m_format_buffer; // draw_textf output, grows to the longest formatted string
+
+    static constexpr size_t   max_cached_layouts  = 4096; // cache is dropped when it grows past this
+    static constexpr uint64_t layout_cache_frames = 120;  // layouts unused for this many frames are evicted
+    Color                     m_text_outline_color;  // color of Font::OUTLINE
+    Color                     m_text_shadow_color;   // color of Font::DROP_SHADOW
+    Vec2_t                    m_text_shadow_offset;  // shadow offset in pixels, not scaled with the text
+    ThreadPool                m_thread_pool;         // workers for font rasterization
+
+    std::vector< font_load_ptr_t > m_font_loads;          // fonts loading in the background
+    font_id_t                      m_fallback_font;       // drawn in place of fonts that are still loading
+    size_t                         m_glyph_upload_budget; // glyphs packed per frame from background loads
     RenderList                m_render_list;         // render list
     size_t                    m_max_vertices;        // max amount of verticies we can draw
     size_t                    m_width, m_height;     // width and height of viewport
+    float                     m_ui_scale;            // logical to pixel scale, applied to the render list before it's flushed
+    std::vector< FontScale_t > m_font_scales;        // raster copies by font id
+    RenderStats_t             m_stats;               // renderer counters
+    std::vector< Rect_t >     m_clip_rects;          // clip rect stack
+    std::vector< Vec2_t >     m_clip_points;         // clipped polygon scratch
+    std::vector< Vec2_t >     m_clip_scratch;        // polygon clipper scratch
+    std::vector< Vec2_t >     m_arc_points;          // circle / arc points scratch
+    std::vector< Vec2_t >     m_polyline_points;     // polyline without repeated points
+    std::vector< Vec2_t >     m_polyline_normals;    // polyline segment normals
+    float                     m_circle_error;        // max distance in pixels between tessellated and true circle
+
+    using circle_tables_t = std::vector< std::unique_ptr< CircleTable_t > >;
+
+    circle_tables_t m_circle_tables; // unit circle tables by segment count / 4
+
+    // result of testing shape bounds against the viewport / clip rect
+    enum ClipResult : uint8_t {
+        CLIP_REJECT = 0, // fully outside, skip
+        CLIP_ACCEPT,     // fully inside or only crossing the viewport, submit as is
+        CLIP_PARTIAL     // crosses the pushed clip rect, clip on the cpu
+    };
+
+    std::vector< ClipResult > m_batch_clip; // per shape clip results of the batched draw functions
+    std::vector< size_t >     m_batch_segments; // per circle segment counts of draw_circles / draw_filled_circles
+
+    static constexpr size_t batch_chunk_vertices = 4096; // batched circles reserve about this many vertices at a time
+
+    std::vector< layer_ptr_t > m_layers;           // retained layers by id
+    layer_id_t                 m_active_layer;     // layer being recorded
+    std::vector< Rect_t >      m_layer_clip_rects; // frame clip stack while a layer is recorded
+    size_t                     m_screen_width;     // viewport size while a layer stands in for it
+    size_t                     m_screen_height;
+
+    SpriteAtlas                     m_sprite_atlas; // icons packed into shared pages
+    std::vector< texture_handle_t > m_sprite_pages; // page textures by page index
+
+    OverlayChannel         m_overlay;         // commands from other processes
+    std::vector< uint8_t > m_overlay_frame;   // records of the latest overlay frame, drawn every frame until a new one arrives
+    std::vector< uint8_t > m_overlay_staging; // drain target
+
+    // miter joins longer than this times the thickness are beveled
+    static constexpr float polyline_miter_limit = 4.f;
+
+    // classify shape bounds against viewport and clip rect
+    NOINLINE ClipResult clip_test( const Rect_t &bounds ) const;
+
+    // give back the unused tail of the last reserve_vertices call
+    NOINLINE void unreserve_vertices( size_t vertex_count );
+
+    // compile renderer shaders
+    NOINLINE bool create_shaders();
+
+    // add textured quad with optional pixel shader
+    NOINLINE void add_texture_quad( const Vec2_t &pos, const Vec2_t &size, const Color color, IDirect3DTexture9 *texture, const std::array< Vector2, 6 > &uv_coords, 
+        IDirect3DPixelShader9 *pixel_shader = nullptr, const Vec2_t &shader_params = {} );
+
+    // add convex polygon as triangle list
+    NOINLINE void add_convex_polygon( const std::vector< Vec2_t > &points, const Color color );
+
+    // add polyline as line list, clipping each segment if needed
+    NOINLINE void add_polyline_segments( const std::vector< Vec2_t > &points, const Color color, ClipResult clip );
+
+    // add single triangle, clipping it if needed
+    NOINLINE void add_triangle( const Vec2_t &a, const Vec2_t &b, const Vec2_t &c, const Color color, ClipResult clip );
+
+    // unit circle table for segment count, built on first use
+    NOINLINE const CircleTable_t &get_circle_table( size_t segment_count );
+
+    // points along a circle or arc, tessellated from the radius and circle error
+    NOINLINE void build_arc( const Vec2_t &pos, float radius, float start_angle, float sweep, std::vector< Vec2_t > &points );
+
+    // worker task of create_font_async, rasterizes until the glyph queue is full and then queues itself again
+    static NOINLINE void run_font_load( ThreadPool *pool, FontLoad_t *job );
+
+    // pack glyphs from background font loads, publish finished fonts
+    NOINLINE void process_font_loads();
+
+    // stop background font loads and wait for their workers
+    NOINLINE void cancel_font_loads();
+
+    // font to draw for id, the fallback while it's loading or invalid_font_id
+    NOINLINE font_id_t resolve_font( font_id_t font_id ) const;
+
+    // start background copies of bitmap fonts whose pixel size changes with the ui scale
+    NOINLINE void update_font_scales();
+
+    // loaded raster copy of the font at the ui scale, scale is adjusted so the text keeps its logical size
+    NOINLINE font_id_t get_scaled_font( font_id_t font_id, float &scale );
+
+    // scale the render list from logical coordinates to pixels
+    NOINLINE void apply_ui_scale();
+
+    // forget layouts that weren't used recently
+    NOINLINE void evict_text_layouts();
+
+    // collect glyph quads of str[ begin, end ) on one baseline
+    NOINLINE void add_text_run( const Font *font, std::string_view str, size_t begin, size_t end, const Vec2_t &baseline, uint32_t flags, const Color color, float scale, 
+        const std::vector< TextSpan_t > *spans, size_t &span_index );
+
+    // printf into m_format_buffer, the view is valid until the next call
+    NOINLINE std::string_view format_text( const char *format, va_list args );
+
+    // draw laid out text, glyphs inside a span take its color
+    NOINLINE void draw_text_spans( font_id_t font_id, std::string_view str, const std::vector< TextSpan_t > *spans, const Vec2_t &pos, float max_width, uint32_t flags, const Color color, float scale );
+
+    // sort collected glyph quads into layers and batches, then add them
+    NOINLINE void emit_text_quads();
 
     // reacquire vertex buffer
     NOINLINE bool reacquire();
 
+    // hand the uploaded atlas pages of a font to the texture manager, cold pages can then be evicted
+    NOINLINE void manage_font_pages( font_id_t font_id );
+
+    // page texture for drawing, rasterized again if it was evicted
+    FORCEINLINE IDirect3DTexture9 *acquire_glyph_page( const Font *font, size_t page_index ) {
+        const auto &page = font->m_pages[ page_index ];
+
+        return page.m_handle != invalid_texture_handle ? m_texture_manager.acquire( page.m_handle ) : page.m_texture;
+    }
+
+    // evict textures over the budget after the frame is drawn
+    NOINLINE void trim_textures();
+
+    // create textures for atlas pages that don't have one yet
+    NOINLINE bool upload_sprite_pages();
+
+    // drain the overlay channel and draw its latest frame
+    NOINLINE void draw_overlay();
+
+    // grow vertex / instance buffers to fit list
+    NOINLINE bool grow_buffers( const RenderList &list );
+
+    // draw recorded layers into their textures
+    NOINLINE void render_layers();
+    NOINLINE void render_layer( Layer_t &layer );
+
+    // recording a VERTICES layer, its rect is the bottom clip rect
+    FORCEINLINE bool is_recording_vertices() const {
+        return m_active_layer != invalid_layer_id && m_layers[ m_active_layer ]->m_mode == Layer_t::VERTICES;
+    }
+
+    // free layer textures, they live in the default pool
+    NOINLINE void release_layers();
+
+    // fingerprint of the render list, vertices, instances and batches
+    NOINLINE uint64_t hash_render_list() const;
+
+    // copy the render list into the vertex / instance buffers
+    NOINLINE bool upload_render_list();
+
+    // buffers of the instanced path, failing only turns instancing off
+    NOINLINE void create_instance_buffers();
+
+    // compile the instancing shaders, failing only turns instancing off
+    NOINLINE void create_instance_shaders();
+
+    // switch the device between fixed function vertices and instanced quads while flushing
+    NOINLINE void begin_instancing();
+    NOINLINE void end_instancing();
+
+    // append instances to the render list and return them to be written in place
+    NOINLINE Instance_t *reserve_instances( size_t instance_count, IDirect3DTexture9 *texture = nullptr );
+
     // beging rendering 
     NOINLINE void begin();
 
@@ -236,14 +1046,29 @@ public:
     fonts_t m_fonts;
 
     // ctor(s)
-    FORCEINLINE Renderer() : m_device{ nullptr }, m_vertex_buffer{ nullptr }, m_render_state_block{ nullptr }, m_render_list{}, m_max_vertices{}, m_width{}, m_height{}, m_fonts{} {
+    FORCEINLINE Renderer() : m_device{ nullptr }, m_vertex_buffer{ nullptr }, m_render_state_block{ nullptr }, m_sdf_shader{ nullptr }, m_layer_shader{ nullptr }, m_sprite_shader{ nullptr }, m_instance_buffer{ nullptr }, m_quad_buffer{ nullptr }, m_quad_indices{ nullptr }, m_instance_declaration{ nullptr }, 
+        m_instance_vs{ nullptr }, m_instance_ps{ nullptr }, m_instancing_supported{}, m_instancing{}, m_max_instances{}, m_reuse_uploads{ true }, 
+        m_upload_valid{}, m_upload_hash{}, m_device_lost{}, m_font_manager{}, m_texture_manager{}, m_font_catalog{}, m_text_quads{}, m_line_spacing{ 1.f }, m_markup_text{}, m_markup_spans{}, m_layout_cache{}, m_layout_key{}, m_line_layout{}, m_layout_frame{}, m_format_buffer( 512 ), m_text_outline_color{ 255, 0, 0, 0 }, m_text_shadow_color{ 160, 0, 0, 0 }, m_text_shadow_offset{ 1.f, 1.f }, m_thread_pool{}, m_font_loads{}, m_fallback_font{ invalid_font_id }, m_glyph_upload_budget{ 256 }, m_render_list{}, m_max_vertices{}, m_width{}, m_height{}, m_ui_scale{ 1.f }, m_font_scales{}, m_stats{}, m_clip_rects{}, m_clip_points{}, m_clip_scratch{}, 
+        m_arc_points{}, m_polyline_points{}, m_polyline_normals{}, m_circle_error{ 0.25f }, m_circle_tables{}, m_batch_clip{}, m_batch_segments{}, 
+        m_layers{}, m_active_layer{ invalid_layer_id }, m_layer_clip_rects{}, m_screen_width{}, m_screen_height{}, m_sprite_atlas{}, m_sprite_pages{}, m_overlay{}, m_overlay_frame{}, m_overlay_staging{}, m_fonts{} {
    
     }
 
     // dtor
     FORCEINLINE ~Renderer() {
+        cancel_font_loads();
+
         release();
 
+        release_layers();
+
+        Utils::safe_release( &m_sdf_shader );
+        Utils::safe_release( &m_layer_shader );
+        Utils::safe_release( &m_sprite_shader );
+        Utils::safe_release( &m_instance_declaration );
+        Utils::safe_release( &m_instance_vs );
+        Utils::safe_release( &m_instance_ps );
+
         m_device    = nullptr;
         m_max_vertices = 0;
         m_width     = 0;
@@ -251,30 +1076,110 @@ public:
         
         for( auto &font : m_fonts ) {
             // release all textures
-            for( auto &glyph: font->m_glyphs ) 
-                Utils::safe_release( &glyph.second.m_texture );
+            font->release();
 
             font.reset();
         }
 
         m_fonts.clear();
+
+        // fonts hold references to shared faces, close them last
+        m_font_manager.release();
     }
 
-    // initialize renderer
-    NOINLINE bool init( IDirect3DDevice9 *device, size_t max_vertices );
+    // initialize renderer. worker_count is the number of font rasterization threads, 0 uses one less than the core count
+    NOINLINE bool init( IDirect3DDevice9 *device, size_t max_vertices, size_t worker_count = 0 );
 
     // render the buffer
     NOINLINE void render();
 
+    // device was lost, release default pool resources ( vertex buffers, state block, layer textures ) before IDirect3DDevice9::Reset.
+    // fonts, shaders and caches are kept. nothing is drawn until on_reset
+    NOINLINE void on_lost();
+
+    // device was reset, recreate default pool resources and pick up the new viewport size
+    NOINLINE bool on_reset();
+
+    FORCEINLINE bool is_device_lost() const {
+        return m_device_lost;
+    }
+
+    // pick up the viewport size after the window or back buffer was resized, no need to init again
+    NOINLINE bool resize();
+
+    NOINLINE void resize( size_t width, size_t height );
+
+    // draw in logical coordinates, positions and sizes are multiplied by scale when the frame is rendered.
+    // bitmap fonts whose pixel size changes are rasterized again in the background, the old glyphs ( scaled )
+    // keep drawing until the copy is loaded. texture layers are stretched
+    NOINLINE void set_ui_scale( float scale );
+
+    // ui scale for a monitor dpi, 96 is 1:1
+    FORCEINLINE void set_dpi( uint32_t dpi ) {
+        set_ui_scale( ( float ) dpi / 96.f );
+    }
+
+    FORCEINLINE float get_ui_scale() const {
+        return m_ui_scale;
+    }
+
     // add verticies to draw
-    NOINLINE void add_vertices( Vertex_t *vertex_array, size_t vertex_count, D3DPRIMITIVETYPE topology, IDirect3DTexture9 *texture = nullptr );
+    NOINLINE void add_vertices( Vertex_t *vertex_array, size_t vertex_count, D3DPRIMITIVETYPE topology, IDirect3DTexture9 *texture = nullptr, 
+        IDirect3DPixelShader9 *pixel_shader = nullptr, const Vec2_t &shader_params = {} );
+
+    // append vertices to the render list and return them to be written in place
+    NOINLINE Vertex_t *reserve_vertices( size_t vertex_count, D3DPRIMITIVETYPE topology, IDirect3DTexture9 *texture = nullptr, 
+        IDirect3DPixelShader9 *pixel_shader = nullptr, const Vec2_t &shader_params = {} );
+
+    // create ttf font, see Font::FontCreateFlags. invalid_font_id on failure
+    NOINLINE font_id_t create_font( const std::string &ttf_font, size_t size, bool anti_alias, uint32_t create_flags = Font::CREATE_NONE );
+
+    // create ttf font without blocking, the id is valid right away but the font draws as the fallback ( or not at all )
+    // until it's loaded. glyphs are packed inside render, the callback runs on the render thread once done.
+    // on a single core without pool workers it loads right away instead. invalid_font_id if the font can't be opened
+    NOINLINE font_id_t create_font_async( const std::string &ttf_font, size_t size, bool anti_alias, uint32_t create_flags = Font::CREATE_NONE, font_callback_t callback = nullptr );
 
-    // create ttf font 
-    NOINLINE font_id_t create_font( const std::string &ttf_font, size_t size, bool anti_alias );
+    // search fallback font for glyphs the font doesn't have, in the order fallbacks are added.
+    // a single draw_text call then mixes glyphs from every font in the chain
+    NOINLINE bool add_font_fallback( font_id_t font_id, font_id_t fallback_id );
 
-    // windows font path
+    // color of outlined text
+    FORCEINLINE void set_text_outline_color( const Color color ) {
+        m_text_outline_color = color;
+    }
+
+    // color and offset of text shadows
+    FORCEINLINE void set_text_shadow( const Vec2_t &offset, const Color color ) {
+        m_text_shadow_offset = offset;
+        m_text_shadow_color  = color;
+    }
+
+    // font drawn in place of fonts that are still loading
+    FORCEINLINE void set_fallback_font( font_id_t font_id ) {
+        m_fallback_font = font_id;
+    }
+
+    // glyphs packed per frame from background loads
+    FORCEINLINE void set_glyph_upload_budget( size_t budget ) {
+        m_glyph_upload_budget = std::max< size_t >( budget, 1 );
+    }
+
+    // is font ready to draw?
+    FORCEINLINE bool is_font_loaded( font_id_t font_id ) const {
+        return font_id < m_fonts.size() && m_fonts[ font_id ]->is_loaded();
+    }
+
+    // build font catalogue from the system fonts, or load it from the index file if one was saved before
+    NOINLINE bool init_font_catalog( const std::string &index_path = {} );
+
+    // font file path by name, ex. "Arial" or "Arial Bold (TrueType)". empty if the font isn't installed
     NOINLINE std::string get_font_path( const std::string &font_name );
 
+    // get font catalogue, ex. to add a fonts directory
+    FORCEINLINE FontCatalog &get_font_catalog() {
+        return m_font_catalog;
+    }
+
     //
     // utility
     //
@@ -282,6 +1187,150 @@ public:
         return m_fonts;
     }
 
+    FORCEINLINE const RenderStats_t &get_stats() const {
+        return m_stats;
+    }
+
+    FORCEINLINE void reset_stats() {
+        m_stats.reset();
+    }
+
+    // submit solid rects and bitmap glyphs as one instance instead of 6 vertices each.
+    // needs shader model 3, returns false if the device can't
+    FORCEINLINE bool set_instancing( bool enable ) {
+        m_instancing = enable && m_instancing_supported;
+
+        return m_instancing == enable;
+    }
+
+    FORCEINLINE bool is_instancing() const {
+        return m_instancing;
+    }
+
+    //
+    // textures
+    //
+    // load image file, the texture can be evicted under the budget and is read again on use
+    NOINLINE texture_handle_t load_texture( const std::string &path );
+
+    // texture from A8R8G8B8 pixels, always resident
+    NOINLINE texture_handle_t create_texture( size_t width, size_t height, const uint32_t *pixels );
+
+    NOINLINE void release_texture( texture_handle_t texture );
+
+    // texture for drawing this frame, null if the handle is stale
+    FORCEINLINE IDirect3DTexture9 *get_texture( texture_handle_t texture ) {
+        return m_texture_manager.acquire( texture );
+    }
+
+    // max bytes of resident glyph pages and textures, 0 is unlimited. textures that weren't drawn
+    // recently are evicted after the frame, glyph pages are rasterized again when they're needed
+    FORCEINLINE void set_texture_budget( size_t bytes ) {
+        m_texture_manager.set_budget( bytes );
+    }
+
+    FORCEINLINE const TextureFootprint_t &get_texture_footprint() const {
+        return m_texture_manager.get_footprint();
+    }
+
+    // resident bytes of a font's atlas pages
+    FORCEINLINE size_t get_font_texture_bytes( font_id_t font_id ) const {
+        return m_texture_manager.get_group_bytes( font_id );
+    }
+
+    // per texture / page queries
+    FORCEINLINE const TextureManager &get_texture_manager() const {
+        return m_texture_manager;
+    }
+
+    //
+    // sprites
+    //
+    // load a binary atlas file made by sprite_packer, replaces the current atlas
+    NOINLINE bool load_sprite_atlas( const std::string &path );
+
+    // load images ( png, etc. ) and pack them into the atlas at startup, sprites are named after their file
+    NOINLINE bool add_sprites( const std::vector< std::string > &paths, size_t page_size = 1024 );
+
+    // sprite id by name, invalid_sprite_id if there's none
+    FORCEINLINE sprite_id_t find_sprite( const std::string &name ) const {
+        return m_sprite_atlas.find( name );
+    }
+
+    FORCEINLINE const SpriteAtlas &get_sprite_atlas() const {
+        return m_sprite_atlas;
+    }
+
+    // create a retained layer, or get the one with this name
+    NOINLINE layer_id_t create_layer( const std::string &name, const Vec2_t &pos, const Vec2_t &size, Layer_t::LayerMode mode = Layer_t::TEXTURE );
+
+    // layer id by name, invalid_layer_id if there's none
+    NOINLINE layer_id_t find_layer( const std::string &name ) const;
+
+    // record draw calls into the layer until end_layer, coordinates are relative to the layer.
+    // returns false if the layer is still valid and there's nothing to draw
+    NOINLINE bool begin_layer( layer_id_t layer_id );
+
+    // stop recording
+    NOINLINE void end_layer();
+
+    // draw the recorded layer at its position
+    NOINLINE void draw_layer( layer_id_t layer_id );
+
+    // record the layer again on the next begin_layer
+    NOINLINE void invalidate_layer( layer_id_t layer_id );
+
+    // move or resize layer, resizing invalidates it
+    NOINLINE void set_layer_rect( layer_id_t layer_id, const Vec2_t &pos, const Vec2_t &size );
+
+    // create the shared memory channel other processes draw through, see OverlayChannel
+    NOINLINE bool open_overlay_channel( const std::string &name, size_t capacity = 1 << 20 );
+
+    NOINLINE void close_overlay_channel();
+
+    // channel counters
+    FORCEINLINE const OverlayChannel &get_overlay_channel() const {
+        return m_overlay;
+    }
+
+    // hash the render list every frame and skip the upload when it matches the last one, on by default.
+    // worth turning off when nothing drawn is ever static
+    FORCEINLINE void set_upload_reuse( bool enable ) {
+        m_reuse_uploads = enable;
+        m_upload_valid  = false;
+    }
+
+    // max distance in pixels between a tessellated circle and the true curve, smaller is smoother
+    FORCEINLINE void set_circle_error( float max_error ) {
+        m_circle_error = std::max( max_error, 0.01f );
+    }
+
+    // write counters and derived rates as json, so runs can be diffed
+    NOINLINE bool dump_stats_json( const std::string &path ) const;
+
+    //
+    // clipping
+    //
+    // push clip rect from vector dimensions, geometry is clipped against it on the cpu
+    NOINLINE void push_clip_rect( const Vec2_t &pos, const Vec2_t &size, bool intersect_current = true );
+
+    // push clip rect from dimensions
+    NOINLINE void push_clip_rect( float x, float y, float w, float h, bool intersect_current = true );
+
+    // pop last clip rect
+    NOINLINE void pop_clip_rect();
+
+    // current clip rect, the viewport if none is pushed
+    FORCEINLINE Rect_t get_clip_rect() const {
+        if( !m_clip_rects.empty() )
+            return m_clip_rects.back();
+
+        // logical viewport size, layers are recorded at their own size
+        const auto scale = m_active_layer == invalid_layer_id ? m_ui_scale : 1.f;
+
+        return { { 0.f, 0.f }, { ( float ) m_width / scale, ( float ) m_height / scale } };
+    }
+
     //
     // drawing utility functions
     //
@@ -333,20 +1382,112 @@ public:
     // draw filled circle from dimensions
     NOINLINE void draw_filled_circle( float x, float y, float radius, const Color color );
 
+    // draw arc from vector dimensions, angles in radians, thickness extends to both sides of the arc
+    NOINLINE void draw_arc( const Vec2_t &pos, float radius, float start_angle, float sweep, const Color color, float thickness = 1.f );
+
+    // draw arc from dimensions
+    NOINLINE void draw_arc( float x, float y, float radius, float start_angle, float sweep, const Color color, float thickness = 1.f );
+
+    // draw filled circle sector from vector dimensions, angles in radians
+    NOINLINE void draw_sector( const Vec2_t &pos, float radius, float start_angle, float sweep, const Color color );
+
+    // draw filled circle sector from dimensions
+    NOINLINE void draw_sector( float x, float y, float radius, float start_angle, float sweep, const Color color );
+
+    // draw many solid rects, vertices for all of them are reserved at once
+    NOINLINE void draw_filled_rects( const FilledRect_t *rects, size_t count );
+
+    FORCEINLINE void draw_filled_rects( const std::vector< FilledRect_t > &rects ) {
+        draw_filled_rects( rects.data(), rects.size() );
+    }
+
+    // draw many lines of the same thickness, vertices for all of them are reserved at once
+    NOINLINE void draw_lines( const LineSegment_t *lines, size_t count, float thickness = 1.f );
+
+    FORCEINLINE void draw_lines( const std::vector< LineSegment_t > &lines, float thickness = 1.f ) {
+        draw_lines( lines.data(), lines.size(), thickness );
+    }
+
+    // draw connected lines, thick polylines get mitered joins ( beveled when too sharp ). closed joins the last point to the first
+    NOINLINE void draw_polyline( const Vec2_t *points, size_t count, const Color color, float thickness = 1.f, bool closed = false );
+
+    FORCEINLINE void draw_polyline( const std::vector< Vec2_t > &points, const Color color, float thickness = 1.f, bool closed = false ) {
+        draw_polyline( points.data(), points.size(), color, thickness, closed );
+    }
+
+    // draw many circle outlines, vertices are reserved a few thousand at a time
+    NOINLINE void draw_circles( const Circle_t *circles, size_t count );
+
+    FORCEINLINE void draw_circles( const std::vector< Circle_t > &circles ) {
+        draw_circles( circles.data(), circles.size() );
+    }
+
+    // draw many filled circles, vertices are reserved a few thousand at a time
+    NOINLINE void draw_filled_circles( const Circle_t *circles, size_t count );
+
+    FORCEINLINE void draw_filled_circles( const std::vector< Circle_t > &circles ) {
+        draw_filled_circles( circles.data(), circles.size() );
+    }
+
     // draw texture quad from vector dimensions
     NOINLINE void draw_texture_quad( const Vec2_t &pos, const Vec2_t &size, const Color color, IDirect3DTexture9 *texture, const std::array< Vector2, 6 > & uv_coords );
 
     // draw texture quad from dimensions
     NOINLINE void draw_texture_quad( float x, float y, float w, float h, const Color color, IDirect3DTexture9 *texture, const std::array< Vector2, 6 > & uv_coords );
 
+    // draw sprite from the atlas, sprites on the same page batch together
+    NOINLINE void draw_sprite( sprite_id_t sprite_id, const Vec2_t &pos, const Vec2_t &size, const Color color = { 255, 255, 255, 255 } );
+
+    // draw sprite at its pixel size times scale
+    NOINLINE void draw_sprite( sprite_id_t sprite_id, const Vec2_t &pos, const Color color = { 255, 255, 255, 255 }, float scale = 1.f );
+
+    // draw managed texture quad from vector dimensions
+    NOINLINE void draw_texture_quad( const Vec2_t &pos, const Vec2_t &size, const Color color, texture_handle_t texture, const std::array< Vector2, 6 > & uv_coords );
+
     //
     // text drawing functions
     //
     // draww text from vector dimensions
-    NOINLINE void draw_text( font_id_t font_id, const std::string &str, const Vec2_t &pos, uint32_t flags, const Color color, float scale = 1.f );
+    NOINLINE void draw_text( font_id_t font_id, std::string_view str, const Vec2_t &pos, uint32_t flags, const Color color, float scale = 1.f );
 
     // draw text from dimensions
-    NOINLINE void draw_text( font_id_t font_id, const std::string &str, float x, float y, uint32_t flags, const Color color, float scale = 1.f );
+    NOINLINE void draw_text( font_id_t font_id, std::string_view str, float x, float y, uint32_t flags, const Color color, float scale = 1.f );
+
+    // draw printf style formatted text, formatted into a reused buffer so it doesn't allocate
+    NOINLINE void draw_textf( font_id_t font_id, const Vec2_t &pos, uint32_t flags, const Color color, const char *format, ... );
+
+    // draw formatted text from dimensions
+    NOINLINE void draw_textf( font_id_t font_id, float x, float y, uint32_t flags, const Color color, const char *format, ... );
+
+    // draw text with colored spans, spans are byte ranges sorted by position and must not overlap.
+    // glyphs outside of every span take color
+    NOINLINE void draw_text( font_id_t font_id, std::string_view str, const std::vector< TextSpan_t > &spans, const Vec2_t &pos, uint32_t flags, const Color color, float scale = 1.f );
+
+    // draw text with inline color tags, {#rrggbb} or {#aarrggbb} switch color, {/} goes back to color and {{ is a brace
+    NOINLINE void draw_text_markup( font_id_t font_id, std::string_view markup, const Vec2_t &pos, float max_width, uint32_t flags, const Color color, float scale = 1.f );
+
+    // strip color tags from markup, tagged ranges become spans of the stripped text
+    NOINLINE static void parse_text_markup( std::string_view markup, const Color color, std::string &text, std::vector< TextSpan_t > &spans );
+
+    // draw multi line text, wrapped at spaces to max_width if it's positive. alignment flags align the block
+    // like draw_text, ALIGN_RIGHT / ALIGN_CENTER_X / ALIGN_CENTER also align each line inside the block
+    NOINLINE void draw_text_box( font_id_t font_id, std::string_view str, const Vec2_t &pos, float max_width, uint32_t flags, const Color color, float scale = 1.f );
+
+    // draw multi line text from dimensions
+    NOINLINE void draw_text_box( font_id_t font_id, std::string_view str, float x, float y, float max_width, uint32_t flags, const Color color, float scale = 1.f );
+
+    // size of the text block as draw_text_box would draw it
+    NOINLINE Vec2_t get_text_bounds( font_id_t font_id, std::string_view str, float max_width = 0.f, float scale = 1.f );
+
+    // line breaks for text, width in font pixels, 0 doesn't wrap. wrapped or multi-line text is cached per
+    // ( font, text, width ), a single line is measured again into scratch valid until the next call
+    NOINLINE const TextLayout_t &get_text_layout( font_id_t font_id, std::string_view str, float max_width );
+
+    // line advance multiplier, 1 is the face line height
+    FORCEINLINE void set_line_spacing( float spacing ) {
+        m_line_spacing = spacing;
+        m_layout_cache.clear();
+    }
 };
 
 extern std::shared_ptr< Renderer > g_d3d9_renderer;
\ No newline at end of file
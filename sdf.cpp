@@ -0,0 +1,157 @@
+// portable, builds without the windows / d3d headers so it can be tested anywhere
+#include <cmath>
+#include <algorithm>
+#include "sdf.h"
+
+namespace Sdf {
+
+    namespace {
+
+        constexpr float infinity = 1e20f;
+
+        // squared euclidean distance transform of a sampled 1d function, lower envelope of parabolas.
+        // felzenszwalb & huttenlocher, "distance transforms of sampled functions"
+        NOINLINE void transform_1d( const float *f, float *d, size_t *v, float *z, size_t n ) {
+            size_t k;
+            float  s;
+
+            k      = 0;
+            v[ 0 ] = 0;
+            z[ 0 ] = -infinity;
+            z[ 1 ] = infinity;
+
+            for( size_t q = 1; q < n; ++q ) {
+                // intersection with the rightmost parabola, drop parabolas that are no longer part of the envelope
+                while( true ) {
+                    const auto r = v[ k ];
+
+                    s = ( ( f[ q ] + ( float ) ( q * q ) ) - ( f[ r ] + ( float ) ( r * r ) ) ) / ( 2.f * ( float ) q - 2.f * ( float ) r );
+                    if( s > z[ k ] || k == 0 )
+                        break;
+
+                    --k;
+                }
+
+                ++k;
+                v[ k ]     = q;
+                z[ k ]     = s;
+                z[ k + 1 ] = infinity;
+            }
+
+            k = 0;
+
+            for( size_t q = 0; q < n; ++q ) {
+                while( z[ k + 1 ] < ( float ) q )
+                    ++k;
+
+                const auto delta = ( float ) q - ( float ) v[ k ];
+                d[ q ] = delta * delta + f[ v[ k ] ];
+            }
+        }
+
+        // in place 2d transform, columns then rows
+        NOINLINE void transform_2d( std::vector< float > &grid, size_t width, size_t height ) {
+            const auto n = std::max( width, height );
+
+            std::vector< float >  f( n ), d( n ), z( n + 1 );
+            std::vector< size_t > v( n );
+
+            for( size_t x = 0; x < width; ++x ) {
+                for( size_t y = 0; y < height; ++y )
+                    f[ y ] = grid[ y * width + x ];
+
+                transform_1d( f.data(), d.data(), v.data(), z.data(), height );
+
+                for( size_t y = 0; y < height; ++y )
+                    grid[ y * width + x ] = d[ y ];
+            }
+
+            for( size_t y = 0; y < height; ++y ) {
+                transform_1d( &grid[ y * width ], d.data(), v.data(), z.data(), width );
+
+                std::copy( d.begin(), d.begin() + width, grid.begin() + y * width );
+            }
+        }
+
+    }
+
+    NOINLINE bool generate( const uint8_t *coverage, size_t width, size_t height, ptrdiff_t pitch, size_t supersample, size_t spread,
+        std::vector< uint8_t > &pixels, size_t &out_width, size_t &out_height ) {
+        if( !supersample || !spread )
+            return false;
+
+        pixels.clear();
+
+        // empty glyph ( space, etc. )
+        if( !width || !height || !coverage ) {
+            out_width  = 0;
+            out_height = 0;
+
+            return true;
+        }
+
+        // the high resolution grid gets the same padding as the output so distances reach into it
+        const auto padding     = spread * supersample;
+        const auto grid_width  = width + padding * 2;
+        const auto grid_height = height + padding * 2;
+
+        // outside: distance to the nearest covered pixel, inside: distance to the nearest empty pixel
+        std::vector< float > outside( grid_width * grid_height, 0.f );
+        std::vector< float > inside( grid_width * grid_height, 0.f );
+
+        for( size_t y = 0; y < grid_height; ++y ) {
+            for( size_t x = 0; x < grid_width; ++x ) {
+                auto covered = false;
+
+                if( x >= padding && x < padding + width && y >= padding && y < padding + height )
+                    covered = coverage[ ( ptrdiff_t ) ( y - padding ) * pitch + ( ptrdiff_t ) ( x - padding ) ] >= 128;
+
+                outside[ y * grid_width + x ] = covered ? 0.f : infinity;
+                inside[ y * grid_width + x ]  = covered ? infinity : 0.f;
+            }
+        }
+
+        transform_2d( outside, grid_width, grid_height );
+        transform_2d( inside, grid_width, grid_height );
+
+        out_width  = ( width + supersample - 1 ) / supersample + spread * 2;
+        out_height = ( height + supersample - 1 ) / supersample + spread * 2;
+
+        pixels.resize( out_width * out_height );
+
+        // signed distance in high resolution pixels, measured from the pixel edge rather than its center
+        const auto signed_distance = [ & ]( size_t x, size_t y ) {
+            const auto index = std::min( y, grid_height - 1 ) * grid_width + std::min( x, grid_width - 1 );
+
+            if( inside[ index ] > 0.f )
+                return std::sqrt( inside[ index ] ) - 0.5f;
+
+            return 0.5f - std::sqrt( outside[ index ] );
+        };
+
+        // sample the center of every output pixel, with an even supersample the center lies between 4 pixels
+        const auto half = supersample / 2;
+
+        for( size_t y = 0; y < out_height; ++y ) {
+            for( size_t x = 0; x < out_width; ++x ) {
+                const auto grid_x = x * supersample + half;
+                const auto grid_y = y * supersample + half;
+
+                float distance;
+                if( supersample % 2 )
+                    distance = signed_distance( grid_x, grid_y );
+                else
+                    distance = ( signed_distance( grid_x - 1, grid_y - 1 ) + signed_distance( grid_x, grid_y - 1 ) 
+                        + signed_distance( grid_x - 1, grid_y ) + signed_distance( grid_x, grid_y ) ) * 0.25f;
+
+                // to output pixels, then to [0, 1] with the edge at 0.5
+                const auto value = 0.5f + ( distance / ( float ) supersample ) / ( 2.f * ( float ) spread );
+
+                pixels[ y * out_width + x ] = ( uint8_t ) ( std::clamp( value, 0.f, 1.f ) * 255.f + 0.5f );
+            }
+        }
+
+        return true;
+    }
+
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+// portable, also builds without the windows / d3d headers
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#ifndef NOINLINE
+    #define NOINLINE
+#endif
+
+//
+// Signed distance field generation
+//
+// the glyph is rasterized at supersample times the target size, an exact euclidean distance transform
+// is run on the high resolution coverage, and the result is sampled down to the target size.
+// output is A8, 128 is the glyph edge, larger values are inside, spread pixels map to the full range.
+//
+namespace Sdf {
+
+    // generate distance field from 8 bit coverage, the output is padded by spread pixels on every side
+    NOINLINE bool generate( const uint8_t *coverage, size_t width, size_t height, ptrdiff_t pitch, size_t supersample, size_t spread,
+        std::vector< uint8_t > &pixels, size_t &out_width, size_t &out_height );
+
+}
@@ -0,0 +1,246 @@
+// portable, builds without the windows / d3d headers so the offline packer runs anywhere
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include "sprite_atlas.h"
+
+NOINLINE void SpriteAtlas::update_uvs( Sprite_t &sprite ) const {
+    const auto &page = m_pages[ sprite.m_page ];
+
+    sprite.m_u0 = ( float ) sprite.m_x / page.m_width;
+    sprite.m_v0 = ( float ) sprite.m_y / page.m_height;
+    sprite.m_u1 = ( float ) ( sprite.m_x + sprite.m_width ) / page.m_width;
+    sprite.m_v1 = ( float ) ( sprite.m_y + sprite.m_height ) / page.m_height;
+}
+
+NOINLINE bool SpriteAtlas::add_image( const std::string &name, size_t width, size_t height, const uint32_t *pixels ) {
+    if( name.empty() || !width || !height || !pixels || m_lookup.count( name ) )
+        return false;
+
+    // ids follow the order images are added in, packing order doesn't change them
+    m_lookup[ name ] = m_sprites.size() + m_images.size();
+
+    m_images.push_back( { name, ( uint32_t ) width, ( uint32_t ) height, std::vector< uint32_t >( pixels, pixels + width * height ) } );
+
+    return true;
+}
+
+NOINLINE void SpriteAtlas::drop_images() {
+    for( const auto &image : m_images )
+        m_lookup.erase( image.m_name );
+
+    m_images.clear();
+}
+
+NOINLINE bool SpriteAtlas::build( size_t page_size, size_t padding ) {
+    std::vector< size_t >     order;
+    std::vector< RectPacker > packers;
+    size_t                    x = 0, y = 0, page_index;
+
+    // pages double until the image fits, checked up front so a failed build leaves the atlas as it was
+    if( page_size < min_page_size || page_size > max_page_size )
+        return false;
+
+    for( const auto &image : m_images ) {
+        if( image.m_width + padding * 2 > max_page_size || image.m_height + padding * 2 > max_page_size )
+            return false;
+    }
+
+    const auto first_sprite = m_sprites.size();
+    const auto first_page   = m_pages.size();
+
+    m_sprites.resize( first_sprite + m_images.size() );
+
+    // tallest first keeps the shelves tight
+    order.resize( m_images.size() );
+    for( size_t i = 0; i < order.size(); ++i )
+        order[ i ] = i;
+
+    std::sort( order.begin(), order.end(), [ & ]( size_t a, size_t b ) {
+        if( m_images[ a ].m_height != m_images[ b ].m_height )
+            return m_images[ a ].m_height > m_images[ b ].m_height;
+
+        return m_images[ a ].m_width > m_images[ b ].m_width;
+    } );
+
+    for( const auto index : order ) {
+        const auto &image = m_images[ index ];
+
+        // only pages of this build are packed into, earlier builds may have dropped their pixels
+        for( page_index = 0; page_index < packers.size(); ++page_index ) {
+            if( packers[ page_index ].pack( image.m_width, image.m_height, x, y ) )
+                break;
+        }
+
+        if( page_index == packers.size() ) {
+            size_t page_width  = page_size;
+            size_t page_height = page_size;
+
+            // oversized images get a page of their own
+            while( page_width < image.m_width + padding * 2 )
+                page_width *= 2;
+
+            while( page_height < image.m_height + padding * 2 )
+                page_height *= 2;
+
+            packers.emplace_back( page_width, page_height, padding );
+            m_pages.push_back( { ( uint32_t ) page_width, ( uint32_t ) page_height, std::vector< uint32_t >( page_width * page_height, 0 ) } );
+
+            if( !packers.back().pack( image.m_width, image.m_height, x, y ) )
+                return false;
+        }
+
+        auto &page = m_pages[ first_page + page_index ];
+
+        for( size_t row = 0; row < image.m_height; ++row )
+            std::memcpy( &page.m_pixels[ ( y + row ) * page.m_width + x ], &image.m_pixels[ row * image.m_width ], image.m_width * sizeof( uint32_t ) );
+
+        // repeat the edges into the padding
+        for( size_t row = y; row < y + image.m_height; ++row ) {
+            const auto line = &page.m_pixels[ row * page.m_width ];
+
+            for( size_t i = 1; i <= padding; ++i ) {
+                line[ x - i ]                    = line[ x ];
+                line[ x + image.m_width - 1 + i ] = line[ x + image.m_width - 1 ];
+            }
+        }
+
+        for( size_t i = 1; i <= padding; ++i ) {
+            std::memcpy( &page.m_pixels[ ( y - i ) * page.m_width + x - padding ], &page.m_pixels[ y * page.m_width + x - padding ], ( image.m_width + padding * 2 ) * sizeof( uint32_t ) );
+            std::memcpy( &page.m_pixels[ ( y + image.m_height - 1 + i ) * page.m_width + x - padding ], &page.m_pixels[ ( y + image.m_height - 1 ) * page.m_width + x - padding ],
+                ( image.m_width + padding * 2 ) * sizeof( uint32_t ) );
+        }
+
+        auto &sprite = m_sprites[ first_sprite + index ];
+        sprite.m_name   = image.m_name;
+        sprite.m_page   = ( uint32_t ) ( first_page + page_index );
+        sprite.m_x      = ( uint32_t ) x;
+        sprite.m_y      = ( uint32_t ) y;
+        sprite.m_width  = image.m_width;
+        sprite.m_height = image.m_height;
+
+        update_uvs( sprite );
+    }
+
+    m_images.clear();
+
+    return true;
+}
+
+NOINLINE bool SpriteAtlas::save( const std::string &path ) const {
+    FILE *file;
+
+    file = std::fopen( path.c_str(), "wb" );
+    if( !file )
+        return false;
+
+    const auto write = [ & ]( const void *data, size_t size ) {
+        return std::fwrite( data, 1, size, file ) == size;
+    };
+
+    const auto write_u32 = [ & ]( uint32_t value ) {
+        return write( &value, sizeof( value ) );
+    };
+
+    // header, then pages with their pixels, then sprites. little endian
+    auto ok = write_u32( magic ) && write_u32( version ) && write_u32( ( uint32_t ) m_pages.size() ) && write_u32( ( uint32_t ) m_sprites.size() );
+
+    for( const auto &page : m_pages ) {
+        ok = ok && page.m_pixels.size() == ( size_t ) page.m_width * page.m_height
+            && write_u32( page.m_width ) && write_u32( page.m_height ) && write( page.m_pixels.data(), page.m_pixels.size() * sizeof( uint32_t ) );
+    }
+
+    for( const auto &sprite : m_sprites ) {
+        ok = ok && write_u32( sprite.m_page ) && write_u32( sprite.m_x ) && write_u32( sprite.m_y ) && write_u32( sprite.m_width ) && write_u32( sprite.m_height )
+            && write_u32( ( uint32_t ) sprite.m_name.size() ) && write( sprite.m_name.data(), sprite.m_name.size() );
+    }
+
+    return std::fclose( file ) == 0 && ok;
+}
+
+NOINLINE bool SpriteAtlas::load( const std::string &path ) {
+    FILE     *file;
+    uint32_t header[ 4 ], values[ 6 ];
+
+    clear();
+
+    file = std::fopen( path.c_str(), "rb" );
+    if( !file )
+        return false;
+
+    const auto read = [ & ]( void *data, size_t size ) {
+        return std::fread( data, 1, size, file ) == size;
+    };
+
+    auto ok = read( header, sizeof( header ) ) && header[ 0 ] == magic && header[ 1 ] == version;
+
+    for( uint32_t i = 0; ok && i < header[ 2 ]; ++i ) {
+        Page_t page;
+
+        ok = read( values, sizeof( uint32_t ) * 2 ) && values[ 0 ] && values[ 1 ] && values[ 0 ] <= max_page_size && values[ 1 ] <= max_page_size;
+        if( !ok )
+            break;
+
+        page.m_width  = values[ 0 ];
+        page.m_height = values[ 1 ];
+        page.m_pixels.resize( ( size_t ) page.m_width * page.m_height );
+
+        ok = read( page.m_pixels.data(), page.m_pixels.size() * sizeof( uint32_t ) );
+
+        m_pages.push_back( std::move( page ) );
+    }
+
+    for( uint32_t i = 0; ok && i < header[ 3 ]; ++i ) {
+        Sprite_t sprite;
+
+        ok = read( values, sizeof( values ) ) && values[ 0 ] < m_pages.size() && values[ 5 ] < 4096;
+        if( !ok )
+            break;
+
+        sprite.m_page   = values[ 0 ];
+        sprite.m_x      = values[ 1 ];
+        sprite.m_y      = values[ 2 ];
+        sprite.m_width  = values[ 3 ];
+        sprite.m_height = values[ 4 ];
+        sprite.m_name.resize( values[ 5 ] );
+
+        const auto &page = m_pages[ sprite.m_page ];
+
+        ok = read( &sprite.m_name[ 0 ], sprite.m_name.size() ) && ( uint64_t ) sprite.m_x + sprite.m_width <= page.m_width && ( uint64_t ) sprite.m_y + sprite.m_height <= page.m_height
+            && !m_lookup.count( sprite.m_name );
+        if( !ok )
+            break;
+
+        update_uvs( sprite );
+
+        m_lookup[ sprite.m_name ] = m_sprites.size();
+        m_sprites.push_back( std::move( sprite ) );
+    }
+
+    std::fclose( file );
+
+    if( !ok )
+        clear();
+
+    return ok;
+}
+
+NOINLINE void SpriteAtlas::clear() {
+    m_images.clear();
+    m_sprites.clear();
+    m_pages.clear();
+    m_lookup.clear();
+}
+
+NOINLINE sprite_id_t SpriteAtlas::find( const std::string &name ) const {
+    const auto it = m_lookup.find( name );
+
+    return it != m_lookup.end() ? it->second : invalid_sprite_id;
+}
+
+NOINLINE void SpriteAtlas::release_pixels() {
+    for( auto &page : m_pages ) {
+        page.m_pixels.clear();
+        page.m_pixels.shrink_to_fit();
+    }
+}
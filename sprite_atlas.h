@@ -0,0 +1,114 @@
+#pragma once
+
+// portable, builds without the windows / d3d headers so the offline packer runs anywhere
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "rect_packer.h"
+
+#ifndef NOINLINE
+    #define NOINLINE
+#endif
+
+#ifndef FORCEINLINE
+    #define FORCEINLINE inline
+#endif
+
+using sprite_id_t = size_t;
+
+// sprite id that doesn't name a sprite
+constexpr sprite_id_t invalid_sprite_id = ~( sprite_id_t ) 0;
+
+//
+// Sprite atlas
+//
+// small images ( icons, markers ) packed into shared pages so they draw from one texture and batch together.
+// images are added by name, packed tallest first, and the result can be saved to a binary atlas file so
+// the packing is done offline ( see sprite_packer.cpp ) and loading is a single read. pixels are packed argb
+// like Color::get, sprite ids are the order images were added in
+//
+class SpriteAtlas {
+public:
+    static constexpr uint32_t magic   = 0x41525053; // "SPRA"
+    static constexpr uint32_t version = 1;
+
+    // page size bounds, 16k is the largest texture a d3d9 device can have
+    static constexpr size_t min_page_size = 16;
+    static constexpr size_t max_page_size = 16384;
+
+    struct Sprite_t {
+        std::string m_name;
+        uint32_t    m_page;            // page index
+        uint32_t    m_x, m_y;          // top left in the page
+        uint32_t    m_width, m_height; // pixel size
+        float       m_u0, m_v0;        // top left uv
+        float       m_u1, m_v1;        // bottom right uv
+    };
+
+    struct Page_t {
+        uint32_t                m_width, m_height;
+        std::vector< uint32_t > m_pixels; // argb rows, dropped once uploaded
+    };
+
+    using sprites_t = std::vector< Sprite_t >;
+    using pages_t   = std::vector< Page_t >;
+
+private:
+    // image waiting for build
+    struct Image_t {
+        std::string             m_name;
+        uint32_t                m_width, m_height;
+        std::vector< uint32_t > m_pixels;
+    };
+
+    std::vector< Image_t >                    m_images;  // added since the last build
+    sprites_t                                 m_sprites; // by sprite id
+    pages_t                                   m_pages;
+    std::unordered_map< std::string, size_t > m_lookup;  // name -> sprite id
+
+    // uvs from the pixel rect
+    NOINLINE void update_uvs( Sprite_t &sprite ) const;
+
+public:
+    // ctor(s)
+    SpriteAtlas() : m_images{}, m_sprites{}, m_pages{}, m_lookup{} {
+
+    }
+
+    // queue image for the next build, argb rows without padding. false if the name is taken
+    NOINLINE bool add_image( const std::string &name, size_t width, size_t height, const uint32_t *pixels );
+
+    // drop the images queued since the last build, their names can be added again
+    NOINLINE void drop_images();
+
+    // pack every queued image into pages of page_size, bigger images get a page of their own.
+    // edges are repeated into the padding so filtering doesn't bleed transparent texels in.
+    // false without packing anything if page_size is out of bounds or an image doesn't fit the largest page
+    NOINLINE bool build( size_t page_size = 1024, size_t padding = 1 );
+
+    // binary atlas file, pages and sprites
+    NOINLINE bool save( const std::string &path ) const;
+
+    NOINLINE bool load( const std::string &path );
+
+    NOINLINE void clear();
+
+    // sprite id by name, invalid_sprite_id if there's none
+    NOINLINE sprite_id_t find( const std::string &name ) const;
+
+    // free page pixels once they're uploaded
+    NOINLINE void release_pixels();
+
+    FORCEINLINE const Sprite_t *get_sprite( sprite_id_t sprite_id ) const {
+        return sprite_id < m_sprites.size() ? &m_sprites[ sprite_id ] : nullptr;
+    }
+
+    FORCEINLINE const sprites_t &get_sprites() const {
+        return m_sprites;
+    }
+
+    FORCEINLINE const pages_t &get_pages() const {
+        return m_pages;
+    }
+};
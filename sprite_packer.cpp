@@ -0,0 +1,109 @@
+// offline sprite atlas packer, writes the binary atlas file read by Renderer::load_sprite_atlas.
+// linux command line tool, doesn't need the renderer or windows headers:
+//
+//   g++ -std=c++17 -O2 sprite_packer.cpp sprite_atlas.cpp -lpng -o sprite_packer
+//   ./sprite_packer [-s page_size] [-p padding] icons.atlas icons/*.png
+//
+// sprites are named after their file without directory and extension
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <png.h>
+#include "sprite_atlas.h"
+
+namespace {
+
+    // decode png to argb rows, any png color type and bit depth
+    NOINLINE bool load_png( const std::string &path, std::vector< uint32_t > &pixels, size_t &width, size_t &height ) {
+        png_image image;
+
+        std::memset( &image, 0, sizeof( image ) );
+        image.version = PNG_IMAGE_VERSION;
+
+        if( !png_image_begin_read_from_file( &image, path.c_str() ) )
+            return false;
+
+        // bgra bytes are argb words on little endian
+        image.format = PNG_FORMAT_BGRA;
+
+        pixels.resize( ( size_t ) image.width * image.height );
+
+        if( !png_image_finish_read( &image, nullptr, pixels.data(), 0, nullptr ) ) {
+            png_image_free( &image );
+            return false;
+        }
+
+        width  = image.width;
+        height = image.height;
+
+        return true;
+    }
+
+    NOINLINE std::string get_sprite_name( const std::string &path ) {
+        const auto slash = path.find_last_of( "/\\" );
+        auto       name  = path.substr( slash == std::string::npos ? 0 : slash + 1 );
+
+        const auto dot = name.rfind( '.' );
+        if( dot != std::string::npos && dot > 0 )
+            name.resize( dot );
+
+        return name;
+    }
+
+    NOINLINE int usage() {
+        std::fprintf( stderr, "usage: sprite_packer [-s page_size] [-p padding] output.atlas image.png...\n" );
+        return 1;
+    }
+
+}
+
+int main( int argc, char **argv ) {
+    SpriteAtlas             atlas;
+    std::vector< uint32_t > pixels;
+    size_t                  page_size, padding, width, height;
+    int                     arg;
+
+    page_size = 1024;
+    padding   = 1;
+
+    for( arg = 1; arg + 1 < argc && argv[ arg ][ 0 ] == '-'; arg += 2 ) {
+        if( !std::strcmp( argv[ arg ], "-s" ) )
+            page_size = std::strtoul( argv[ arg + 1 ], nullptr, 10 );
+
+        else if( !std::strcmp( argv[ arg ], "-p" ) )
+            padding = std::strtoul( argv[ arg + 1 ], nullptr, 10 );
+
+        else
+            return usage();
+    }
+
+    if( argc - arg < 2 || page_size < SpriteAtlas::min_page_size || page_size > SpriteAtlas::max_page_size )
+        return usage();
+
+    const std::string output = argv[ arg++ ];
+
+    for( ; arg < argc; ++arg ) {
+        if( !load_png( argv[ arg ], pixels, width, height ) ) {
+            std::fprintf( stderr, "can't read %s\n", argv[ arg ] );
+            return 1;
+        }
+
+        const auto name = get_sprite_name( argv[ arg ] );
+
+        if( !atlas.add_image( name, width, height, pixels.data() ) ) {
+            std::fprintf( stderr, "duplicate sprite %s ( %s )\n", name.c_str(), argv[ arg ] );
+            return 1;
+        }
+    }
+
+    if( !atlas.build( page_size, padding ) || !atlas.save( output ) ) {
+        std::fprintf( stderr, "can't write %s\n", output.c_str() );
+        return 1;
+    }
+
+    std::printf( "%zu sprites, %zu pages -> %s\n", atlas.get_sprites().size(), atlas.get_pages().size(), output.c_str() );
+
+    return 0;
+}
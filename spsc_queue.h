@@ -0,0 +1,73 @@
+#pragma once
+
+//
+// Bounded single producer / single consumer queue
+//
+// lock-free ring buffer, one thread pushes and one thread pops. head and tail live on separate
+// cache lines so the producer and consumer don't fight over the same line.
+//
+template< typename t > 
+class SpscQueue {
+private:
+    static constexpr size_t cache_line = 64;
+
+    std::unique_ptr< t[] > m_slots;    // ring storage
+    size_t                 m_capacity; // slot count, power of two
+    size_t                 m_mask;     // index mask
+
+    alignas( cache_line ) std::atomic< size_t > m_head; // next slot to pop, written by the consumer
+    alignas( cache_line ) std::atomic< size_t > m_tail; // next slot to push, written by the producer
+
+public:
+    // ctor(s)
+    FORCEINLINE SpscQueue( size_t capacity ) : m_slots{}, m_capacity{ 1 }, m_mask{}, m_head{}, m_tail{} {
+        while( m_capacity < capacity )
+            m_capacity <<= 1;
+
+        m_mask  = m_capacity - 1;
+        m_slots = std::make_unique< t[] >( m_capacity );
+    }
+
+    SpscQueue( const SpscQueue & )            = delete;
+    SpscQueue &operator=( const SpscQueue & ) = delete;
+
+    // producer, returns false if the queue is full
+    FORCEINLINE bool try_push( t &&value ) {
+        const auto tail = m_tail.load( std::memory_order_relaxed );
+
+        if( tail - m_head.load( std::memory_order_acquire ) == m_capacity )
+            return false;
+
+        m_slots[ tail & m_mask ] = std::move( value );
+
+        // publish slot to the consumer
+        m_tail.store( tail + 1, std::memory_order_release );
+
+        return true;
+    }
+
+    // consumer, returns false if the queue is empty
+    FORCEINLINE bool try_pop( t &value ) {
+        const auto head = m_head.load( std::memory_order_relaxed );
+
+        if( head == m_tail.load( std::memory_order_acquire ) )
+            return false;
+
+        value = std::move( m_slots[ head & m_mask ] );
+
+        // hand slot back to the producer
+        m_head.store( head + 1, std::memory_order_release );
+
+        return true;
+    }
+
+    // consumer side check
+    FORCEINLINE bool empty() const {
+        return m_head.load( std::memory_order_relaxed ) == m_tail.load( std::memory_order_acquire );
+    }
+
+    // slot count
+    FORCEINLINE size_t capacity() const {
+        return m_capacity;
+    }
+};
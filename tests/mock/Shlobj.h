@@ -0,0 +1,3 @@
+#pragma once
+
+// stand-in, the renderer sources only reference shell folders on windows
@@ -0,0 +1,3 @@
+#pragma once
+
+// stand-in, see Shlobj.h
@@ -0,0 +1,70 @@
+#pragma once
+
+// stand-in for the windows header so the renderer builds on linux against the mock device.
+// only what the renderer sources reference, file mapping is implemented in mock_device.cpp
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+#define FORCEINLINE   inline
+#define __declspec(x)
+#define __stdcall
+#define CALLBACK
+#define WINAPI
+
+#define MAX_PATH 260
+#define TRUE     1
+#define FALSE    0
+
+#define INVALID_HANDLE_VALUE  ( ( HANDLE ) ( intptr_t ) -1 )
+#define GENERIC_READ          0x80000000L
+#define GENERIC_WRITE         0x40000000L
+#define FILE_SHARE_READ       1
+#define OPEN_EXISTING         3
+#define FILE_ATTRIBUTE_NORMAL 0x80
+#define PAGE_READONLY         2
+#define PAGE_READWRITE        4
+#define FILE_MAP_READ         4
+#define FILE_MAP_ALL_ACCESS   0xF001F
+
+#define E_FAIL ( ( HRESULT ) 0x80004005L )
+
+#define ZeroMemory( p, n ) memset( p, 0, n )
+
+typedef int                BOOL;
+typedef unsigned long      DWORD;
+typedef long               LONG;
+typedef long               HRESULT;
+typedef unsigned int       UINT;
+typedef unsigned char      BYTE;
+typedef unsigned short     WORD;
+typedef float              FLOAT;
+typedef unsigned long long ULONGLONG;
+typedef void               *HANDLE;
+typedef void               *HWND;
+typedef void               *LPVOID;
+typedef const void         *LPCVOID;
+typedef char               *LPSTR;
+typedef const char         *LPCSTR;
+typedef uintptr_t          WPARAM;
+typedef intptr_t           LPARAM;
+typedef intptr_t           LRESULT;
+
+typedef union {
+    struct {
+        DWORD LowPart;
+        LONG  HighPart;
+    };
+    long long QuadPart;
+} LARGE_INTEGER;
+
+typedef struct {
+    LONG left, top, right, bottom;
+} RECT;
+
+HANDLE CreateFileA( LPCSTR name, DWORD access, DWORD share, void *security, DWORD disposition, DWORD flags, HANDLE templ );
+BOOL   GetFileSizeEx( HANDLE file, LARGE_INTEGER *size );
+HANDLE CreateFileMappingA( HANDLE file, void *security, DWORD protect, DWORD size_high, DWORD size_low, LPCSTR name );
+LPVOID MapViewOfFile( HANDLE mapping, DWORD access, DWORD offset_high, DWORD offset_low, size_t size );
+BOOL   UnmapViewOfFile( LPCVOID view );
+BOOL   CloseHandle( HANDLE handle );
@@ -0,0 +1,206 @@
+#pragma once
+
+// stand-in for the d3d9 header, just the part of the api the renderer uses. the interfaces are
+// abstract so MockDevice ( mock_device.h ) can implement them, the layout doesn't match the real com vtables
+#include "Windows.h"
+
+#define D3D_OK                0
+#define D3DERR_DEVICELOST     ( ( HRESULT ) 0x88760868L )
+#define D3DERR_DEVICENOTRESET ( ( HRESULT ) 0x88760869L )
+
+#define D3DFVF_XYZRHW  0x004
+#define D3DFVF_DIFFUSE 0x040
+#define D3DFVF_TEX1    0x100
+
+#define D3DUSAGE_RENDERTARGET 0x001
+#define D3DUSAGE_WRITEONLY    0x008
+#define D3DUSAGE_DYNAMIC      0x200
+
+#define D3DLOCK_READONLY    0x0010
+#define D3DLOCK_NOOVERWRITE 0x1000
+#define D3DLOCK_DISCARD     0x2000
+
+#define D3DCLEAR_TARGET 1
+
+#define D3DCOLOR_ARGB( a, r, g, b ) ( ( DWORD ) ( ( ( a ) << 24 ) | ( ( r ) << 16 ) | ( ( g ) << 8 ) | ( b ) ) )
+#define D3DCOLOR_XRGB( r, g, b )    D3DCOLOR_ARGB( 0xff, r, g, b )
+
+#define D3DCOLORWRITEENABLE_RED   1
+#define D3DCOLORWRITEENABLE_GREEN 2
+#define D3DCOLORWRITEENABLE_BLUE  4
+#define D3DCOLORWRITEENABLE_ALPHA 8
+
+#define D3DSTREAMSOURCE_INDEXEDDATA  ( 1u << 30 )
+#define D3DSTREAMSOURCE_INSTANCEDATA ( 2u << 30 )
+
+#define D3DVS_VERSION( major, minor ) ( 0xFFFE0000 | ( ( major ) << 8 ) | ( minor ) )
+#define D3DPS_VERSION( major, minor ) ( 0xFFFF0000 | ( ( major ) << 8 ) | ( minor ) )
+
+#define D3DDECL_END() { 0xFF, 0, 17, 0, 0, 0 }
+
+enum D3DPRIMITIVETYPE { D3DPT_POINTLIST = 1, D3DPT_LINELIST, D3DPT_LINESTRIP, D3DPT_TRIANGLELIST, D3DPT_TRIANGLESTRIP, D3DPT_TRIANGLEFAN };
+
+enum D3DFORMAT {
+    D3DFMT_UNKNOWN       = 0,
+    D3DFMT_A8R8G8B8      = 21,
+    D3DFMT_X8R8G8B8      = 22,
+    D3DFMT_R5G6B5        = 23,
+    D3DFMT_X1R5G5B5      = 24,
+    D3DFMT_A1R5G5B5      = 25,
+    D3DFMT_A4R4G4B4      = 26,
+    D3DFMT_A8            = 28,
+    D3DFMT_A16B16G16R16  = 36,
+    D3DFMT_P8            = 41,
+    D3DFMT_L8            = 50,
+    D3DFMT_A8L8          = 51,
+    D3DFMT_INDEX16       = 101,
+    D3DFMT_A16B16G16R16F = 113,
+    D3DFMT_A32B32G32R32F = 116,
+    D3DFMT_DXT1          = 0x31545844,
+    D3DFMT_DXT2          = 0x32545844,
+    D3DFMT_DXT3          = 0x33545844,
+    D3DFMT_DXT4          = 0x34545844,
+    D3DFMT_DXT5          = 0x35545844
+};
+
+enum D3DPOOL { D3DPOOL_DEFAULT, D3DPOOL_MANAGED, D3DPOOL_SYSTEMMEM };
+
+enum D3DSTATEBLOCKTYPE { D3DSBT_ALL = 1 };
+
+enum D3DRENDERSTATETYPE {
+    D3DRS_ZENABLE, D3DRS_FILLMODE, D3DRS_SHADEMODE, D3DRS_ZWRITEENABLE, D3DRS_ALPHATESTENABLE, D3DRS_LASTPIXEL, D3DRS_SRCBLEND, D3DRS_DESTBLEND, 
+    D3DRS_CULLMODE, D3DRS_ZFUNC, D3DRS_ALPHAFUNC, D3DRS_DITHERENABLE, D3DRS_ALPHABLENDENABLE, D3DRS_FOGENABLE, D3DRS_SPECULARENABLE, D3DRS_STENCILENABLE, 
+    D3DRS_CLIPPING, D3DRS_LIGHTING, D3DRS_AMBIENT, D3DRS_VERTEXBLEND, D3DRS_CLIPPLANEENABLE, D3DRS_MULTISAMPLEANTIALIAS, D3DRS_INDEXEDVERTEXBLENDENABLE, 
+    D3DRS_COLORWRITEENABLE, D3DRS_BLENDOP, D3DRS_SCISSORTESTENABLE, D3DRS_ANTIALIASEDLINEENABLE, D3DRS_SRGBWRITEENABLE, D3DRS_SEPARATEALPHABLENDENABLE, 
+    D3DRS_SRCBLENDALPHA, D3DRS_DESTBLENDALPHA, D3DRS_BLENDOPALPHA
+};
+
+enum {
+    D3DZB_FALSE = 0, D3DFILL_SOLID = 3, D3DSHADE_GOURAUD = 2, D3DBLEND_ZERO = 1, D3DBLEND_ONE = 2, D3DBLEND_SRCALPHA = 5, D3DBLEND_INVSRCALPHA = 6, 
+    D3DBLEND_INVDESTALPHA = 8, D3DCULL_NONE = 1, D3DCMP_ALWAYS = 8, D3DVBF_DISABLE = 0, D3DBLENDOP_ADD = 1
+};
+
+enum D3DTEXTURESTAGESTATETYPE { D3DTSS_COLOROP = 1, D3DTSS_COLORARG1, D3DTSS_COLORARG2, D3DTSS_ALPHAOP, D3DTSS_ALPHAARG1, D3DTSS_ALPHAARG2, D3DTSS_TEXCOORDINDEX, D3DTSS_TEXTURETRANSFORMFLAGS };
+
+enum { D3DTOP_SELECTARG1 = 2, D3DTOP_SELECTARG2 = 3, D3DTOP_MODULATE = 4, D3DTA_DIFFUSE = 0, D3DTA_CURRENT = 1, D3DTA_TEXTURE = 2, D3DTTFF_DISABLE = 0 };
+
+enum D3DSAMPLERSTATETYPE { D3DSAMP_ADDRESSU = 1, D3DSAMP_ADDRESSV, D3DSAMP_MAGFILTER, D3DSAMP_MINFILTER };
+
+enum { D3DTADDRESS_CLAMP = 3, D3DTEXF_POINT = 1, D3DTEXF_LINEAR = 2 };
+
+enum D3DDECLTYPE { D3DDECLTYPE_FLOAT1 = 0, D3DDECLTYPE_FLOAT2, D3DDECLTYPE_FLOAT3, D3DDECLTYPE_FLOAT4, D3DDECLTYPE_D3DCOLOR, D3DDECLTYPE_UNUSED = 17 };
+
+enum { D3DDECLMETHOD_DEFAULT = 0 };
+
+enum { D3DDECLUSAGE_POSITION = 0, D3DDECLUSAGE_TEXCOORD = 5, D3DDECLUSAGE_COLOR = 10 };
+
+typedef DWORD D3DCOLOR;
+
+typedef struct {
+    WORD Stream;
+    WORD Offset;
+    BYTE Type;
+    BYTE Method;
+    BYTE Usage;
+    BYTE UsageIndex;
+} D3DVERTEXELEMENT9;
+
+typedef struct {
+    DWORD X, Y, Width, Height;
+    float MinZ, MaxZ;
+} D3DVIEWPORT9;
+
+typedef struct {
+    int  Pitch;
+    void *pBits;
+} D3DLOCKED_RECT;
+
+typedef struct {
+    DWORD VertexShaderVersion;
+    DWORD PixelShaderVersion;
+    DWORD MaxTextureWidth, MaxTextureHeight;
+} D3DCAPS9;
+
+typedef struct {
+    D3DFORMAT Format;
+    UINT      Width, Height;
+} D3DSURFACE_DESC;
+
+struct IUnknown {
+    virtual ~IUnknown() = default;
+
+    virtual unsigned long AddRef() = 0;
+    virtual unsigned long Release() = 0;
+};
+
+struct IDirect3DSurface9 : IUnknown {
+    virtual HRESULT LockRect( D3DLOCKED_RECT *locked_rect, const RECT *rect, DWORD flags ) = 0;
+    virtual HRESULT UnlockRect() = 0;
+    virtual HRESULT GetDesc( D3DSURFACE_DESC *desc ) = 0;
+};
+
+struct IDirect3DBaseTexture9 : IUnknown {
+    virtual DWORD GetLevelCount() = 0;
+};
+
+struct IDirect3DTexture9 : IDirect3DBaseTexture9 {
+    virtual HRESULT LockRect( UINT level, D3DLOCKED_RECT *locked_rect, const RECT *rect, DWORD flags ) = 0;
+    virtual HRESULT UnlockRect( UINT level ) = 0;
+    virtual HRESULT GetSurfaceLevel( UINT level, IDirect3DSurface9 **surface ) = 0;
+    virtual HRESULT GetLevelDesc( UINT level, D3DSURFACE_DESC *desc ) = 0;
+};
+
+struct IDirect3DVertexBuffer9 : IUnknown {
+    virtual HRESULT Lock( UINT offset, UINT size, void **data, DWORD flags ) = 0;
+    virtual HRESULT Unlock() = 0;
+};
+
+struct IDirect3DIndexBuffer9 : IUnknown {
+    virtual HRESULT Lock( UINT offset, UINT size, void **data, DWORD flags ) = 0;
+    virtual HRESULT Unlock() = 0;
+};
+
+struct IDirect3DStateBlock9 : IUnknown {
+    virtual HRESULT Capture() = 0;
+    virtual HRESULT Apply() = 0;
+};
+
+struct IDirect3DPixelShader9 : IUnknown {};
+
+struct IDirect3DVertexShader9 : IUnknown {};
+
+struct IDirect3DVertexDeclaration9 : IUnknown {};
+
+struct IDirect3DDevice9 : IUnknown {
+    virtual HRESULT GetViewport( D3DVIEWPORT9 *viewport ) = 0;
+    virtual HRESULT SetViewport( const D3DVIEWPORT9 *viewport ) = 0;
+    virtual HRESULT GetDeviceCaps( D3DCAPS9 *caps ) = 0;
+    virtual HRESULT CreateVertexBuffer( UINT length, DWORD usage, DWORD fvf, D3DPOOL pool, IDirect3DVertexBuffer9 **buffer, HANDLE *shared ) = 0;
+    virtual HRESULT CreateIndexBuffer( UINT length, DWORD usage, D3DFORMAT format, D3DPOOL pool, IDirect3DIndexBuffer9 **buffer, HANDLE *shared ) = 0;
+    virtual HRESULT CreateStateBlock( D3DSTATEBLOCKTYPE type, IDirect3DStateBlock9 **state_block ) = 0;
+    virtual HRESULT CreateTexture( UINT width, UINT height, UINT levels, DWORD usage, D3DFORMAT format, D3DPOOL pool, IDirect3DTexture9 **texture, HANDLE *shared ) = 0;
+    virtual HRESULT CreatePixelShader( const DWORD *function, IDirect3DPixelShader9 **shader ) = 0;
+    virtual HRESULT CreateVertexShader( const DWORD *function, IDirect3DVertexShader9 **shader ) = 0;
+    virtual HRESULT CreateVertexDeclaration( const D3DVERTEXELEMENT9 *elements, IDirect3DVertexDeclaration9 **declaration ) = 0;
+    virtual HRESULT SetFVF( DWORD fvf ) = 0;
+    virtual HRESULT SetStreamSource( UINT stream, IDirect3DVertexBuffer9 *buffer, UINT offset, UINT stride ) = 0;
+    virtual HRESULT SetStreamSourceFreq( UINT stream, UINT setting ) = 0;
+    virtual HRESULT SetIndices( IDirect3DIndexBuffer9 *indices ) = 0;
+    virtual HRESULT SetVertexShader( IDirect3DVertexShader9 *shader ) = 0;
+    virtual HRESULT SetPixelShader( IDirect3DPixelShader9 *shader ) = 0;
+    virtual HRESULT SetVertexDeclaration( IDirect3DVertexDeclaration9 *declaration ) = 0;
+    virtual HRESULT SetVertexShaderConstantF( UINT start, const float *data, UINT count ) = 0;
+    virtual HRESULT SetPixelShaderConstantF( UINT start, const float *data, UINT count ) = 0;
+    virtual HRESULT SetTexture( DWORD stage, IDirect3DBaseTexture9 *texture ) = 0;
+    virtual HRESULT SetRenderState( D3DRENDERSTATETYPE state, DWORD value ) = 0;
+    virtual HRESULT SetTextureStageState( DWORD stage, D3DTEXTURESTAGESTATETYPE type, DWORD value ) = 0;
+    virtual HRESULT SetSamplerState( DWORD sampler, D3DSAMPLERSTATETYPE type, DWORD value ) = 0;
+    virtual HRESULT GetRenderTarget( DWORD index, IDirect3DSurface9 **surface ) = 0;
+    virtual HRESULT SetRenderTarget( DWORD index, IDirect3DSurface9 *surface ) = 0;
+    virtual HRESULT Clear( DWORD count, const void *rects, DWORD flags, D3DCOLOR color, float z, DWORD stencil ) = 0;
+    virtual HRESULT DrawPrimitive( D3DPRIMITIVETYPE type, UINT start_vertex, UINT primitive_count ) = 0;
+    virtual HRESULT DrawIndexedPrimitive( D3DPRIMITIVETYPE type, int base_vertex, UINT min_index, UINT vertex_count, UINT start_index, UINT primitive_count ) = 0;
+};
+
+// d3d9_wrapper.h names the d3d object, the mock never creates one
+struct IDirect3D9 : IUnknown {};
@@ -0,0 +1,29 @@
+#pragma once
+
+// stand-in for the d3dx9 header, see mock_device.cpp for what the functions do
+#include "d3d9.h"
+
+#define D3DX_DEFAULT         ( ( UINT ) -1 )
+#define D3DX_DEFAULT_NONPOW2 ( ( UINT ) -2 )
+#define D3DX_FILTER_NONE     1
+
+struct ID3DXBuffer : IUnknown {
+    virtual void  *GetBufferPointer() = 0;
+    virtual DWORD GetBufferSize() = 0;
+};
+
+typedef ID3DXBuffer *LPD3DXBUFFER;
+typedef void        *LPD3DXCONSTANTTABLE;
+
+typedef struct {
+    UINT      Width, Height, Depth, MipLevels;
+    D3DFORMAT Format;
+} D3DXIMAGE_INFO;
+
+HRESULT D3DXCompileShader( LPCSTR source, UINT length, const void *defines, void *include, LPCSTR function, LPCSTR profile, DWORD flags, 
+    LPD3DXBUFFER *shader, LPD3DXBUFFER *errors, LPD3DXCONSTANTTABLE *constants );
+
+HRESULT D3DXCreateTexture( IDirect3DDevice9 *device, UINT width, UINT height, UINT levels, DWORD usage, D3DFORMAT format, D3DPOOL pool, IDirect3DTexture9 **texture );
+
+HRESULT D3DXCreateTextureFromFileExA( IDirect3DDevice9 *device, LPCSTR path, UINT width, UINT height, UINT levels, DWORD usage, D3DFORMAT format, D3DPOOL pool, 
+    DWORD filter, DWORD mip_filter, D3DCOLOR color_key, D3DXIMAGE_INFO *info, void *palette, IDirect3DTexture9 **texture );
@@ -0,0 +1,462 @@
+#include <string>
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "mock_device.h"
+#include "d3dx9.h"
+
+namespace {
+
+    // surface of a texture level or the back buffer, nothing reads it
+    class MockSurface : public MockObject< IDirect3DSurface9 > {
+    private:
+        UINT      m_width, m_height;
+        D3DFORMAT m_format;
+
+    public:
+        MockSurface( UINT width, UINT height, D3DFORMAT format ) : m_width{ width }, m_height{ height }, m_format{ format } {
+
+        }
+
+        HRESULT LockRect( D3DLOCKED_RECT *, const RECT *, DWORD ) override {
+            return E_FAIL;
+        }
+
+        HRESULT UnlockRect() override {
+            return D3D_OK;
+        }
+
+        HRESULT GetDesc( D3DSURFACE_DESC *desc ) override {
+            desc->Format = m_format;
+            desc->Width  = m_width;
+            desc->Height = m_height;
+
+            return D3D_OK;
+        }
+    };
+
+    class MockStateBlock : public MockObject< IDirect3DStateBlock9 > {
+    public:
+        HRESULT Capture() override {
+            return D3D_OK;
+        }
+
+        HRESULT Apply() override {
+            return D3D_OK;
+        }
+    };
+
+    class MockPixelShader : public MockObject< IDirect3DPixelShader9 > {};
+
+    class MockVertexShader : public MockObject< IDirect3DVertexShader9 > {};
+
+    class MockVertexDeclaration : public MockObject< IDirect3DVertexDeclaration9 > {};
+
+    // compiled shader, a version token and the end token
+    class MockShaderBuffer : public MockObject< ID3DXBuffer > {
+    private:
+        DWORD m_tokens[ 2 ];
+
+    public:
+        MockShaderBuffer( DWORD version ) : m_tokens{ version, 0x0000FFFF } {
+
+        }
+
+        void *GetBufferPointer() override {
+            return m_tokens;
+        }
+
+        DWORD GetBufferSize() override {
+            return sizeof( m_tokens );
+        }
+    };
+
+    // win32 file and mapping handles on top of posix
+    struct MockHandle_t {
+        int    m_fd;
+        size_t m_size;
+    };
+
+    std::mutex                                m_views_mutex;
+    std::unordered_map< const void *, size_t > m_views; // mapped view -> size, for munmap
+
+}
+
+//
+// MockTexture
+//
+
+MockTexture::MockTexture( MockDevice *device, UINT width, UINT height, D3DFORMAT format, D3DPOOL pool ) : m_device{ device }, m_width{ width }, m_height{ height }, 
+    m_format{ format }, m_pool{ pool }, m_pitch{}, m_pixels{} {
+    m_pitch = ( int ) ( ( width * get_bytes_per_pixel( format ) + 63 ) & ~( size_t ) 63 );
+    m_pixels.resize( ( size_t ) m_pitch * height );
+
+    m_device->m_stats.m_textures++;
+}
+
+MockTexture::~MockTexture() {
+    m_device->m_stats.m_textures--;
+}
+
+DWORD MockTexture::GetLevelCount() {
+    return 1;
+}
+
+HRESULT MockTexture::LockRect( UINT level, D3DLOCKED_RECT *locked_rect, const RECT *rect, DWORD flags ) {
+    ( void ) flags;
+
+    if( level || !locked_rect )
+        return E_FAIL;
+
+    size_t offset = 0;
+    if( rect )
+        offset = ( size_t ) rect->top * m_pitch + ( size_t ) rect->left * get_bytes_per_pixel( m_format );
+
+    locked_rect->Pitch = m_pitch;
+    locked_rect->pBits = m_pixels.data() + offset;
+
+    m_device->m_stats.m_texture_locks++;
+
+    return D3D_OK;
+}
+
+HRESULT MockTexture::UnlockRect( UINT level ) {
+    return level ? E_FAIL : D3D_OK;
+}
+
+HRESULT MockTexture::GetSurfaceLevel( UINT level, IDirect3DSurface9 **surface ) {
+    if( level )
+        return E_FAIL;
+
+    *surface = new MockSurface( m_width, m_height, m_format );
+
+    return D3D_OK;
+}
+
+HRESULT MockTexture::GetLevelDesc( UINT level, D3DSURFACE_DESC *desc ) {
+    if( level )
+        return E_FAIL;
+
+    desc->Format = m_format;
+    desc->Width  = m_width;
+    desc->Height = m_height;
+
+    return D3D_OK;
+}
+
+size_t MockTexture::get_bytes_per_pixel( D3DFORMAT format ) {
+    switch( format ) {
+        case D3DFMT_A8:
+        case D3DFMT_L8:
+        case D3DFMT_P8:
+            return 1;
+
+        case D3DFMT_A8L8:
+        case D3DFMT_R5G6B5:
+        case D3DFMT_X1R5G5B5:
+        case D3DFMT_A1R5G5B5:
+        case D3DFMT_A4R4G4B4:
+            return 2;
+
+        case D3DFMT_A16B16G16R16:
+        case D3DFMT_A16B16G16R16F:
+            return 8;
+
+        case D3DFMT_A32B32G32R32F:
+            return 16;
+
+        default:
+            return 4;
+    }
+}
+
+//
+// MockBuffer
+//
+
+template< typename base_t > 
+HRESULT MockBuffer< base_t >::Lock( UINT offset, UINT size, void **data, DWORD flags ) {
+    ( void ) flags;
+
+    // zero size locks the whole buffer
+    if( !size )
+        size = ( UINT ) ( m_data.size() - offset );
+
+    if( ( size_t ) offset + size > m_data.size() )
+        return E_FAIL;
+
+    *data = m_data.data() + offset;
+
+    m_device->m_stats.m_buffer_locks++;
+    m_device->m_stats.m_buffer_bytes += size;
+
+    return D3D_OK;
+}
+
+template class MockBuffer< IDirect3DVertexBuffer9 >;
+template class MockBuffer< IDirect3DIndexBuffer9 >;
+
+//
+// MockDevice
+//
+
+MockDevice::MockDevice( DWORD width, DWORD height, DWORD shader_model ) : m_viewport{ 0, 0, width, height, 0.f, 1.f }, m_shader_model{ shader_model }, m_stats{}, 
+    m_instance_stream{ nullptr }, m_instance_offset{}, m_instance_stride{}, m_instance_count{}, m_instances{} {
+
+}
+
+HRESULT MockDevice::GetViewport( D3DVIEWPORT9 *viewport ) {
+    *viewport = m_viewport;
+    return D3D_OK;
+}
+
+HRESULT MockDevice::SetViewport( const D3DVIEWPORT9 *viewport ) {
+    m_viewport = *viewport;
+    return D3D_OK;
+}
+
+HRESULT MockDevice::GetDeviceCaps( D3DCAPS9 *caps ) {
+    caps->VertexShaderVersion = D3DVS_VERSION( m_shader_model, 0 );
+    caps->PixelShaderVersion  = D3DPS_VERSION( m_shader_model, 0 );
+    caps->MaxTextureWidth     = 8192;
+    caps->MaxTextureHeight    = 8192;
+
+    return D3D_OK;
+}
+
+HRESULT MockDevice::CreateVertexBuffer( UINT length, DWORD usage, DWORD fvf, D3DPOOL pool, IDirect3DVertexBuffer9 **buffer, HANDLE *shared ) {
+    ( void ) usage, ( void ) fvf, ( void ) pool, ( void ) shared;
+
+    *buffer = new MockBuffer< IDirect3DVertexBuffer9 >( this, length );
+    return D3D_OK;
+}
+
+HRESULT MockDevice::CreateIndexBuffer( UINT length, DWORD usage, D3DFORMAT format, D3DPOOL pool, IDirect3DIndexBuffer9 **buffer, HANDLE *shared ) {
+    ( void ) usage, ( void ) format, ( void ) pool, ( void ) shared;
+
+    *buffer = new MockBuffer< IDirect3DIndexBuffer9 >( this, length );
+    return D3D_OK;
+}
+
+HRESULT MockDevice::CreateStateBlock( D3DSTATEBLOCKTYPE type, IDirect3DStateBlock9 **state_block ) {
+    ( void ) type;
+
+    *state_block = new MockStateBlock();
+    return D3D_OK;
+}
+
+HRESULT MockDevice::CreateTexture( UINT width, UINT height, UINT levels, DWORD usage, D3DFORMAT format, D3DPOOL pool, IDirect3DTexture9 **texture, HANDLE *shared ) {
+    ( void ) levels, ( void ) usage, ( void ) shared;
+
+    if( !width || !height || width > 8192 || height > 8192 )
+        return E_FAIL;
+
+    *texture = new MockTexture( this, width, height, format, pool );
+    return D3D_OK;
+}
+
+HRESULT MockDevice::CreatePixelShader( const DWORD *function, IDirect3DPixelShader9 **shader ) {
+    if( !function )
+        return E_FAIL;
+
+    *shader = new MockPixelShader();
+    return D3D_OK;
+}
+
+HRESULT MockDevice::CreateVertexShader( const DWORD *function, IDirect3DVertexShader9 **shader ) {
+    if( !function )
+        return E_FAIL;
+
+    *shader = new MockVertexShader();
+    return D3D_OK;
+}
+
+HRESULT MockDevice::CreateVertexDeclaration( const D3DVERTEXELEMENT9 *elements, IDirect3DVertexDeclaration9 **declaration ) {
+    if( !elements )
+        return E_FAIL;
+
+    *declaration = new MockVertexDeclaration();
+    return D3D_OK;
+}
+
+HRESULT MockDevice::GetRenderTarget( DWORD index, IDirect3DSurface9 **surface ) {
+    if( index )
+        return E_FAIL;
+
+    *surface = new MockSurface( m_viewport.Width, m_viewport.Height, D3DFMT_X8R8G8B8 );
+    return D3D_OK;
+}
+
+HRESULT MockDevice::DrawPrimitive( D3DPRIMITIVETYPE type, UINT start_vertex, UINT primitive_count ) {
+    ( void ) type, ( void ) start_vertex;
+
+    m_stats.m_draw_calls++;
+    m_stats.m_primitives += primitive_count;
+
+    return D3D_OK;
+}
+
+HRESULT MockDevice::DrawIndexedPrimitive( D3DPRIMITIVETYPE type, int base_vertex, UINT min_index, UINT vertex_count, UINT start_index, UINT primitive_count ) {
+    ( void ) type, ( void ) base_vertex, ( void ) min_index, ( void ) vertex_count, ( void ) start_index;
+
+    m_stats.m_draw_calls++;
+    m_stats.m_primitives += primitive_count;
+
+    // keep what the instance stream points at, the renderer refills the buffer every frame
+    if( m_instance_count && m_instance_stream ) {
+        const auto buffer = static_cast< MockBuffer< IDirect3DVertexBuffer9 > * >( m_instance_stream );
+        const auto begin  = buffer->get_data() + m_instance_offset;
+        const auto size   = ( size_t ) m_instance_count * m_instance_stride;
+
+        if( m_instance_offset + size > buffer->get_size() )
+            return E_FAIL;
+
+        m_instances.insert( m_instances.end(), begin, begin + size );
+    }
+
+    return D3D_OK;
+}
+
+HRESULT MockDevice::SetStreamSource( UINT stream, IDirect3DVertexBuffer9 *buffer, UINT offset, UINT stride ) {
+    if( stream == 1 ) {
+        m_instance_stream = buffer;
+        m_instance_offset = offset;
+        m_instance_stride = stride;
+    }
+
+    return D3D_OK;
+}
+
+HRESULT MockDevice::SetStreamSourceFreq( UINT stream, UINT setting ) {
+    if( !stream )
+        m_instance_count = ( setting & D3DSTREAMSOURCE_INDEXEDDATA ) ? ( setting & ~D3DSTREAMSOURCE_INDEXEDDATA ) : 0;
+
+    return D3D_OK;
+}
+
+//
+// d3dx
+//
+
+HRESULT D3DXCompileShader( LPCSTR source, UINT length, const void *defines, void *include, LPCSTR function, LPCSTR profile, DWORD flags, 
+    LPD3DXBUFFER *shader, LPD3DXBUFFER *errors, LPD3DXCONSTANTTABLE *constants ) {
+    ( void ) defines, ( void ) include, ( void ) function, ( void ) flags;
+
+    if( errors )
+        *errors = nullptr;
+
+    if( constants )
+        *constants = nullptr;
+
+    if( !source || !length || !profile || !shader )
+        return E_FAIL;
+
+    // "vs_3_0" / "ps_2_0"
+    const std::string target = profile;
+    if( target.size() != 6 || ( target[ 0 ] != 'v' && target[ 0 ] != 'p' ) )
+        return E_FAIL;
+
+    const auto major = ( DWORD ) ( target[ 3 ] - '0' );
+    const auto minor = ( DWORD ) ( target[ 5 ] - '0' );
+
+    *shader = new MockShaderBuffer( target[ 0 ] == 'v' ? D3DVS_VERSION( major, minor ) : D3DPS_VERSION( major, minor ) );
+
+    return D3D_OK;
+}
+
+// zero sizes are taken as 1 like d3dx does
+HRESULT D3DXCreateTexture( IDirect3DDevice9 *device, UINT width, UINT height, UINT levels, DWORD usage, D3DFORMAT format, D3DPOOL pool, IDirect3DTexture9 **texture ) {
+    return device->CreateTexture( std::max( width, 1u ), std::max( height, 1u ), levels, usage, format, pool, texture, nullptr );
+}
+
+// no image decoding in the mock, loading textures from files fails
+HRESULT D3DXCreateTextureFromFileExA( IDirect3DDevice9 *device, LPCSTR path, UINT width, UINT height, UINT levels, DWORD usage, D3DFORMAT format, D3DPOOL pool, 
+    DWORD filter, DWORD mip_filter, D3DCOLOR color_key, D3DXIMAGE_INFO *info, void *palette, IDirect3DTexture9 **texture ) {
+    ( void ) device, ( void ) path, ( void ) width, ( void ) height, ( void ) levels, ( void ) usage, ( void ) format, ( void ) pool;
+    ( void ) filter, ( void ) mip_filter, ( void ) color_key, ( void ) info, ( void ) palette, ( void ) texture;
+
+    return E_FAIL;
+}
+
+//
+// win32 file mapping, read only as FontManager uses it
+//
+
+HANDLE CreateFileA( LPCSTR name, DWORD access, DWORD share, void *security, DWORD disposition, DWORD flags, HANDLE templ ) {
+    struct stat info;
+
+    ( void ) access, ( void ) share, ( void ) security, ( void ) disposition, ( void ) flags, ( void ) templ;
+
+    const auto fd = open( name, O_RDONLY );
+    if( fd < 0 )
+        return INVALID_HANDLE_VALUE;
+
+    if( fstat( fd, &info ) != 0 ) {
+        close( fd );
+        return INVALID_HANDLE_VALUE;
+    }
+
+    return new MockHandle_t{ fd, ( size_t ) info.st_size };
+}
+
+BOOL GetFileSizeEx( HANDLE file, LARGE_INTEGER *size ) {
+    size->QuadPart = ( long long ) static_cast< MockHandle_t * >( file )->m_size;
+    return TRUE;
+}
+
+HANDLE CreateFileMappingA( HANDLE file, void *security, DWORD protect, DWORD size_high, DWORD size_low, LPCSTR name ) {
+    ( void ) security, ( void ) protect, ( void ) size_high, ( void ) size_low, ( void ) name;
+
+    const auto handle = static_cast< MockHandle_t * >( file );
+
+    // the mapping owns a duplicate so the file handle can be closed first
+    return new MockHandle_t{ dup( handle->m_fd ), handle->m_size };
+}
+
+LPVOID MapViewOfFile( HANDLE mapping, DWORD access, DWORD offset_high, DWORD offset_low, size_t size ) {
+    ( void ) access, ( void ) offset_high, ( void ) offset_low;
+
+    const auto handle = static_cast< MockHandle_t * >( mapping );
+
+    if( !size )
+        size = handle->m_size;
+
+    const auto view = mmap( nullptr, size, PROT_READ, MAP_PRIVATE, handle->m_fd, 0 );
+    if( view == MAP_FAILED )
+        return nullptr;
+
+    std::lock_guard< std::mutex > lock( m_views_mutex );
+    m_views[ view ] = size;
+
+    return view;
+}
+
+BOOL UnmapViewOfFile( LPCVOID view ) {
+    size_t size;
+
+    {
+        std::lock_guard< std::mutex > lock( m_views_mutex );
+
+        const auto it = m_views.find( view );
+        if( it == m_views.end() )
+            return FALSE;
+
+        size = it->second;
+        m_views.erase( it );
+    }
+
+    return munmap( const_cast< void * >( view ), size ) == 0;
+}
+
+BOOL CloseHandle( HANDLE handle ) {
+    const auto mock_handle = static_cast< MockHandle_t * >( handle );
+
+    close( mock_handle->m_fd );
+    delete mock_handle;
+
+    return TRUE;
+}
@@ -0,0 +1,214 @@
+#pragma once
+
+// mock d3d9 device for the linux tests and benchmarks. resources are plain memory, draws are only counted,
+// so everything the renderer does up to the device boundary runs and can be measured
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "d3d9.h"
+
+//
+// Calls and bytes that reached the device
+//
+struct MockDeviceStats_t {
+    uint64_t m_draw_calls;    // DrawPrimitive / DrawIndexedPrimitive
+    uint64_t m_primitives;    // primitives drawn
+    uint64_t m_buffer_locks;  // vertex / index buffer locks
+    uint64_t m_buffer_bytes;  // bytes locked for writing in vertex / index buffers
+    uint64_t m_texture_locks; // texture level locks
+    uint64_t m_textures;      // textures alive
+
+    // ctor(s)
+    MockDeviceStats_t() : m_draw_calls{}, m_primitives{}, m_buffer_locks{}, m_buffer_bytes{}, m_texture_locks{}, m_textures{} {
+
+    }
+};
+
+//
+// Ref counted base of every mock resource
+//
+template< typename base_t > 
+class MockObject : public base_t {
+private:
+    std::atomic< unsigned long > m_refs;
+
+public:
+    // ctor(s)
+    MockObject() : m_refs{ 1 } {
+
+    }
+
+    unsigned long AddRef() override {
+        return ++m_refs;
+    }
+
+    unsigned long Release() override {
+        const auto refs = --m_refs;
+        if( !refs )
+            delete this;
+
+        return refs;
+    }
+};
+
+class MockDevice;
+
+//
+// Single level texture backed by memory. rows are padded to 64 bytes so pitch handling is exercised
+//
+class MockTexture : public MockObject< IDirect3DTexture9 > {
+private:
+    MockDevice             *m_device;
+    UINT                   m_width, m_height;
+    D3DFORMAT              m_format;
+    D3DPOOL                m_pool;
+    int                    m_pitch;
+    std::vector< uint8_t > m_pixels;
+
+public:
+    // ctor(s)
+    MockTexture( MockDevice *device, UINT width, UINT height, D3DFORMAT format, D3DPOOL pool );
+
+    // dtor
+    ~MockTexture() override;
+
+    DWORD   GetLevelCount() override;
+    HRESULT LockRect( UINT level, D3DLOCKED_RECT *locked_rect, const RECT *rect, DWORD flags ) override;
+    HRESULT UnlockRect( UINT level ) override;
+    HRESULT GetSurfaceLevel( UINT level, IDirect3DSurface9 **surface ) override;
+    HRESULT GetLevelDesc( UINT level, D3DSURFACE_DESC *desc ) override;
+
+    // bytes per pixel of uncompressed formats the renderer creates
+    static size_t get_bytes_per_pixel( D3DFORMAT format );
+
+    const uint8_t *get_row( size_t row ) const {
+        return &m_pixels[ row * m_pitch ];
+    }
+
+    D3DPOOL get_pool() const {
+        return m_pool;
+    }
+};
+
+//
+// Vertex or index buffer backed by memory
+//
+template< typename base_t > 
+class MockBuffer : public MockObject< base_t > {
+private:
+    MockDevice             *m_device;
+    std::vector< uint8_t > m_data;
+
+public:
+    // ctor(s)
+    MockBuffer( MockDevice *device, UINT length ) : m_device{ device }, m_data( length ) {
+
+    }
+
+    HRESULT Lock( UINT offset, UINT size, void **data, DWORD flags ) override;
+
+    HRESULT Unlock() override {
+        return D3D_OK;
+    }
+
+    const uint8_t *get_data() const {
+        return m_data.data();
+    }
+
+    size_t get_size() const {
+        return m_data.size();
+    }
+};
+
+//
+// Mock device, a viewport and caps of the chosen shader model
+//
+class MockDevice : public MockObject< IDirect3DDevice9 > {
+private:
+    D3DVIEWPORT9           m_viewport;
+    DWORD                  m_shader_model;
+    MockDeviceStats_t      m_stats;
+    IDirect3DVertexBuffer9 *m_instance_stream; // stream 1, instances of indexed draws
+    UINT                   m_instance_offset, m_instance_stride;
+    UINT                   m_instance_count;  // D3DSTREAMSOURCE_INDEXEDDATA count of stream 0, 0 when not instancing
+    std::vector< uint8_t > m_instances;       // instances of every instanced draw, copied as the device read them
+
+    friend class MockTexture;
+    template< typename base_t > friend class MockBuffer;
+
+public:
+    // ctor(s), shader model 2 devices don't get the instanced path
+    MockDevice( DWORD width, DWORD height, DWORD shader_model = 3 );
+
+    const MockDeviceStats_t &get_stats() const {
+        return m_stats;
+    }
+
+    // drawn since the last reset_stats, sizeof( Instance_t ) bytes each
+    const std::vector< uint8_t > &get_instances() const {
+        return m_instances;
+    }
+
+    void reset_stats() {
+        const auto textures = m_stats.m_textures;
+
+        m_stats            = {};
+        m_stats.m_textures = textures;
+
+        m_instances.clear();
+    }
+
+    HRESULT GetViewport( D3DVIEWPORT9 *viewport ) override;
+    HRESULT SetViewport( const D3DVIEWPORT9 *viewport ) override;
+    HRESULT GetDeviceCaps( D3DCAPS9 *caps ) override;
+    HRESULT CreateVertexBuffer( UINT length, DWORD usage, DWORD fvf, D3DPOOL pool, IDirect3DVertexBuffer9 **buffer, HANDLE *shared ) override;
+    HRESULT CreateIndexBuffer( UINT length, DWORD usage, D3DFORMAT format, D3DPOOL pool, IDirect3DIndexBuffer9 **buffer, HANDLE *shared ) override;
+    HRESULT CreateStateBlock( D3DSTATEBLOCKTYPE type, IDirect3DStateBlock9 **state_block ) override;
+    HRESULT CreateTexture( UINT width, UINT height, UINT levels, DWORD usage, D3DFORMAT format, D3DPOOL pool, IDirect3DTexture9 **texture, HANDLE *shared ) override;
+    HRESULT CreatePixelShader( const DWORD *function, IDirect3DPixelShader9 **shader ) override;
+    HRESULT CreateVertexShader( const DWORD *function, IDirect3DVertexShader9 **shader ) override;
+    HRESULT CreateVertexDeclaration( const D3DVERTEXELEMENT9 *elements, IDirect3DVertexDeclaration9 **declaration ) override;
+    HRESULT GetRenderTarget( DWORD index, IDirect3DSurface9 **surface ) override;
+    HRESULT DrawPrimitive( D3DPRIMITIVETYPE type, UINT start_vertex, UINT primitive_count ) override;
+    HRESULT DrawIndexedPrimitive( D3DPRIMITIVETYPE type, int base_vertex, UINT min_index, UINT vertex_count, UINT start_index, UINT primitive_count ) override;
+    HRESULT SetStreamSource( UINT stream, IDirect3DVertexBuffer9 *buffer, UINT offset, UINT stride ) override;
+    HRESULT SetStreamSourceFreq( UINT stream, UINT setting ) override;
+
+    // state is accepted and dropped
+    HRESULT SetFVF( DWORD ) override { return D3D_OK; }
+    HRESULT SetIndices( IDirect3DIndexBuffer9 * ) override { return D3D_OK; }
+    HRESULT SetVertexShader( IDirect3DVertexShader9 * ) override { return D3D_OK; }
+    HRESULT SetPixelShader( IDirect3DPixelShader9 * ) override { return D3D_OK; }
+    HRESULT SetVertexDeclaration( IDirect3DVertexDeclaration9 * ) override { return D3D_OK; }
+    HRESULT SetVertexShaderConstantF( UINT, const float *, UINT ) override { return D3D_OK; }
+    HRESULT SetPixelShaderConstantF( UINT, const float *, UINT ) override { return D3D_OK; }
+    HRESULT SetTexture( DWORD, IDirect3DBaseTexture9 * ) override { return D3D_OK; }
+    HRESULT SetRenderState( D3DRENDERSTATETYPE, DWORD ) override { return D3D_OK; }
+    HRESULT SetTextureStageState( DWORD, D3DTEXTURESTAGESTATETYPE, DWORD ) override { return D3D_OK; }
+    HRESULT SetSamplerState( DWORD, D3DSAMPLERSTATETYPE, DWORD ) override { return D3D_OK; }
+    HRESULT SetRenderTarget( DWORD, IDirect3DSurface9 * ) override { return D3D_OK; }
+    HRESULT Clear( DWORD, const void *, DWORD, D3DCOLOR, float, DWORD ) override { return D3D_OK; }
+};
+
+#include "includes.h"
+
+//
+// Mock device with a renderer initialized on it, the setup of the renderer tests
+//
+struct MockRenderer_t {
+    struct Release_t {
+        void operator()( MockDevice *device ) const {
+            device->Release();
+        }
+    };
+
+    std::unique_ptr< MockDevice, Release_t > m_device;   // declared first, released after the renderer like a real device
+    Renderer                                 m_renderer;
+    bool                                     m_ready;    // init succeeded
+
+    // ctor(s), worker_count 0 uses one less than the core count
+    MockRenderer_t( DWORD shader_model = 3, size_t worker_count = 0 ) : m_device{ new MockDevice( 1920, 1080, shader_model ) }, m_renderer{}, 
+        m_ready{ m_renderer.init( m_device.get(), 4096, worker_count ) } {
+
+    }
+};
@@ -0,0 +1,755 @@
+// renderer benchmarks on the mock device, every draw_* primitive and flush at 1k, 10k and 100k primitives.
+// results are written as json so runs can be diffed across versions:
+//
+//   renderer_bench [--quick] [--font path.ttf] [--out results.json]
+//
+// submit is the time spent in draw calls, render the time spent in Renderer::render ( upload and flush ).
+// font_init_scaling times Font::init with 1 thread up to the core count, the parallel glyph rasterization.
+// glyph_conversion times turning a whole charset of rendered glyphs into 8 bit coverage, the FT_Bitmap_Convert
+// path Font::init used to take against GlyphBitmap
+#include "includes.h"
+#include "mock_device.h"
+
+namespace {
+
+    struct BenchResult_t {
+        std::string m_name;
+        std::string m_per_call;      // per primitive case this batched one replaces, empty otherwise
+        size_t      m_count;         // primitives per frame
+        size_t      m_frames;        // frames measured
+        double      m_submit_ns;     // per frame
+        double      m_render_ns;     // per frame
+        double      m_flush_ns;      // per frame, flush only
+        double      m_submissions;   // per frame
+        double      m_vertices;      // per frame
+        double      m_instances;     // per frame
+        double      m_draw_calls;    // per frame, as seen by the device
+    };
+
+    struct ScalingResult_t {
+        size_t m_size;    // font size
+        bool   m_sdf;     // distance field glyphs
+        size_t m_threads; // rasterizing threads, the caller included
+        size_t m_glyphs;  // glyphs in the font
+        double m_init_ms; // best Font::init time
+    };
+
+    struct ConversionResult_t {
+        size_t m_size;        // font size
+        bool   m_mono;        // 1 bit glyphs, 8 bit gray otherwise
+        size_t m_glyphs;      // glyphs in the charset
+        double m_convert_us;  // best pass through FT_Bitmap_New / FT_Bitmap_Convert / FT_Bitmap_Done
+        double m_coverage_us; // best pass through GlyphBitmap::to_coverage
+        bool   m_identical;   // both produced the same coverage
+    };
+
+    using submit_t = std::function< void( Renderer &renderer, size_t count ) >;
+
+    struct BenchCase_t {
+        std::string           m_name;
+        submit_t              m_submit;
+        std::vector< size_t > m_counts{};   // run at these counts instead of the default ones
+        std::string           m_per_call{}; // batched cases, the per primitive case drawing the same thing
+    };
+
+    struct BenchOptions_t {
+        bool                  m_quick;
+        std::vector< size_t > m_counts;
+        size_t                m_min_frames;
+        size_t                m_max_frames;
+        std::string           m_font;
+        std::string           m_out;
+    };
+
+    // fixed pseudo random scene, the same every run
+    struct BenchScene_t {
+        std::vector< Vec2_t >      m_points;
+        std::vector< Color >       m_colors;
+        std::vector< float >       m_radii; // mixed, mostly small blips with a few large rings
+        std::vector< std::string > m_strings[ 3 ];
+
+        // the same primitives as arrays for the batched calls, up to the largest count
+        std::vector< FilledRect_t >  m_rects;
+        std::vector< LineSegment_t > m_lines;
+        std::vector< Circle_t >      m_circles;
+        std::vector< Vec2_t >        m_path; // point( 0 ), point( 1 ) .. connected
+
+        NOINLINE void init() {
+            uint32_t seed = 0x12345678;
+
+            const auto next = [ & ]() {
+                seed = seed * 1664525u + 1013904223u;
+                return seed >> 8;
+            };
+
+            m_points.resize( 4096 );
+            m_colors.resize( 4096 );
+
+            for( size_t i = 0; i < m_points.size(); ++i ) {
+                m_points[ i ] = { ( float ) ( next() % 1900 ), ( float ) ( next() % 1060 ) };
+                m_colors[ i ] = Color::from_argb( 0xff000000 | next() );
+            }
+
+            m_radii.resize( 4096 );
+
+            for( auto &radius : m_radii ) {
+                const auto kind = next() % 100;
+
+                if( kind < 70 )
+                    radius = 2.f + ( float ) ( next() % 7 );
+                else if( kind < 95 )
+                    radius = 10.f + ( float ) ( next() % 51 );
+                else
+                    radius = 100.f + ( float ) ( next() % 301 );
+            }
+
+            // 8, 32 and 128 characters, words of about 6 letters so boxes can wrap
+            const size_t lengths[ 3 ] = { 8, 32, 128 };
+
+            for( size_t i = 0; i < 3; ++i ) {
+                for( size_t j = 0; j < 64; ++j ) {
+                    std::string str( lengths[ i ], ' ' );
+
+                    for( size_t k = 1; k < str.size(); ++k )
+                        str[ k ] = next() % 7 ? ( char ) ( 'a' + next() % 26 ) : ' ';
+
+                    str[ 0 ] = ( char ) ( 'A' + next() % 26 );
+
+                    m_strings[ i ].push_back( std::move( str ) );
+                }
+            }
+
+            constexpr size_t max_count = 100000;
+
+            m_rects.reserve( max_count );
+            m_lines.reserve( max_count );
+            m_circles.reserve( max_count );
+            m_path.reserve( max_count + 1 );
+
+            for( size_t i = 0; i < max_count; ++i ) {
+                m_rects.emplace_back( point( i ), Vec2_t{ 16.f, 8.f }, color( i ) );
+                m_lines.emplace_back( point( i ), point( i + 1 ), color( i ) );
+                m_circles.emplace_back( point( i ), 6.f, color( i ) );
+                m_path.push_back( point( i ) );
+            }
+
+            m_path.push_back( point( max_count ) );
+        }
+
+        FORCEINLINE const Vec2_t &point( size_t i ) const {
+            return m_points[ i & ( m_points.size() - 1 ) ];
+        }
+
+        FORCEINLINE float radius( size_t i ) const {
+            return m_radii[ i & ( m_radii.size() - 1 ) ];
+        }
+
+        FORCEINLINE Color color( size_t i ) const {
+            return m_colors[ i & ( m_colors.size() - 1 ) ];
+        }
+    };
+
+    BenchScene_t g_scene;
+
+    NOINLINE BenchResult_t run_case( Renderer &renderer, MockDevice &device, const BenchCase_t &bench, size_t count, const BenchOptions_t &options ) {
+        BenchResult_t result{};
+        uint64_t      submit_ns = 0, render_ns = 0;
+
+        // about the same amount of work per case, at least a few frames
+        const auto frames = std::clamp< size_t >( 200000 / count, options.m_min_frames, options.m_max_frames );
+
+        // one warm up frame grows the buffers and fills caches
+        bench.m_submit( renderer, count );
+        renderer.render();
+
+        renderer.reset_stats();
+        device.reset_stats();
+
+        for( size_t frame = 0; frame < frames; ++frame ) {
+            const auto start = Profiler::now();
+
+            bench.m_submit( renderer, count );
+
+            const auto submitted = Profiler::now();
+
+            renderer.render();
+
+            const auto rendered = Profiler::now();
+
+            submit_ns += submitted - start;
+            render_ns += rendered - submitted;
+        }
+
+        const auto &stats = renderer.get_stats();
+
+        result.m_name        = bench.m_name;
+        result.m_per_call    = bench.m_per_call;
+        result.m_count       = count;
+        result.m_frames      = frames;
+        result.m_submit_ns   = ( double ) submit_ns / frames;
+        result.m_render_ns   = ( double ) render_ns / frames;
+        result.m_flush_ns    = ( double ) stats.m_flush_ns / frames;
+        result.m_submissions = ( double ) stats.m_submissions / frames;
+        result.m_vertices    = ( double ) stats.m_vertices / frames;
+        result.m_instances   = ( double ) stats.m_instances / frames;
+        result.m_draw_calls  = ( double ) device.get_stats().m_draw_calls / frames;
+
+        return result;
+    }
+
+    // Font::init with 1, 2, 4 .. threads up to the core count. 2 always runs so the worker path is measured
+    NOINLINE std::vector< ScalingResult_t > run_font_scaling( MockDevice &device, const BenchOptions_t &options ) {
+        std::vector< ScalingResult_t > results;
+
+        const auto cores = std::max< size_t >( std::thread::hardware_concurrency(), 1 );
+
+        std::vector< size_t > thread_counts;
+
+        for( size_t threads = 1; threads < std::max< size_t >( cores, 2 ); threads *= 2 )
+            thread_counts.push_back( threads );
+
+        thread_counts.push_back( std::max< size_t >( cores, 2 ) );
+
+        if( options.m_quick )
+            thread_counts = { 1, 2 };
+
+        // plain and distance field, the sdf transform is the heavy part per glyph and takes seconds single
+        // threaded, so it runs once and not at all in quick mode
+        const std::pair< size_t, bool > configs[] = { { 16, false }, { 32, true } };
+
+        FontManager manager;
+
+        for( const auto &[ size, sdf ] : configs ) {
+            if( sdf && options.m_quick )
+                continue;
+
+            for( const auto threads : thread_counts ) {
+                ThreadPool pool;
+
+                if( threads > 1 )
+                    pool.init( threads - 1 );
+
+                ScalingResult_t result{ size, sdf, threads, 0, 0.0 };
+
+                for( size_t run = 0; run < ( options.m_quick || sdf ? 1u : 3u ); ++run ) {
+                    Font font;
+
+                    const auto start = Profiler::now();
+
+                    if( !font.init( &device, &manager, threads > 1 ? &pool : nullptr, options.m_font, size, true, sdf ? Font::CREATE_SDF : Font::CREATE_NONE ) )
+                        return results;
+
+                    const auto ms = ( double ) ( Profiler::now() - start ) / 1e6;
+
+                    result.m_glyphs  = font.m_glyphs.size();
+                    result.m_init_ms = run ? std::min( result.m_init_ms, ms ) : ms;
+
+                    font.release();
+                }
+
+                results.push_back( result );
+            }
+        }
+
+        return results;
+    }
+
+    // whole charset conversion to coverage, glyphs are rendered up front so only the conversion is timed
+    NOINLINE std::vector< ConversionResult_t > run_glyph_conversion( const BenchOptions_t &options ) {
+        std::vector< ConversionResult_t > results;
+        FT_Library                        library;
+        FT_Face                           face;
+        FT_UInt                           index;
+
+        // slot bitmap copied out, pitch and depth as freetype produced them
+        struct Rendered_t {
+            std::vector< uint8_t > m_pixels;
+            FT_Bitmap              m_bitmap;
+        };
+
+        if( FT_Init_FreeType( &library ) != 0 )
+            return results;
+
+        if( FT_New_Face( library, options.m_font.c_str(), 0, &face ) != 0 ) {
+            FT_Done_FreeType( library );
+            return results;
+        }
+
+        const auto sizes = options.m_quick ? std::vector< size_t >{ 13 } : std::vector< size_t >{ 13, 32, 96 };
+        const auto runs  = options.m_quick ? 2u : 5u; // the first pass also grows the output vectors
+
+        for( const auto size : sizes ) {
+            for( const auto mono : { true, false } ) {
+                std::vector< Rendered_t >             glyphs;
+                std::vector< std::vector< uint8_t > > converted, coverage;
+
+                FT_Set_Pixel_Sizes( face, 0, ( FT_UInt ) size );
+
+                for( auto charcode = FT_Get_First_Char( face, &index ); index; charcode = FT_Get_Next_Char( face, charcode, &index ) ) {
+                    if( FT_Load_Glyph( face, index, FT_LOAD_RENDER | ( mono ? FT_LOAD_TARGET_MONO : FT_LOAD_TARGET_NORMAL ) ) != 0 )
+                        continue;
+
+                    const auto &bitmap = face->glyph->bitmap;
+
+                    auto &glyph = glyphs.emplace_back();
+                    glyph.m_pixels.assign( bitmap.buffer, bitmap.buffer + ( size_t ) std::abs( bitmap.pitch ) * bitmap.rows );
+                    glyph.m_bitmap        = bitmap;
+                    glyph.m_bitmap.buffer = glyph.m_pixels.data();
+                }
+
+                converted.resize( glyphs.size() );
+                coverage.resize( glyphs.size() );
+
+                ConversionResult_t result{ size, mono, glyphs.size(), 0.0, 0.0, true };
+
+                for( size_t run = 0; run < runs; ++run ) {
+                    const auto start = Profiler::now();
+
+                    // what Font::init did per glyph before GlyphBitmap, a fresh 4 byte aligned copy, mono scaled
+                    // to 0 / 255 in a second pass, then the rows copied out
+                    for( size_t i = 0; i < glyphs.size(); ++i ) {
+                        const auto &src = glyphs[ i ].m_bitmap;
+                        FT_Bitmap  bitmap;
+
+                        FT_Bitmap_New( &bitmap );
+
+                        if( FT_Bitmap_Convert( library, &src, &bitmap, 4 ) == 0 ) {
+                            if( src.pixel_mode == FT_PIXEL_MODE_MONO ) {
+                                for( auto it = bitmap.buffer; it != &bitmap.buffer[ bitmap.rows * bitmap.pitch ]; it++ )
+                                    *it *= 255;
+                            }
+
+                            converted[ i ].resize( ( size_t ) bitmap.width * bitmap.rows );
+
+                            for( size_t row = 0; row < bitmap.rows; ++row )
+                                std::memcpy( &converted[ i ][ row * bitmap.width ], bitmap.buffer + ( ptrdiff_t ) row * bitmap.pitch, bitmap.width );
+                        }
+
+                        FT_Bitmap_Done( library, &bitmap );
+                    }
+
+                    const auto converted_at = Profiler::now();
+
+                    for( size_t i = 0; i < glyphs.size(); ++i ) {
+                        const auto &src = glyphs[ i ].m_bitmap;
+
+                        GlyphBitmap::to_coverage( src.buffer, src.pitch, src.width, src.rows, mono ? 1 : 8, coverage[ i ] );
+                    }
+
+                    const auto covered_at = Profiler::now();
+
+                    const auto convert_us  = ( double ) ( converted_at - start ) / 1e3;
+                    const auto coverage_us = ( double ) ( covered_at - converted_at ) / 1e3;
+
+                    result.m_convert_us  = run ? std::min( result.m_convert_us, convert_us ) : convert_us;
+                    result.m_coverage_us = run ? std::min( result.m_coverage_us, coverage_us ) : coverage_us;
+                }
+
+                result.m_identical = converted == coverage;
+
+                results.push_back( result );
+            }
+        }
+
+        FT_Done_Face( face );
+        FT_Done_FreeType( library );
+
+        return results;
+    }
+
+    NOINLINE void add_cases( std::vector< BenchCase_t > &cases, Renderer &renderer, font_id_t font_id ) {
+        const auto &scene = g_scene;
+
+        cases.push_back( { "draw_line_thin", [ & ]( Renderer &r, size_t count ) {
+            for( size_t i = 0; i < count; ++i )
+                r.draw_line( scene.point( i ), scene.point( i + 1 ), scene.color( i ) );
+        } } );
+
+        cases.push_back( { "draw_line_thick", [ & ]( Renderer &r, size_t count ) {
+            for( size_t i = 0; i < count; ++i )
+                r.draw_line( scene.point( i ), scene.point( i + 1 ), scene.color( i ), 3.f );
+        } } );
+
+        cases.push_back( { "draw_filled_rect", [ & ]( Renderer &r, size_t count ) {
+            for( size_t i = 0; i < count; ++i )
+                r.draw_filled_rect( scene.point( i ), { 16.f, 8.f }, scene.color( i ) );
+        } } );
+
+        cases.push_back( { "draw_filled_gradient_rect", [ & ]( Renderer &r, size_t count ) {
+            for( size_t i = 0; i < count; ++i )
+                r.draw_filled_gradient_rect( scene.point( i ), { 16.f, 8.f }, { scene.color( i ), scene.color( i + 1 ), scene.color( i + 2 ), scene.color( i + 3 ) } );
+        } } );
+
+        cases.push_back( { "draw_outlined_filled_rect", [ & ]( Renderer &r, size_t count ) {
+            for( size_t i = 0; i < count; ++i )
+                r.draw_outlined_filled_rect( scene.point( i ), { 16.f, 8.f }, scene.color( i ), { 255, 0, 0, 0 } );
+        } } );
+
+        cases.push_back( { "draw_rect", [ & ]( Renderer &r, size_t count ) {
+            for( size_t i = 0; i < count; ++i )
+                r.draw_rect( scene.point( i ), { 16.f, 8.f }, scene.color( i ) );
+        } } );
+
+        cases.push_back( { "draw_outlined_rect", [ & ]( Renderer &r, size_t count ) {
+            for( size_t i = 0; i < count; ++i )
+                r.draw_outlined_rect( scene.point( i ), { 16.f, 8.f }, scene.color( i ), { 255, 0, 0, 0 } );
+        } } );
+
+        cases.push_back( { "draw_circle", [ & ]( Renderer &r, size_t count ) {
+            for( size_t i = 0; i < count; ++i )
+                r.draw_circle( scene.point( i ), 6.f, scene.color( i ) );
+        } } );
+
+        cases.push_back( { "draw_filled_circle", [ & ]( Renderer &r, size_t count ) {
+            for( size_t i = 0; i < count; ++i )
+                r.draw_filled_circle( scene.point( i ), 6.f, scene.color( i ) );
+        } } );
+
+        // batched calls drawing exactly what the per primitive cases above draw
+        cases.push_back( { "draw_filled_rects", [ & ]( Renderer &r, size_t count ) {
+            r.draw_filled_rects( scene.m_rects.data(), count );
+        }, {}, "draw_filled_rect" } );
+
+        cases.push_back( { "draw_lines_thin", [ & ]( Renderer &r, size_t count ) {
+            r.draw_lines( scene.m_lines.data(), count );
+        }, {}, "draw_line_thin" } );
+
+        cases.push_back( { "draw_lines_thick", [ & ]( Renderer &r, size_t count ) {
+            r.draw_lines( scene.m_lines.data(), count, 3.f );
+        }, {}, "draw_line_thick" } );
+
+        // count segments through the same points, the thick one also builds mitered joins
+        cases.push_back( { "draw_polyline_thin", [ & ]( Renderer &r, size_t count ) {
+            r.draw_polyline( scene.m_path.data(), count + 1, scene.color( 0 ) );
+        }, {}, "draw_line_thin" } );
+
+        cases.push_back( { "draw_polyline_thick", [ & ]( Renderer &r, size_t count ) {
+            r.draw_polyline( scene.m_path.data(), count + 1, scene.color( 0 ), 3.f );
+        }, {}, "draw_line_thick" } );
+
+        cases.push_back( { "draw_circles", [ & ]( Renderer &r, size_t count ) {
+            r.draw_circles( scene.m_circles.data(), count );
+        }, {}, "draw_circle" } );
+
+        cases.push_back( { "draw_filled_circles", [ & ]( Renderer &r, size_t count ) {
+            r.draw_filled_circles( scene.m_circles.data(), count );
+        }, {}, "draw_filled_circle" } );
+
+        cases.push_back( { "draw_arc", [ & ]( Renderer &r, size_t count ) {
+            for( size_t i = 0; i < count; ++i )
+                r.draw_arc( scene.point( i ), 12.f, 0.f, 2.f, scene.color( i ), 2.f );
+        } } );
+
+        cases.push_back( { "draw_sector", [ & ]( Renderer &r, size_t count ) {
+            for( size_t i = 0; i < count; ++i )
+                r.draw_sector( scene.point( i ), 12.f, 0.f, 2.f, scene.color( i ) );
+        } } );
+
+        // 10k circles of mixed radius, against the fixed 32 segment circles draw_circle used to emit
+        // ( std::cos / std::sin per point, one add_vertices per circle )
+        const auto add_fixed_circle = []( Renderer &r, const Vec2_t &pos, float radius, const Color color, D3DPRIMITIVETYPE topology ) {
+            constexpr size_t           segment_count = 32;
+            std::array< Vertex_t, 33 > vertices;
+
+            for( size_t i = 0; i <= segment_count; ++i ) {
+                const auto angle = 2.f * Math::pi * ( float ) i / ( float ) segment_count;
+
+                vertices[ i ] = { { pos.x + radius * std::cos( angle ), pos.y + radius * std::sin( angle ) }, color };
+            }
+
+            r.add_vertices( vertices.data(), vertices.size(), topology );
+        };
+
+        cases.push_back( { "circle_mixed_fixed32", [ &, add_fixed_circle ]( Renderer &r, size_t count ) {
+            for( size_t i = 0; i < count; ++i )
+                add_fixed_circle( r, scene.point( i ), scene.radius( i ), scene.color( i ), D3DPT_LINESTRIP );
+        }, { 10000 } } );
+
+        cases.push_back( { "draw_circle_mixed", [ & ]( Renderer &r, size_t count ) {
+            for( size_t i = 0; i < count; ++i )
+                r.draw_circle( scene.point( i ), scene.radius( i ), scene.color( i ) );
+        }, { 10000 } } );
+
+        cases.push_back( { "filled_circle_mixed_fixed32", [ &, add_fixed_circle ]( Renderer &r, size_t count ) {
+            for( size_t i = 0; i < count; ++i )
+                add_fixed_circle( r, scene.point( i ), scene.radius( i ), scene.color( i ), D3DPT_TRIANGLEFAN );
+        }, { 10000 } } );
+
+        cases.push_back( { "draw_filled_circle_mixed", [ & ]( Renderer &r, size_t count ) {
+            for( size_t i = 0; i < count; ++i )
+                r.draw_filled_circle( scene.point( i ), scene.radius( i ), scene.color( i ) );
+        }, { 10000 } } );
+
+        // 64x64 white texture
+        const std::vector< uint32_t > pixels( 64 * 64, 0xffffffff );
+        const auto                    texture = renderer.get_texture( renderer.create_texture( 64, 64, pixels.data() ) );
+
+        if( texture ) {
+            cases.push_back( { "draw_texture_quad", [ &, texture ]( Renderer &r, size_t count ) {
+                static const std::array< Vec2_t, 6 > uv_coords = { { { 0.f, 1.f }, { 1.f, 1.f }, { 0.f, 0.f }, { 1.f, 1.f }, { 1.f, 0.f }, { 0.f, 0.f } } };
+
+                for( size_t i = 0; i < count; ++i )
+                    r.draw_texture_quad( scene.point( i ), { 16.f, 16.f }, scene.color( i ), texture, uv_coords );
+            } } );
+        }
+
+        // 16x16 sprites packed into an atlas file, the way sprite_packer output is loaded
+        SpriteAtlas                   atlas;
+        const std::vector< uint32_t > sprite_pixels( 16 * 16, 0xffffffff );
+
+        for( size_t i = 0; i < 64; ++i )
+            atlas.add_image( "sprite" + std::to_string( i ), 16, 16, sprite_pixels.data() );
+
+        const auto atlas_path = "renderer_bench.atlas";
+
+        if( atlas.build( 256 ) && atlas.save( atlas_path ) && renderer.load_sprite_atlas( atlas_path ) ) {
+            cases.push_back( { "draw_sprite", [ & ]( Renderer &r, size_t count ) {
+                for( size_t i = 0; i < count; ++i )
+                    r.draw_sprite( i & 63, scene.point( i ), scene.color( i ) );
+            } } );
+        }
+
+        std::remove( atlas_path );
+
+        // retained vertex layer of 100 rects, count is rects drawn
+        const auto layer = renderer.create_layer( "bench", { 0.f, 0.f }, { 400.f, 400.f }, Layer_t::VERTICES );
+
+        if( renderer.begin_layer( layer ) ) {
+            for( size_t i = 0; i < 100; ++i )
+                renderer.draw_filled_rect( { ( float ) ( i % 10 ) * 40.f, ( float ) ( i / 10 ) * 40.f }, { 30.f, 30.f }, scene.color( i ) );
+
+            renderer.end_layer();
+        }
+
+        cases.push_back( { "draw_layer", [ &, layer ]( Renderer &r, size_t count ) {
+            for( size_t i = 0; i < count / 100; ++i )
+                r.draw_layer( layer );
+        } } );
+
+        // text counts are glyphs, split into strings of each length
+        if( font_id != invalid_font_id ) {
+            const char *names[ 3 ] = { "draw_text_8", "draw_text_32", "draw_text_128" };
+
+            for( size_t length = 0; length < 3; ++length ) {
+                cases.push_back( { names[ length ], [ &, font_id, length ]( Renderer &r, size_t count ) {
+                    const auto &strings = scene.m_strings[ length ];
+                    const auto string_count = std::max< size_t >( count / strings[ 0 ].size(), 1 );
+
+                    for( size_t i = 0; i < string_count; ++i )
+                        r.draw_text( font_id, strings[ i % strings.size() ], scene.point( i ), 0, scene.color( i ) );
+                } } );
+            }
+        }
+
+        if( font_id != invalid_font_id ) {
+            // formatted every call like a fps counter, 16 glyphs
+            cases.push_back( { "draw_textf", [ &, font_id ]( Renderer &r, size_t count ) {
+                for( size_t i = 0; i < std::max< size_t >( count / 16, 1 ); ++i )
+                    r.draw_textf( font_id, scene.point( i ), 0, scene.color( i ), "fps %4zu ms %5.2f", i % 1000, ( float ) i * 0.01f );
+            } } );
+
+            // wrapped at 200 pixels, 128 glyphs per box
+            cases.push_back( { "draw_text_box", [ &, font_id ]( Renderer &r, size_t count ) {
+                const auto &strings = scene.m_strings[ 2 ];
+
+                for( size_t i = 0; i < std::max< size_t >( count / 128, 1 ); ++i )
+                    r.draw_text_box( font_id, strings[ i % strings.size() ], scene.point( i ), 200.f, 0, scene.color( i ) );
+            } } );
+
+            // two colored spans, 24 glyphs
+            cases.push_back( { "draw_text_markup", [ &, font_id ]( Renderer &r, size_t count ) {
+                for( size_t i = 0; i < std::max< size_t >( count / 24, 1 ); ++i )
+                    r.draw_text_markup( font_id, "{#ff4040}player{/} killed {#40a0ff}enemy", scene.point( i ), 0.f, 0, scene.color( i ) );
+            } } );
+        }
+
+        // pre-built triangles, isolates upload and flush from vertex generation. counts are vertices
+        cases.push_back( { "flush", [ & ]( Renderer &r, size_t count ) {
+            const auto vertex_count = std::max< size_t >( count / 3, 1 ) * 3;
+            const auto vertices     = r.reserve_vertices( vertex_count, D3DPT_TRIANGLELIST );
+
+            for( size_t i = 0; i < vertex_count; ++i )
+                vertices[ i ] = { scene.point( i ), scene.color( i ) };
+        } } );
+    }
+
+    NOINLINE bool write_results( const std::vector< BenchResult_t > &results, const std::vector< ScalingResult_t > &scaling, const std::vector< ConversionResult_t > &conversion, 
+        const std::string &path ) {
+        FILE *file = path.empty() ? stdout : std::fopen( path.c_str(), "w" );
+        if( !file )
+            return false;
+
+        std::fprintf( file, "{\"benchmarks\":[\n" );
+
+        for( size_t i = 0; i < results.size(); ++i ) {
+            const auto &result = results[ i ];
+
+            const auto submit_total    = result.m_submit_ns + result.m_render_ns;
+            const auto submissions_sec = submit_total > 0.0 ? result.m_submissions * 1e9 / submit_total : 0.0;
+            const auto ns_per_vertex   = result.m_vertices > 0.0 ? submit_total / result.m_vertices : 0.0;
+            const auto flush_per_vert  = result.m_vertices > 0.0 ? result.m_flush_ns / result.m_vertices : 0.0;
+
+            // batched cases against their per primitive counterpart at the same count
+            std::string per_call;
+
+            for( const auto &other : results ) {
+                if( result.m_per_call.empty() || other.m_name != result.m_per_call || other.m_count != result.m_count )
+                    continue;
+
+                const auto other_total = other.m_submit_ns + other.m_render_ns;
+
+                char buffer[ 128 ];
+                std::snprintf( buffer, sizeof( buffer ), "\"per_call\":\"%s\",\"per_call_speedup\":%.2f,", other.m_name.c_str(), submit_total > 0.0 ? other_total / submit_total : 0.0 );
+
+                per_call = buffer;
+            }
+
+            std::fprintf( file,
+                "  {\"name\":\"%s\",%s\"count\":%zu,\"frames\":%zu,\"submit_ns\":%.0f,\"render_ns\":%.0f,\"flush_ns\":%.0f,\"submissions\":%.0f,\"vertices\":%.0f,"
+                "\"instances\":%.0f,\"draw_calls\":%.1f,\"submissions_per_sec\":%.0f,\"ns_per_vertex\":%.3f,\"flush_ns_per_vertex\":%.3f}%s\n",
+                result.m_name.c_str(), per_call.c_str(), result.m_count, result.m_frames, result.m_submit_ns, result.m_render_ns, result.m_flush_ns, result.m_submissions, result.m_vertices,
+                result.m_instances, result.m_draw_calls, submissions_sec, ns_per_vertex, flush_per_vert, i + 1 < results.size() ? "," : "" );
+        }
+
+        std::fprintf( file, "],\n\"font_init_scaling\":[\n" );
+
+        for( size_t i = 0; i < scaling.size(); ++i ) {
+            const auto &result = scaling[ i ];
+
+            // against the single threaded run of the same font
+            double base_ms = result.m_init_ms;
+
+            for( const auto &other : scaling ) {
+                if( other.m_size == result.m_size && other.m_sdf == result.m_sdf && other.m_threads == 1 )
+                    base_ms = other.m_init_ms;
+            }
+
+            std::fprintf( file, "  {\"size\":%zu,\"sdf\":%s,\"threads\":%zu,\"cores\":%u,\"glyphs\":%zu,\"init_ms\":%.2f,\"speedup\":%.2f}%s\n",
+                result.m_size, result.m_sdf ? "true" : "false", result.m_threads, std::thread::hardware_concurrency(), result.m_glyphs, result.m_init_ms,
+                result.m_init_ms > 0.0 ? base_ms / result.m_init_ms : 0.0, i + 1 < scaling.size() ? "," : "" );
+        }
+
+        std::fprintf( file, "],\n\"glyph_conversion\":[\n" );
+
+        for( size_t i = 0; i < conversion.size(); ++i ) {
+            const auto &result = conversion[ i ];
+
+            std::fprintf( file, "  {\"size\":%zu,\"mode\":\"%s\",\"glyphs\":%zu,\"ft_convert_us\":%.1f,\"glyph_bitmap_us\":%.1f,\"speedup\":%.2f,\"identical\":%s}%s\n",
+                result.m_size, result.m_mono ? "mono" : "gray", result.m_glyphs, result.m_convert_us, result.m_coverage_us, 
+                result.m_coverage_us > 0.0 ? result.m_convert_us / result.m_coverage_us : 0.0, result.m_identical ? "true" : "false", i + 1 < conversion.size() ? "," : "" );
+        }
+
+        std::fprintf( file, "]}\n" );
+
+        if( file != stdout )
+            std::fclose( file );
+
+        return true;
+    }
+
+    NOINLINE std::string find_font() {
+        const char *paths[] = {
+            "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf",
+            "/usr/share/fonts/TTF/DejaVuSans.ttf",
+            "/usr/share/fonts/dejavu/DejaVuSans.ttf"
+        };
+
+        for( const auto path : paths ) {
+            if( FILE *file = std::fopen( path, "rb" ) ) {
+                std::fclose( file );
+                return path;
+            }
+        }
+
+        return {};
+    }
+
+}
+
+int main( int argc, char **argv ) {
+    BenchOptions_t options;
+    bool           quick = false;
+
+    for( int i = 1; i < argc; ++i ) {
+        const std::string arg = argv[ i ];
+
+        if( arg == "--quick" )
+            quick = true;
+
+        else if( arg == "--font" && i + 1 < argc )
+            options.m_font = argv[ ++i ];
+
+        else if( arg == "--out" && i + 1 < argc )
+            options.m_out = argv[ ++i ];
+
+        else {
+            std::fprintf( stderr, "usage: renderer_bench [--quick] [--font path.ttf] [--out results.json]\n" );
+            return 1;
+        }
+    }
+
+    // quick is a smoke run for ctest
+    options.m_quick      = quick;
+    options.m_counts     = quick ? std::vector< size_t >{ 1000 } : std::vector< size_t >{ 1000, 10000, 100000 };
+    options.m_min_frames = quick ? 1 : 5;
+    options.m_max_frames = quick ? 1 : 200;
+
+    if( options.m_font.empty() )
+        options.m_font = find_font();
+
+    g_scene.init();
+
+    // device is owned by the caller like the real one, released after the renderer
+    const auto device = new MockDevice( 1920, 1080 );
+
+    {
+        Renderer renderer;
+
+        if( !renderer.init( device, 65536 ) ) {
+            std::fprintf( stderr, "renderer init failed\n" );
+            return 1;
+        }
+
+        // frames differ in content, measure the upload every frame
+        renderer.set_upload_reuse( false );
+
+        font_id_t font_id = invalid_font_id;
+        if( !options.m_font.empty() ) {
+            font_id = renderer.create_font( options.m_font, 13, true );
+
+            if( font_id == invalid_font_id )
+                std::fprintf( stderr, "can't load %s, skipping text\n", options.m_font.c_str() );
+        }
+
+        else
+            std::fprintf( stderr, "no font found, skipping text ( --font )\n" );
+
+        std::vector< BenchCase_t >        cases;
+        std::vector< BenchResult_t >      results;
+        std::vector< ScalingResult_t >    scaling;
+        std::vector< ConversionResult_t > conversion;
+
+        add_cases( cases, renderer, font_id );
+
+        for( const auto &bench : cases ) {
+            const auto &counts = bench.m_counts.empty() || options.m_quick ? options.m_counts : bench.m_counts;
+
+            for( const auto count : counts )
+                results.push_back( run_case( renderer, *device, bench, count, options ) );
+        }
+
+        if( font_id != invalid_font_id ) {
+            scaling    = run_font_scaling( *device, options );
+            conversion = run_glyph_conversion( options );
+        }
+
+        if( !write_results( results, scaling, conversion, options.m_out ) ) {
+            std::fprintf( stderr, "can't write %s\n", options.m_out.c_str() );
+            return 1;
+        }
+    }
+
+    device->Release();
+
+    return 0;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+// minimal test registry. TEST( name ) defines and registers a case, CHECK records a failure and keeps going
+#include <cstddef>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace Test {
+
+    using func_t = void( * )();
+
+    struct Case_t {
+        const char *m_name;
+        func_t     m_func;
+    };
+
+    // every registered case, in link order
+    std::vector< Case_t > &cases();
+
+    // report a failed check of the running case
+    void fail( const char *file, int line, const char *expr );
+
+    // ttf for tests that rasterize, RENDERER_TEST_FONT or a system dejavu sans. empty if there is none,
+    // those tests then skip
+    const std::string &font_path();
+
+    // scratch directory removed when it goes out of scope, empty path if it couldn't be made
+    struct TempDir_t {
+        std::filesystem::path m_path;
+
+        TempDir_t() {
+            char path[] = "/tmp/renderer_tests_XXXXXX";
+
+            if( mkdtemp( path ) )
+                m_path = path;
+        }
+
+        ~TempDir_t() {
+            std::error_code error;
+
+            if( !m_path.empty() )
+                std::filesystem::remove_all( m_path, error );
+        }
+    };
+
+    struct Register_t {
+        Register_t( const char *name, func_t func ) {
+            cases().push_back( { name, func } );
+        }
+    };
+
+}
+
+#define TEST( name )                                                       \
+    static void test_##name();                                             \
+    static const Test::Register_t register_##name( #name, test_##name );   \
+    static void test_##name()
+
+#define CHECK( expr )                                 \
+    do {                                              \
+        if( !( expr ) )                               \
+            Test::fail( __FILE__, __LINE__, #expr );  \
+    } while( 0 )
@@ -0,0 +1,119 @@
+// font creation through the renderer on the mock device
+#include "includes.h"
+#include "mock_device.h"
+#include "test.h"
+
+TEST( create_font_fails_with_invalid_id ) {
+    MockRenderer_t mock;
+    CHECK( mock.m_ready );
+
+    auto &renderer = mock.m_renderer;
+
+    CHECK( renderer.create_font( "/nonexistent/font.ttf", 13, true ) == invalid_font_id );
+    CHECK( renderer.create_font_async( "/nonexistent/font.ttf", 13, true ) == invalid_font_id );
+
+    // a failed font takes no id, the first good one is 0
+    const auto &path = Test::font_path();
+    if( !path.empty() )
+        CHECK( renderer.create_font( path, 13, true ) == 0 );
+}
+
+TEST( create_font_async_loads_in_render ) {
+    const auto &path = Test::font_path();
+    if( path.empty() )
+        return;
+
+    MockRenderer_t mock;
+    CHECK( mock.m_ready );
+
+    auto &renderer = mock.m_renderer;
+
+    bool done = false, success = false;
+
+    const auto font_id = renderer.create_font_async( path, 13, true, Font::CREATE_NONE, [ & ]( font_id_t, bool loaded ) {
+        done    = true;
+        success = loaded;
+    } );
+
+    CHECK( font_id != invalid_font_id );
+
+    // glyphs are packed a budget at a time inside render
+    for( size_t frame = 0; frame < 10000 && !done; ++frame ) {
+        renderer.render();
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+
+    CHECK( done && success );
+}
+
+TEST( create_font_while_async_load_fills_glyph_queue ) {
+    const auto &path = Test::font_path();
+    if( path.empty() )
+        return;
+
+    // one worker, the async load fills the glyph queue before anything is packed
+    MockRenderer_t mock( 3, 1 );
+    CHECK( mock.m_ready );
+
+    auto &renderer = mock.m_renderer;
+
+    bool done = false, success = false;
+
+    const auto async_id = renderer.create_font_async( path, 13, true, Font::CREATE_NONE, [ & ]( font_id_t, bool loaded ) {
+        done    = true;
+        success = loaded;
+    } );
+
+    CHECK( async_id != invalid_font_id );
+
+    // the sync load's parallel_for queues behind the async job, it used to hang here
+    std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+    const auto sync_id = renderer.create_font( path, 14, true );
+
+    CHECK( sync_id != invalid_font_id );
+    CHECK( renderer.is_font_loaded( sync_id ) );
+
+    for( size_t frame = 0; frame < 10000 && !done; ++frame ) {
+        renderer.render();
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+
+    CHECK( done && success );
+}
+
+TEST( text_layout_caches_only_wrapped_or_multi_line_text ) {
+    const auto &path = Test::font_path();
+    if( path.empty() )
+        return;
+
+    MockRenderer_t mock;
+    CHECK( mock.m_ready );
+
+    auto &renderer = mock.m_renderer;
+
+    const auto font_id = renderer.create_font( path, 13, true );
+    CHECK( font_id != invalid_font_id );
+
+    // single lines share one scratch layout, measured on every call
+    const auto &first  = renderer.get_text_layout( font_id, "fps 144", 0.f );
+    const auto  width  = first.m_size.x;
+    const auto &second = renderer.get_text_layout( font_id, "fps 60", 0.f );
+
+    CHECK( &first == &second );
+    CHECK( second.m_lines.size() == 1 && second.m_size.x < width );
+
+    // the same line through the cache, a wrap width it never reaches
+    const auto &wide = renderer.get_text_layout( font_id, "fps 144", 10000.f );
+    CHECK( &wide != &second );
+    CHECK( wide.m_lines.size() == 1 && wide.m_size.x == width );
+
+    // cached layouts stay put while they keep being used, renders in between included
+    const auto &block = renderer.get_text_layout( font_id, "first line\nsecond line", 0.f );
+    CHECK( block.m_lines.size() == 2 );
+
+    for( size_t frame = 0; frame < 300; ++frame ) {
+        renderer.render();
+
+        CHECK( &renderer.get_text_layout( font_id, "first line\nsecond line", 0.f ) == &block );
+    }
+}
@@ -0,0 +1,103 @@
+// font catalogue names, directory scan and index round trip
+#include <filesystem>
+#include "includes.h"
+#include "test.h"
+
+namespace {
+
+    void write_file( const std::filesystem::path &path, const std::string &contents ) {
+        if( FILE *file = std::fopen( path.string().c_str(), "wb" ) ) {
+            std::fwrite( contents.data(), 1, contents.size(), file );
+            std::fclose( file );
+        }
+    }
+
+}
+
+TEST( font_catalog_normalizes_names ) {
+    CHECK( FontCatalog::normalize( "Arial Bold (TrueType)" ) == "arial bold" );
+    CHECK( FontCatalog::normalize( "  Segoe UI  " ) == "segoe ui" );
+    CHECK( FontCatalog::normalize( "(TrueType)" ).empty() );
+    CHECK( FontCatalog::normalize( "" ).empty() );
+}
+
+TEST( font_catalog_resolves_family_style_and_file_name ) {
+    FontCatalog catalog;
+
+    // bold first, the regular style still takes the family name
+    catalog.add( "Arial", "Bold", "C:\\Windows\\Fonts\\arialbd.ttf" );
+    catalog.add( "Arial", "Regular", "C:\\Windows\\Fonts\\arial.ttf" );
+    catalog.add( "Arial", "Bold", "D:\\other\\arialbd.ttf" );
+
+    CHECK( catalog.find( "Arial" ) == "C:\\Windows\\Fonts\\arial.ttf" );
+    CHECK( catalog.find( "arial bold" ) == "C:\\Windows\\Fonts\\arialbd.ttf" );
+    CHECK( catalog.find( "Arial Bold (TrueType)" ) == "C:\\Windows\\Fonts\\arialbd.ttf" );
+    CHECK( catalog.find( "Comic Sans" ).empty() );
+
+    catalog.clear();
+    CHECK( catalog.empty() && catalog.find( "arial" ).empty() );
+}
+
+TEST( font_catalog_scans_directory ) {
+    const auto &font = Test::font_path();
+    if( font.empty() )
+        return;
+
+    Test::TempDir_t dir;
+    CHECK( !dir.m_path.empty() );
+
+    if( dir.m_path.empty() )
+        return;
+
+    // a nested font, its bold sibling when the system has one, a broken font and a file that isn't a font
+    const auto nested = dir.m_path / "nested" / "deeper";
+    std::filesystem::create_directories( nested );
+
+    const std::filesystem::path source = font;
+    auto                        bold   = source;
+    bold.replace_filename( source.stem().string() + "-Bold" + source.extension().string() );
+
+    const auto has_bold = std::filesystem::exists( bold );
+
+    std::filesystem::copy_file( source, nested / "Regular.ttf" );
+
+    if( has_bold )
+        std::filesystem::copy_file( bold, dir.m_path / "Heavy.TTF" );
+
+    write_file( dir.m_path / "broken.ttf", "not a font" );
+    write_file( dir.m_path / "readme.txt", "not a font either" );
+
+    FontManager manager;
+    CHECK( manager.init() );
+
+    FontCatalog catalog;
+    CHECK( catalog.add_directory( manager.get_library(), dir.m_path.string() ) == ( has_bold ? 2u : 1u ) );
+    CHECK( catalog.add_directory( nullptr, dir.m_path.string() ) == 0 );
+    CHECK( catalog.add_directory( manager.get_library(), ( dir.m_path / "missing" ).string() ) == 0 );
+
+    const auto regular_path = ( nested / "Regular.ttf" ).string();
+    const auto family       = catalog.m_entries.empty() ? std::string{} : catalog.m_entries.front().m_family;
+
+    CHECK( !family.empty() );
+    CHECK( catalog.find( family ) == regular_path );
+    CHECK( catalog.find( "regular" ) == regular_path );
+
+    if( has_bold ) {
+        CHECK( catalog.find( family + " bold" ) == ( dir.m_path / "Heavy.TTF" ).string() );
+        CHECK( catalog.find( "heavy" ) == ( dir.m_path / "Heavy.TTF" ).string() );
+    }
+
+    // the index brings back the same names without touching the fonts
+    const auto index = ( dir.m_path / "fonts.index" ).string();
+    CHECK( catalog.save_index( index ) );
+
+    FontCatalog loaded;
+    CHECK( loaded.load_index( index ) );
+    CHECK( loaded.m_entries.size() == catalog.m_entries.size() );
+    CHECK( loaded.find( family ) == regular_path );
+
+    // anything without the header is stale
+    write_file( index, "family\tstyle\tpath\n" );
+    CHECK( !loaded.load_index( index ) );
+    CHECK( !loaded.load_index( ( dir.m_path / "missing.index" ).string() ) );
+}
@@ -0,0 +1,103 @@
+// glyph bitmap expansion against a per pixel reference, every width around the simd step and both pitch signs
+#include "glyph_bitmap.h"
+#include "test.h"
+
+namespace {
+
+    // bitmap of bits per pixel in freetype layout, rows padded to pitch
+    struct Bitmap_t {
+        std::vector< uint8_t > m_bytes;
+        size_t                 m_width, m_height, m_bits, m_pitch;
+
+        Bitmap_t( size_t width, size_t height, size_t bits, size_t padding, uint32_t seed ) : m_width{ width }, m_height{ height }, m_bits{ bits } {
+            m_pitch = ( width * bits + 7 ) / 8 + padding;
+
+            m_bytes.resize( m_pitch * height );
+
+            for( auto &byte : m_bytes ) {
+                seed = seed * 1664525u + 1013904223u;
+                byte = ( uint8_t ) ( seed >> 24 );
+            }
+        }
+
+        // coverage of pixel x in row, scaled to 0 - 255
+        uint8_t coverage( size_t x, size_t row ) const {
+            const auto per_byte = 8 / m_bits;
+            const auto max      = ( 1u << m_bits ) - 1;
+            const auto shift    = 8 - m_bits * ( x % per_byte + 1 );
+
+            return ( uint8_t ) ( ( ( m_bytes[ row * m_pitch + x / per_byte ] >> shift ) & max ) * 255 / max );
+        }
+
+        bool matches( const std::vector< uint8_t > &pixels, bool bottom_up = false ) const {
+            if( pixels.size() != m_width * m_height )
+                return false;
+
+            for( size_t row = 0; row < m_height; ++row ) {
+                for( size_t x = 0; x < m_width; ++x ) {
+                    if( pixels[ row * m_width + x ] != coverage( x, bottom_up ? m_height - 1 - row : row ) )
+                        return false;
+                }
+            }
+
+            return true;
+        }
+    };
+
+}
+
+TEST( glyph_bitmap_expands_every_depth ) {
+    std::vector< uint8_t > pixels;
+
+    // 1 to 40 pixels covers no simd step, exactly one, and steps with a scalar tail
+    for( const size_t bits : { 1, 2, 4, 8 } ) {
+        for( size_t width = 1; width <= 40; ++width ) {
+            for( const size_t padding : { 0, 3 } ) {
+                const Bitmap_t bitmap( width, 5, bits, padding, ( uint32_t ) ( width * 31 + bits ) );
+
+                CHECK( GlyphBitmap::to_coverage( bitmap.m_bytes.data(), ( ptrdiff_t ) bitmap.m_pitch, width, 5, bits, pixels ) );
+                CHECK( bitmap.matches( pixels ) );
+            }
+        }
+    }
+}
+
+TEST( glyph_bitmap_walks_negative_pitch_top_down ) {
+    std::vector< uint8_t > pixels;
+
+    // a negative pitch keeps the buffer at the start of memory, which holds the bottom row
+    for( const size_t bits : { 1, 2, 8 } ) {
+        const Bitmap_t bitmap( 21, 7, bits, 2, ( uint32_t ) bits );
+
+        CHECK( GlyphBitmap::to_coverage( bitmap.m_bytes.data(), -( ptrdiff_t ) bitmap.m_pitch, 21, 7, bits, pixels ) );
+        CHECK( bitmap.matches( pixels, true ) );
+    }
+}
+
+TEST( glyph_bitmap_rejects_other_depths ) {
+    std::vector< uint8_t > pixels;
+    const uint8_t          byte = 0xff;
+
+    CHECK( !GlyphBitmap::to_coverage( &byte, 1, 1, 1, 3, pixels ) );
+    CHECK( !GlyphBitmap::to_coverage( &byte, 1, 1, 1, 32, pixels ) );
+
+    // empty glyphs like the space succeed with no pixels
+    CHECK( GlyphBitmap::to_coverage( nullptr, 0, 0, 0, 8, pixels ) && pixels.empty() );
+}
+
+TEST( glyph_bitmap_copies_rows_between_pitches ) {
+    const Bitmap_t bitmap( 10, 4, 8, 6, 7 );
+
+    // padded source to a padded destination, and the single copy when neither side is padded
+    std::vector< uint8_t > padded( 12 * 4, 0xcd ), packed( 10 * 4 ), again( 10 * 4 );
+
+    GlyphBitmap::copy_rows( bitmap.m_bytes.data(), ( ptrdiff_t ) bitmap.m_pitch, 10, 4, padded.data(), 12 );
+    GlyphBitmap::copy_rows( padded.data(), 12, 10, 4, packed.data(), 10 );
+    GlyphBitmap::copy_rows( packed.data(), 10, 10, 4, again.data(), 10 );
+
+    CHECK( bitmap.matches( packed ) && again == packed );
+
+    // destination padding is left alone
+    for( size_t row = 0; row < 4; ++row )
+        CHECK( padded[ row * 12 + 10 ] == 0xcd && padded[ row * 12 + 11 ] == 0xcd );
+}
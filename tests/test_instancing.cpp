@@ -0,0 +1,110 @@
+// packing of the instanced path, read back from the instance stream of the mock device
+#include <cstddef>
+#include <cstring>
+#include "includes.h"
+#include "mock_device.h"
+#include "test.h"
+
+static std::vector< Instance_t > drawn_instances( const MockDevice *device ) {
+    const auto &bytes = device->get_instances();
+
+    std::vector< Instance_t > instances( bytes.size() / sizeof( Instance_t ) );
+    std::memcpy( instances.data(), bytes.data(), instances.size() * sizeof( Instance_t ) );
+
+    return instances;
+}
+
+TEST( instance_layout_matches_declaration ) {
+    // offsets of stream 1 in create_instance_shaders
+    CHECK( sizeof( Instance_t ) == 36 );
+    CHECK( offsetof( Instance_t, m_pos ) == 0 );
+    CHECK( offsetof( Instance_t, m_size ) == 8 );
+    CHECK( offsetof( Instance_t, m_color ) == 16 );
+    CHECK( offsetof( Instance_t, m_uv_min ) == 20 );
+    CHECK( offsetof( Instance_t, m_uv_max ) == 28 );
+}
+
+TEST( instancing_needs_shader_model_3 ) {
+    MockRenderer_t mock( 2 );
+    CHECK( mock.m_ready );
+
+    auto &renderer = mock.m_renderer;
+
+    CHECK( !renderer.set_instancing( true ) );
+    CHECK( !renderer.is_instancing() );
+}
+
+TEST( instanced_rects_pack_one_instance_each ) {
+    MockRenderer_t mock;
+    CHECK( mock.m_ready );
+
+    auto      &renderer = mock.m_renderer;
+    const auto device   = mock.m_device.get();
+
+    CHECK( renderer.set_instancing( true ) );
+
+    auto color = Color::from_argb( 0xff2080c0 );
+
+    renderer.draw_filled_rect( 10.f, 20.f, 30.f, 40.f, color );
+
+    // the clipped part is dropped from the size
+    const FilledRect_t rects[] = { { { 100.f, 200.f }, { 8.f, 4.f }, color }, { { 1000.f, 0.f }, { 40.f, 10.f }, color } };
+
+    renderer.push_clip_rect( 0.f, 0.f, 1020.f, 1080.f );
+    renderer.draw_filled_rects( rects, 2 );
+    renderer.pop_clip_rect();
+
+    device->reset_stats();
+    renderer.render();
+
+    const auto instances = drawn_instances( device );
+    CHECK( instances.size() == 3 );
+    CHECK( device->get_stats().m_draw_calls == 1 );
+
+    if( instances.size() == 3 ) {
+        CHECK( instances[ 0 ].m_pos.x == 10.f && instances[ 0 ].m_pos.y == 20.f );
+        CHECK( instances[ 0 ].m_size.x == 30.f && instances[ 0 ].m_size.y == 40.f );
+        CHECK( instances[ 0 ].m_color == color.get() );
+        CHECK( instances[ 1 ].m_pos.x == 100.f && instances[ 1 ].m_size.x == 8.f && instances[ 1 ].m_size.y == 4.f );
+        CHECK( instances[ 2 ].m_pos.x == 1000.f && instances[ 2 ].m_size.x == 20.f && instances[ 2 ].m_size.y == 10.f );
+    }
+}
+
+TEST( instanced_glyphs_pack_their_atlas_uvs ) {
+    const auto &path = Test::font_path();
+    if( path.empty() )
+        return;
+
+    MockRenderer_t mock;
+    CHECK( mock.m_ready );
+
+    auto      &renderer = mock.m_renderer;
+    const auto device   = mock.m_device.get();
+
+    CHECK( renderer.set_instancing( true ) );
+
+    const auto font_id = renderer.create_font( path, 16, true );
+    CHECK( font_id != invalid_font_id );
+
+    auto color = Color::from_argb( 0x802080c0 );
+
+    renderer.draw_text( font_id, "AB", 100.f, 100.f, 0, color );
+
+    device->reset_stats();
+    renderer.render();
+
+    const auto instances = drawn_instances( device );
+    CHECK( instances.size() == 2 );
+
+    for( const auto &instance : instances ) {
+        CHECK( instance.m_color == color.get() );
+        CHECK( instance.m_size.x > 0.f && instance.m_size.y > 0.f );
+        CHECK( instance.m_uv_min.x >= 0.f && instance.m_uv_min.y >= 0.f );
+        CHECK( instance.m_uv_max.x <= 1.f && instance.m_uv_max.y <= 1.f );
+        CHECK( instance.m_uv_min.x < instance.m_uv_max.x && instance.m_uv_min.y < instance.m_uv_max.y );
+    }
+
+    // glyphs run left to right
+    if( instances.size() == 2 )
+        CHECK( instances[ 0 ].m_pos.x < instances[ 1 ].m_pos.x );
+}
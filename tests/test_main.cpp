@@ -0,0 +1,84 @@
+// renderer unit tests on linux, every case registered with TEST() runs in order:
+//
+//   renderer_tests [name substring]
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "test.h"
+
+namespace {
+
+    size_t case_failures;
+
+}
+
+std::vector< Test::Case_t > &Test::cases() {
+    static std::vector< Case_t > cases;
+
+    return cases;
+}
+
+void Test::fail( const char *file, int line, const char *expr ) {
+    std::printf( "  %s:%d: CHECK( %s ) failed\n", file, line, expr );
+
+    ++case_failures;
+}
+
+const std::string &Test::font_path() {
+    static const std::string path = []() -> std::string {
+        if( const auto env = std::getenv( "RENDERER_TEST_FONT" ) )
+            return env;
+
+        const char *paths[] = {
+            "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf",
+            "/usr/share/fonts/TTF/DejaVuSans.ttf",
+            "/usr/share/fonts/dejavu/DejaVuSans.ttf"
+        };
+
+        for( const auto candidate : paths ) {
+            if( FILE *file = std::fopen( candidate, "rb" ) ) {
+                std::fclose( file );
+                return candidate;
+            }
+        }
+
+        return {};
+    }();
+
+    if( path.empty() ) {
+        static bool warned = false;
+
+        if( !warned )
+            std::printf( "  no test font, set RENDERER_TEST_FONT. font tests are skipped\n" );
+
+        warned = true;
+    }
+
+    return path;
+}
+
+int main( int argc, char **argv ) {
+    const char *filter = argc > 1 ? argv[ 1 ] : nullptr;
+
+    size_t run = 0, failed = 0;
+
+    for( const auto &test : Test::cases() ) {
+        if( filter && !std::strstr( test.m_name, filter ) )
+            continue;
+
+        case_failures = 0;
+
+        test.m_func();
+
+        std::printf( "[%s] %s\n", case_failures ? "fail" : " ok ", test.m_name );
+
+        ++run;
+
+        if( case_failures )
+            ++failed;
+    }
+
+    std::printf( "%zu / %zu passed\n", run - failed, run );
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,246 @@
+// overlay channel across two processes, drops when the ring is full and frames drawn by the renderer
+#include <chrono>
+#include <cstring>
+#include <sched.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "includes.h"
+#include "mock_device.h"
+#include "test.h"
+
+namespace {
+
+    // unique per process so parallel runs don't share a ring
+    std::string channel_name( const char *test ) {
+        return std::string( "dx9r_" ) + test + "_" + std::to_string( getpid() );
+    }
+
+    // rect, vertex run and text all carry the frame id, a torn frame shows up as a mismatch
+    bool write_frame( OverlayChannel &channel, uint32_t id ) {
+        channel.begin_frame();
+        channel.add_filled_rect( ( float ) id, 0.f, 10.f, 10.f, 0xff000000 | id );
+
+        if( const auto vertices = channel.reserve_vertices( D3DPT_TRIANGLELIST, 3 ) ) {
+            for( size_t i = 0; i < 3; ++i )
+                vertices[ i ] = { ( float ) id, ( float ) i, 1.f, 1.f, 0xffffffff, 0.f, 0.f };
+        }
+
+        channel.add_text( 0, 0.f, 0.f, 0, 0xffffffff, "frame " + std::to_string( id ) );
+
+        return channel.end_frame();
+    }
+
+    // id of a drained frame, -1 if its records don't agree
+    int64_t read_frame( const std::vector< uint8_t > &frame ) {
+        Overlay::Record_t record;
+        size_t            offset = 0, records = 0;
+        int64_t           id = -1;
+
+        const auto agree = [ & ]( int64_t value ) {
+            if( id < 0 )
+                id = value;
+
+            return id == value;
+        };
+
+        while( offset + sizeof( record ) <= frame.size() ) {
+            std::memcpy( &record, frame.data() + offset, sizeof( record ) );
+
+            const auto payload = frame.data() + offset + sizeof( record );
+
+            if( record.m_type == Overlay::RECORD_FILLED_RECT ) {
+                Overlay::Rect_t rect;
+                std::memcpy( &rect, payload, sizeof( rect ) );
+
+                if( !agree( ( int64_t ) rect.m_x ) || rect.m_color != ( 0xff000000 | ( uint32_t ) id ) )
+                    return -1;
+            }
+
+            else if( record.m_type == Overlay::RECORD_VERTICES ) {
+                Overlay::Vertices_t run;
+                Overlay::Vertex_t   vertex;
+                std::memcpy( &run, payload, sizeof( run ) );
+
+                if( run.m_count != 3 )
+                    return -1;
+
+                for( size_t i = 0; i < run.m_count; ++i ) {
+                    std::memcpy( &vertex, payload + sizeof( run ) + i * sizeof( vertex ), sizeof( vertex ) );
+
+                    if( !agree( ( int64_t ) vertex.m_x ) || vertex.m_y != ( float ) i )
+                        return -1;
+                }
+            }
+
+            else if( record.m_type == Overlay::RECORD_TEXT ) {
+                Overlay::Text_t text;
+                std::memcpy( &text, payload, sizeof( text ) );
+
+                const std::string str( ( const char * ) payload + sizeof( text ), text.m_length );
+                if( !agree( std::stoll( str.substr( 6 ) ) ) )
+                    return -1;
+            }
+
+            else
+                return -1;
+
+            offset += record.m_size;
+            ++records;
+        }
+
+        return records == 3 && offset == frame.size() ? id : -1;
+    }
+
+}
+
+TEST( overlay_frames_cross_processes_whole ) {
+    constexpr uint32_t frame_count = 2000;
+
+    const auto name = channel_name( "cross" );
+
+    // a page of ring holds about 20 frames, the producer keeps running into a full ring
+    OverlayChannel consumer;
+    CHECK( consumer.create( name, 4096 ) );
+    if( !consumer.is_open() )
+        return;
+
+    const auto child = fork();
+    CHECK( child >= 0 );
+    if( child < 0 )
+        return;
+
+    // producer, retries every frame until it's published. exits without running destructors of the parent's objects
+    if( !child ) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds( 20 );
+
+        OverlayChannel producer;
+        if( !producer.open( name ) )
+            _exit( 2 );
+
+        for( uint32_t id = 0; id < frame_count; ++id ) {
+            while( !write_frame( producer, id ) ) {
+                if( std::chrono::steady_clock::now() > deadline )
+                    _exit( 3 );
+
+                sched_yield();
+            }
+        }
+
+        producer.close();
+        _exit( 0 );
+    }
+
+    std::vector< uint8_t > frame;
+    int64_t                last = -1;
+    uint64_t               seen = 0;
+    bool                   torn = false, ordered = true;
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds( 20 );
+
+    while( last + 1 < frame_count && std::chrono::steady_clock::now() < deadline ) {
+        if( !consumer.drain( frame ) ) {
+            sched_yield();
+            continue;
+        }
+
+        const auto id = read_frame( frame );
+
+        torn    |= id < 0;
+        ordered &= id > last;
+        last     = id;
+
+        ++seen;
+    }
+
+    int status = -1;
+    waitpid( child, &status, 0 );
+
+    CHECK( WIFEXITED( status ) && WEXITSTATUS( status ) == 0 );
+    CHECK( !torn && ordered );
+    CHECK( last + 1 == frame_count );
+
+    // every published frame was either drawn or replaced by a newer one
+    CHECK( consumer.get_frames_published() == frame_count );
+    CHECK( seen + consumer.get_frames_skipped() == frame_count );
+}
+
+TEST( overlay_drops_frames_that_dont_fit ) {
+    const auto name = channel_name( "drop" );
+
+    OverlayChannel consumer, producer;
+    CHECK( consumer.create( name, 4096 ) );
+    CHECK( producer.open( name ) );
+
+    std::vector< uint8_t > frame;
+
+    // bigger than the ring, dropped whole and the consumer sees nothing
+    producer.begin_frame();
+    CHECK( !producer.reserve_vertices( D3DPT_TRIANGLELIST, 3 * 200 ) );
+    producer.add_filled_rect( 0.f, 0.f, 1.f, 1.f, 0xffffffff );
+    CHECK( !producer.end_frame() );
+
+    CHECK( producer.get_frames_dropped() == 1 );
+    CHECK( !consumer.drain( frame ) );
+
+    // frames published before a drain, only the latest is kept
+    for( uint32_t id = 0; id < 3; ++id )
+        CHECK( write_frame( producer, id ) );
+
+    CHECK( consumer.drain( frame ) );
+    CHECK( read_frame( frame ) == 2 );
+    CHECK( consumer.get_frames_skipped() == 2 );
+    CHECK( !consumer.drain( frame ) );
+
+    // the drained space is reused, across the end of the ring too
+    for( uint32_t id = 3; id < 100; ++id ) {
+        CHECK( write_frame( producer, id ) );
+        CHECK( consumer.drain( frame ) && read_frame( frame ) == id );
+    }
+
+    CHECK( consumer.get_frames_dropped() == 1 );
+}
+
+TEST( overlay_frame_is_drawn_until_replaced ) {
+    const auto name   = channel_name( "render" );
+    MockRenderer_t mock;
+    CHECK( mock.m_ready );
+
+    auto      &renderer = mock.m_renderer;
+    const auto device   = mock.m_device.get();
+
+    CHECK( renderer.set_instancing( true ) );
+    CHECK( renderer.open_overlay_channel( name, 4096 ) );
+
+    OverlayChannel producer;
+    CHECK( producer.open( name ) );
+
+    producer.begin_frame();
+    producer.add_filled_rect( 10.f, 20.f, 30.f, 40.f, 0xff2080c0 );
+    CHECK( producer.end_frame() );
+
+    // the rect comes back as an instance on every render until the next frame
+    for( size_t i = 0; i < 3; ++i ) {
+        device->reset_stats();
+        renderer.render();
+
+        const auto &bytes = device->get_instances();
+        CHECK( bytes.size() == sizeof( Instance_t ) );
+
+        if( bytes.size() == sizeof( Instance_t ) ) {
+            Instance_t instance;
+            std::memcpy( &instance, bytes.data(), sizeof( instance ) );
+
+            CHECK( instance.m_pos.x == 10.f && instance.m_pos.y == 20.f && instance.m_size.x == 30.f && instance.m_color == 0xff2080c0 );
+        }
+    }
+
+    // an empty frame clears the overlay
+    producer.begin_frame();
+    CHECK( producer.end_frame() );
+
+    device->reset_stats();
+    renderer.render();
+
+    CHECK( device->get_instances().empty() );
+    CHECK( renderer.get_overlay_channel().get_frames_published() == 2 );
+}
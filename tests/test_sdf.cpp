@@ -0,0 +1,144 @@
+// distance field generation on synthetic coverage, and an sdf font end to end on the mock device
+#include "includes.h"
+#include "mock_device.h"
+#include "test.h"
+
+namespace {
+
+    // coverage of a filled disc
+    std::vector< uint8_t > disc( size_t size, float radius ) {
+        std::vector< uint8_t > coverage( size * size );
+
+        const auto center = ( float ) size * 0.5f;
+
+        for( size_t y = 0; y < size; ++y ) {
+            for( size_t x = 0; x < size; ++x ) {
+                const auto dx = ( float ) x + 0.5f - center;
+                const auto dy = ( float ) y + 0.5f - center;
+
+                coverage[ y * size + x ] = dx * dx + dy * dy <= radius * radius ? 255 : 0;
+            }
+        }
+
+        return coverage;
+    }
+
+}
+
+TEST( sdf_rejects_bad_parameters ) {
+    const uint8_t coverage[ 4 ] = { 255, 255, 255, 255 };
+
+    std::vector< uint8_t > pixels;
+    size_t                 width, height;
+
+    CHECK( !Sdf::generate( coverage, 2, 2, 2, 0, 4, pixels, width, height ) );
+    CHECK( !Sdf::generate( coverage, 2, 2, 2, 4, 0, pixels, width, height ) );
+
+    // empty glyphs succeed without pixels
+    CHECK( Sdf::generate( nullptr, 0, 0, 0, 4, 4, pixels, width, height ) );
+    CHECK( width == 0 && height == 0 && pixels.empty() );
+}
+
+TEST( sdf_disc_matches_analytic_distance ) {
+    constexpr size_t size = 64, supersample = 4, spread = 4;
+    constexpr float  radius = 24.f;
+
+    const auto coverage = disc( size, radius );
+
+    std::vector< uint8_t > pixels;
+    size_t                 width, height;
+
+    CHECK( Sdf::generate( coverage.data(), size, size, size, supersample, spread, pixels, width, height ) );
+    CHECK( width == size / supersample + spread * 2 );
+    CHECK( height == size / supersample + spread * 2 );
+    CHECK( pixels.size() == width * height );
+
+    if( pixels.size() != width * height )
+        return;
+
+    // the output is padded by spread pixels, the disc center sits in the middle
+    const auto center = ( float ) width * 0.5f;
+
+    size_t off = 0;
+
+    for( size_t y = 0; y < height; ++y ) {
+        for( size_t x = 0; x < width; ++x ) {
+            const auto dx = ( float ) x + 0.5f - center;
+            const auto dy = ( float ) y + 0.5f - center;
+
+            // signed distance in output pixels, positive inside
+            const auto distance = radius / ( float ) supersample - std::sqrt( dx * dx + dy * dy );
+            const auto expected = std::clamp( 0.5f + distance / ( 2.f * ( float ) spread ), 0.f, 1.f ) * 255.f;
+
+            // a pixel of slack for the rasterized edge
+            if( std::fabs( ( float ) pixels[ y * width + x ] - expected ) > 255.f / ( 2.f * spread ) )
+                ++off;
+        }
+    }
+
+    CHECK( off == 0 );
+
+    // far corners clamp to fully outside, the center saturates inside
+    CHECK( pixels[ 0 ] == 0 );
+    CHECK( pixels[ width * height - 1 ] == 0 );
+    CHECK( pixels[ ( height / 2 ) * width + width / 2 ] == 255 );
+}
+
+TEST( sdf_honors_padded_and_bottom_up_pitch ) {
+    constexpr size_t size = 32, padded = 48;
+
+    const auto coverage = disc( size, 11.f );
+
+    // same rows, once padded and once stored bottom up with a negative pitch
+    std::vector< uint8_t > with_padding( padded * size, 0x5a ), bottom_up( size * size );
+
+    for( size_t y = 0; y < size; ++y ) {
+        std::memcpy( &with_padding[ y * padded ], &coverage[ y * size ], size );
+        std::memcpy( &bottom_up[ ( size - 1 - y ) * size ], &coverage[ y * size ], size );
+    }
+
+    std::vector< uint8_t > tight_pixels, padded_pixels, bottom_up_pixels;
+    size_t                 width, height, padded_width, padded_height, bottom_up_width, bottom_up_height;
+
+    CHECK( Sdf::generate( coverage.data(), size, size, size, 2, 3, tight_pixels, width, height ) );
+    CHECK( Sdf::generate( with_padding.data(), size, size, padded, 2, 3, padded_pixels, padded_width, padded_height ) );
+    CHECK( Sdf::generate( &bottom_up[ ( size - 1 ) * size ], size, size, -( ptrdiff_t ) size, 2, 3, bottom_up_pixels, bottom_up_width, bottom_up_height ) );
+
+    CHECK( padded_width == width && padded_height == height && padded_pixels == tight_pixels );
+    CHECK( bottom_up_width == width && bottom_up_height == height && bottom_up_pixels == tight_pixels );
+}
+
+TEST( sdf_font_glyphs_are_distance_fields ) {
+    const auto &path = Test::font_path();
+    if( path.empty() )
+        return;
+
+    MockDevice  device( 1920, 1080 );
+    FontManager manager;
+    Font        font;
+
+    CHECK( manager.init() );
+    CHECK( font.init( &device, &manager, nullptr, path, 16, true, Font::CREATE_SDF ) );
+    CHECK( font.m_sdf );
+
+    // a plain vertical bar, inside at its middle and far outside in the spread padding
+    const auto glyph = font.find_glyph( 'I' );
+    CHECK( glyph && glyph->m_texture );
+
+    if( !glyph || !glyph->m_texture )
+        return;
+
+    const auto &page    = font.m_pages[ glyph->m_page ];
+    const auto texture  = static_cast< MockTexture * >( glyph->m_texture );
+    const auto texel    = [ & ]( float u, float v ) {
+        return texture->get_row( ( size_t ) ( v * ( float ) page.m_height ) )[ ( size_t ) ( u * ( float ) page.m_width ) ];
+    };
+
+    const auto center = ( glyph->m_uv_min + glyph->m_uv_max ) * 0.5f;
+
+    CHECK( page.m_format == D3DFMT_A8 );
+    CHECK( texel( center.x, center.y ) > 160 );
+    CHECK( texel( glyph->m_uv_min.x, glyph->m_uv_min.y ) < 64 );
+
+    font.release();
+}
@@ -0,0 +1,30 @@
+// shape tessellation on the mock device
+#include "includes.h"
+#include "mock_device.h"
+#include "test.h"
+
+TEST( thick_arc_past_its_radius_is_a_sector ) {
+    MockRenderer_t mock;
+    CHECK( mock.m_ready );
+
+    auto      &renderer = mock.m_renderer;
+    const auto device   = mock.m_device.get();
+    const auto color    = Color::from_argb( 0xff2080c0 );
+
+    // both outer radii are 30, the default 0.25 pixel circle error picks the segment count
+    const auto segments = Math::circle_segments( 30.f, 0.25f );
+
+    // band, two triangles per segment
+    renderer.draw_arc( { 500.f, 500.f }, 25.f, 0.f, Math::pi_2, color, 5.f );
+
+    device->reset_stats();
+    renderer.render();
+    CHECK( device->get_stats().m_primitives == segments * 2 );
+
+    // the inner radius stops at the center, one triangle per segment instead of a band folded through it
+    renderer.draw_arc( { 500.f, 500.f }, 10.f, 0.f, Math::pi_2, color, 20.f );
+
+    device->reset_stats();
+    renderer.render();
+    CHECK( device->get_stats().m_primitives == segments );
+}
@@ -0,0 +1,188 @@
+// sprite atlas packing, padding, the atlas file and sprites batching on the mock device
+#include <cstdio>
+#include "includes.h"
+#include "mock_device.h"
+#include "test.h"
+
+namespace {
+
+    // solid image with a distinct corner so flips and offsets show
+    std::vector< uint32_t > make_image( size_t width, size_t height, uint32_t color ) {
+        std::vector< uint32_t > pixels( width * height, color );
+        pixels[ 0 ] = 0xff000000 | ( color ^ 0x00ffffff );
+
+        return pixels;
+    }
+
+    uint32_t page_pixel( const SpriteAtlas &atlas, const SpriteAtlas::Sprite_t &sprite, int x, int y ) {
+        const auto &page = atlas.get_pages()[ sprite.m_page ];
+
+        return page.m_pixels[ ( sprite.m_y + y ) * page.m_width + sprite.m_x + x ];
+    }
+
+    // every pixel of the sprite and the padding ring around it repeating its edges
+    bool sprite_matches( const SpriteAtlas &atlas, const SpriteAtlas::Sprite_t &sprite, const std::vector< uint32_t > &pixels, int padding ) {
+        const int width  = ( int ) sprite.m_width;
+        const int height = ( int ) sprite.m_height;
+
+        for( int y = -padding; y < height + padding; ++y ) {
+            for( int x = -padding; x < width + padding; ++x ) {
+                const auto inner_x = std::clamp( x, 0, width - 1 );
+                const auto inner_y = std::clamp( y, 0, height - 1 );
+
+                if( page_pixel( atlas, sprite, x, y ) != pixels[ inner_y * width + inner_x ] )
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+}
+
+TEST( sprite_atlas_packs_padded_sprites ) {
+    SpriteAtlas                            atlas;
+    std::vector< std::vector< uint32_t > > images;
+
+    const size_t sizes[][ 2 ] = { { 8, 8 }, { 20, 6 }, { 5, 17 }, { 12, 12 }, { 3, 3 }, { 30, 9 }, { 100, 40 } };
+
+    for( size_t i = 0; i < 7; ++i ) {
+        images.push_back( make_image( sizes[ i ][ 0 ], sizes[ i ][ 1 ], 0xff102030 + ( uint32_t ) i * 0x00101010 ) );
+
+        CHECK( atlas.add_image( "icon" + std::to_string( i ), sizes[ i ][ 0 ], sizes[ i ][ 1 ], images.back().data() ) );
+    }
+
+    CHECK( !atlas.add_image( "icon0", 1, 1, images[ 0 ].data() ) );
+    CHECK( !atlas.add_image( "empty", 0, 1, images[ 0 ].data() ) );
+
+    CHECK( atlas.build( 64, 2 ) );
+
+    const auto &sprites = atlas.get_sprites();
+    CHECK( sprites.size() == 7 );
+    if( sprites.size() != 7 )
+        return;
+
+    // the 100x40 image doesn't fit a 64 page and gets a bigger one of its own
+    const auto &big = sprites[ 6 ];
+    CHECK( atlas.get_pages()[ big.m_page ].m_width == 128 && atlas.get_pages()[ big.m_page ].m_height == 64 );
+
+    for( size_t i = 0; i < sprites.size(); ++i ) {
+        const auto &sprite = sprites[ i ];
+        const auto &page   = atlas.get_pages()[ sprite.m_page ];
+
+        // ids in the order images were added, packing order doesn't matter
+        CHECK( atlas.find( "icon" + std::to_string( i ) ) == i );
+        CHECK( sprite.m_width == sizes[ i ][ 0 ] && sprite.m_height == sizes[ i ][ 1 ] );
+        CHECK( sprite.m_x >= 2 && sprite.m_y >= 2 && sprite.m_x + sprite.m_width + 2 <= page.m_width && sprite.m_y + sprite.m_height + 2 <= page.m_height );
+        CHECK( sprite.m_u0 == ( float ) sprite.m_x / page.m_width && sprite.m_v1 == ( float ) ( sprite.m_y + sprite.m_height ) / page.m_height );
+        CHECK( sprite_matches( atlas, sprite, images[ i ], 2 ) );
+
+        // padded rects never overlap
+        for( size_t j = 0; j < i; ++j ) {
+            const auto &other = sprites[ j ];
+
+            if( other.m_page == sprite.m_page )
+                CHECK( sprite.m_x + sprite.m_width + 2 <= other.m_x - 2 || other.m_x + other.m_width + 2 <= sprite.m_x - 2
+                    || sprite.m_y + sprite.m_height + 2 <= other.m_y - 2 || other.m_y + other.m_height + 2 <= sprite.m_y - 2 );
+        }
+    }
+
+    CHECK( atlas.find( "missing" ) == invalid_sprite_id );
+    CHECK( !atlas.get_sprite( invalid_sprite_id ) );
+}
+
+TEST( sprite_atlas_rejects_bad_page_sizes ) {
+    SpriteAtlas atlas;
+
+    const auto image = make_image( 8, 8, 0xff204060 );
+
+    CHECK( atlas.add_image( "icon", 8, 8, image.data() ) );
+
+    // a failed build packs nothing and keeps the images queued
+    CHECK( !atlas.build( 0 ) );
+    CHECK( !atlas.build( SpriteAtlas::min_page_size - 1 ) );
+    CHECK( !atlas.build( SpriteAtlas::max_page_size + 1 ) );
+    CHECK( atlas.get_sprites().empty() && atlas.get_pages().empty() );
+
+    const auto wide = make_image( SpriteAtlas::max_page_size, 1, 0xff204060 );
+
+    CHECK( atlas.add_image( "wide", SpriteAtlas::max_page_size, 1, wide.data() ) );
+    CHECK( !atlas.build( 64, 1 ) );
+
+    // dropped images free their names
+    atlas.drop_images();
+    CHECK( atlas.find( "icon" ) == invalid_sprite_id && atlas.find( "wide" ) == invalid_sprite_id );
+
+    CHECK( atlas.add_image( "icon", 8, 8, image.data() ) );
+    CHECK( atlas.build( 64 ) );
+    CHECK( atlas.get_sprites().size() == 1 && atlas.find( "icon" ) == 0 );
+}
+
+TEST( sprite_atlas_round_trips_through_file ) {
+    Test::TempDir_t dir;
+    SpriteAtlas     atlas, loaded;
+
+    const auto path = ( dir.m_path / "icons.atlas" ).string();
+
+    const auto first  = make_image( 16, 16, 0xff204060 );
+    const auto second = make_image( 7, 11, 0x80ff8000 );
+
+    CHECK( atlas.add_image( "first", 16, 16, first.data() ) );
+    CHECK( atlas.add_image( "second", 7, 11, second.data() ) );
+    CHECK( atlas.build( 64 ) && atlas.save( path ) );
+
+    CHECK( loaded.load( path ) );
+    CHECK( loaded.get_sprites().size() == 2 && loaded.get_pages().size() == atlas.get_pages().size() );
+
+    for( size_t i = 0; i < loaded.get_sprites().size() && i < 2; ++i ) {
+        const auto &a = atlas.get_sprites()[ i ];
+        const auto &b = loaded.get_sprites()[ i ];
+
+        CHECK( a.m_name == b.m_name && a.m_page == b.m_page && a.m_x == b.m_x && a.m_y == b.m_y && a.m_width == b.m_width && a.m_height == b.m_height );
+        CHECK( a.m_u0 == b.m_u0 && a.m_v0 == b.m_v0 && a.m_u1 == b.m_u1 && a.m_v1 == b.m_v1 );
+    }
+
+    for( size_t i = 0; i < loaded.get_pages().size(); ++i )
+        CHECK( loaded.get_pages()[ i ].m_pixels == atlas.get_pages()[ i ].m_pixels );
+
+    CHECK( loaded.find( "second" ) == 1 );
+
+    // a truncated file leaves the atlas empty
+    std::filesystem::resize_file( path, std::filesystem::file_size( path ) - 3 );
+
+    CHECK( !loaded.load( path ) );
+    CHECK( loaded.get_sprites().empty() && loaded.get_pages().empty() && loaded.find( "first" ) == invalid_sprite_id );
+
+    CHECK( !loaded.load( ( dir.m_path / "missing.atlas" ).string() ) );
+}
+
+TEST( sprites_on_one_page_draw_in_one_call ) {
+    Test::TempDir_t dir;
+    SpriteAtlas     atlas;
+
+    const auto path  = ( dir.m_path / "icons.atlas" ).string();
+    const auto image = make_image( 16, 16, 0xffffffff );
+
+    for( size_t i = 0; i < 32; ++i )
+        atlas.add_image( "icon" + std::to_string( i ), 16, 16, image.data() );
+
+    CHECK( atlas.build( 256 ) && atlas.save( path ) );
+
+    MockRenderer_t mock;
+    CHECK( mock.m_ready );
+
+    auto      &renderer = mock.m_renderer;
+    const auto device   = mock.m_device.get();
+
+    CHECK( renderer.load_sprite_atlas( path ) );
+    CHECK( renderer.find_sprite( "icon31" ) == 31 );
+
+    for( size_t i = 0; i < 32; ++i )
+        renderer.draw_sprite( i, { ( float ) i * 20.f, 10.f } );
+
+    device->reset_stats();
+    renderer.render();
+
+    CHECK( device->get_stats().m_draw_calls == 1 );
+    CHECK( device->get_stats().m_primitives == 64 );
+}
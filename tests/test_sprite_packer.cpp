@@ -0,0 +1,68 @@
+// sprite_packer end to end, pngs in and an atlas file out. only built where libpng is found
+#include <cstring>
+#include <png.h>
+#include "sprite_atlas.h"
+#include "test.h"
+
+namespace {
+
+    // argb rows as a png, the layout sprite_packer decodes to
+    bool write_png( const std::filesystem::path &path, size_t width, size_t height, const uint32_t *pixels ) {
+        png_image image;
+
+        std::memset( &image, 0, sizeof( image ) );
+        image.version = PNG_IMAGE_VERSION;
+        image.width   = ( png_uint_32 ) width;
+        image.height  = ( png_uint_32 ) height;
+        image.format  = PNG_FORMAT_BGRA;
+
+        return png_image_write_to_file( &image, path.string().c_str(), 0, pixels, 0, nullptr ) != 0;
+    }
+
+}
+
+TEST( sprite_packer_writes_a_loadable_atlas ) {
+    Test::TempDir_t dir;
+    SpriteAtlas     atlas;
+
+    std::vector< uint32_t > marker( 12 * 9, 0xffff0000 ), weapon( 30 * 10, 0x8000ff00 );
+    marker[ 0 ] = 0xff0000ff;
+    weapon[ 5 ] = 0xffffffff;
+
+    CHECK( write_png( dir.m_path / "marker.png", 12, 9, marker.data() ) );
+    CHECK( write_png( dir.m_path / "weapon.png", 30, 10, weapon.data() ) );
+
+    const auto output  = dir.m_path / "icons.atlas";
+    const auto command = std::string( SPRITE_PACKER ) + " -s 64 -p 1 " + output.string() + " " + ( dir.m_path / "marker.png" ).string() + " " 
+        + ( dir.m_path / "weapon.png" ).string() + " > /dev/null";
+
+    CHECK( std::system( command.c_str() ) == 0 );
+    CHECK( atlas.load( output.string() ) );
+
+    // named after the files, ids in command line order
+    CHECK( atlas.find( "marker" ) == 0 && atlas.find( "weapon" ) == 1 );
+
+    const auto check_pixels = [ & ]( sprite_id_t sprite_id, const std::vector< uint32_t > &pixels ) {
+        const auto sprite = atlas.get_sprite( sprite_id );
+        if( !sprite )
+            return false;
+
+        const auto &page = atlas.get_pages()[ sprite->m_page ];
+
+        for( size_t y = 0; y < sprite->m_height; ++y ) {
+            if( std::memcmp( &page.m_pixels[ ( sprite->m_y + y ) * page.m_width + sprite->m_x ], &pixels[ y * sprite->m_width ], sprite->m_width * sizeof( uint32_t ) ) )
+                return false;
+        }
+
+        return true;
+    };
+
+    CHECK( check_pixels( 0, marker ) );
+    CHECK( check_pixels( 1, weapon ) );
+
+    // unreadable input fails without writing
+    const auto bad = std::string( SPRITE_PACKER ) + " " + ( dir.m_path / "bad.atlas" ).string() + " " + ( dir.m_path / "missing.png" ).string() + " 2> /dev/null";
+
+    CHECK( std::system( bad.c_str() ) != 0 );
+    CHECK( !std::filesystem::exists( dir.m_path / "bad.atlas" ) );
+}
@@ -0,0 +1,107 @@
+// texture handles, generations and eviction on the mock device
+#include "includes.h"
+#include "mock_device.h"
+#include "test.h"
+
+namespace {
+
+    IDirect3DTexture9 *create_texture( MockDevice *device, UINT size ) {
+        IDirect3DTexture9 *texture = nullptr;
+
+        device->CreateTexture( size, size, 1, 0, D3DFMT_A8R8G8B8, D3DPOOL_MANAGED, &texture, nullptr );
+
+        return texture;
+    }
+
+}
+
+TEST( texture_handles_go_stale_on_remove ) {
+    MockRenderer_t mock;
+    CHECK( mock.m_ready );
+
+    const auto device   = mock.m_device.get();
+    const auto textures = device->get_stats().m_textures; // the renderer's own
+
+    TextureManager manager;
+
+    const auto first = manager.add( create_texture( device, 16 ), TextureManager::user_group );
+    CHECK( first != invalid_texture_handle );
+    CHECK( manager.acquire( first ) );
+
+    manager.remove( first );
+    CHECK( !manager.acquire( first ) );
+
+    // same slot, next generation
+    const auto second = manager.add( create_texture( device, 16 ), TextureManager::user_group );
+    CHECK( ( second & 0xffffffff ) == ( first & 0xffffffff ) && second != first );
+    CHECK( !manager.acquire( first ) && manager.acquire( second ) );
+
+    CHECK( manager.add( nullptr, TextureManager::user_group ) == invalid_texture_handle );
+
+    manager.release();
+    CHECK( device->get_stats().m_textures == textures );
+}
+
+TEST( texture_handles_go_stale_on_release ) {
+    MockRenderer_t mock;
+    CHECK( mock.m_ready );
+
+    const auto device   = mock.m_device.get();
+    const auto textures = device->get_stats().m_textures; // the renderer's own
+
+    TextureManager manager;
+
+    const auto first  = manager.add( create_texture( device, 16 ), TextureManager::user_group );
+    const auto second = manager.add( create_texture( device, 32 ), TextureManager::user_group );
+
+    manager.release();
+
+    CHECK( device->get_stats().m_textures == textures );
+    CHECK( manager.get_footprint().m_textures == 0 && manager.get_footprint().m_resident_bytes == 0 );
+    CHECK( !manager.acquire( first ) && !manager.acquire( second ) );
+
+    // textures added after a release take the old slots but never answer to the old handles
+    const auto third  = manager.add( create_texture( device, 16 ), TextureManager::user_group );
+    const auto fourth = manager.add( create_texture( device, 64 ), TextureManager::user_group );
+
+    CHECK( ( third & 0xffffffff ) == ( first & 0xffffffff ) && ( fourth & 0xffffffff ) == ( second & 0xffffffff ) );
+    CHECK( !manager.acquire( first ) && !manager.acquire( second ) );
+    CHECK( manager.acquire( third ) && manager.acquire( fourth ) );
+    CHECK( manager.get_bytes( fourth ) == 64 * 64 * 4 );
+}
+
+TEST( textures_over_budget_are_evicted_and_reloaded ) {
+    MockRenderer_t mock;
+    CHECK( mock.m_ready );
+
+    const auto device   = mock.m_device.get();
+    const auto textures = device->get_stats().m_textures; // the renderer's own
+
+    TextureManager manager;
+    size_t         evicted = 0;
+
+    manager.set_budget( 64 * 64 * 4 );
+
+    const auto loader = [ & ]() {
+        return create_texture( device, 64 );
+    };
+
+    const auto old_page = manager.add( create_texture( device, 64 ), 0, loader, [ & ]() { ++evicted; } );
+    const auto new_page = manager.add( create_texture( device, 64 ), 0, loader );
+
+    // both used this frame, nothing goes
+    CHECK( manager.end_frame() == 0 );
+
+    // only the least recently used one goes
+    manager.acquire( new_page );
+    CHECK( manager.end_frame() == 1 );
+    CHECK( evicted == 1 );
+    CHECK( manager.get_bytes( old_page ) == 0 && manager.get_bytes( new_page ) == 64 * 64 * 4 );
+
+    // used again, the loader brings it back
+    CHECK( manager.acquire( old_page ) );
+    CHECK( manager.get_footprint().m_reloads == 1 && manager.get_group_bytes( 0 ) == 2 * 64 * 64 * 4 );
+
+    manager.release();
+    CHECK( device->get_stats().m_textures == textures );
+}
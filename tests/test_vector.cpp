@@ -0,0 +1,124 @@
+// vector.h simd path against the scalar fallback, and the vertex kernels against their scalar definitions
+#include "includes.h"
+#include "test.h"
+
+namespace Scalar {
+
+    void vector_ops( const float *in, size_t count, std::vector< float > &exact, std::vector< float > &approx );
+
+}
+
+namespace Native {
+
+#include "vector_ops.h"
+
+}
+
+namespace {
+
+    // fixed pseudo random values in [ -100, 100 ], none close to zero so they divide
+    std::vector< float > vector_inputs( size_t count ) {
+        std::vector< float > values( count );
+
+        uint32_t seed = 0x2545f491;
+
+        for( auto &value : values ) {
+            seed  = seed * 1664525u + 1013904223u;
+            value = ( float ) ( ( int ) ( ( seed >> 8 ) % 20001 ) - 10000 ) / 100.f;
+
+            if( std::fabs( value ) < 0.01f )
+                value = 0.75f;
+        }
+
+        return values;
+    }
+
+    bool close( float a, float b ) {
+        return std::fabs( a - b ) <= 1e-5f * std::max( 1.f, std::max( std::fabs( a ), std::fabs( b ) ) );
+    }
+
+}
+
+TEST( vector_simd_matches_scalar ) {
+#if !defined( VECTOR_SIMD ) && ( defined( __SSE2__ ) || defined( __aarch64__ ) )
+    // would compare the scalar path with itself
+    CHECK( !"VECTOR_SIMD not enabled on a simd host" );
+#endif
+
+    const auto in = vector_inputs( 8 * 64 + 6 );
+
+    std::vector< float > exact, approx, scalar_exact, scalar_approx;
+
+    Native::vector_ops( in.data(), in.size(), exact, approx );
+    Scalar::vector_ops( in.data(), in.size(), scalar_exact, scalar_approx );
+
+    CHECK( exact.size() == scalar_exact.size() );
+    CHECK( approx.size() == scalar_approx.size() );
+
+    size_t exact_mismatches = 0, approx_mismatches = 0;
+
+    for( size_t i = 0; i < std::min( exact.size(), scalar_exact.size() ); ++i ) {
+        if( std::memcmp( &exact[ i ], &scalar_exact[ i ], sizeof( float ) ) )
+            ++exact_mismatches;
+    }
+
+    for( size_t i = 0; i < std::min( approx.size(), scalar_approx.size() ); ++i ) {
+        if( !close( approx[ i ], scalar_approx[ i ] ) )
+            ++approx_mismatches;
+    }
+
+    CHECK( exact_mismatches == 0 );
+    CHECK( approx_mismatches == 0 );
+}
+
+TEST( vertex_kernels_match_scalar ) {
+    const auto in = vector_inputs( 14 );
+
+    // 7 vertices, the from_points pair loop and its tail
+    std::vector< Vec2_t > points;
+
+    for( size_t i = 0; i < in.size(); i += 2 )
+        points.emplace_back( in[ i ], in[ i + 1 ] );
+
+    const auto color = Color::from_argb( 0xff2080c0 );
+
+    std::vector< Vertex_t > vertices( points.size() );
+    VertexKernels::from_points( vertices.data(), points.data(), points.size(), color );
+
+    for( size_t i = 0; i < points.size(); ++i ) {
+        CHECK( vertices[ i ].m_pos == Vec4_t( points[ i ].x, points[ i ].y, 1.f, 1.f ) );
+        CHECK( vertices[ i ].m_color == 0xff2080c0 );
+    }
+
+    const Vec2_t delta = { 3.5f, -2.25f };
+    VertexKernels::translate( vertices.data(), vertices.size(), delta );
+
+    for( size_t i = 0; i < points.size(); ++i )
+        CHECK( vertices[ i ].m_pos == Vec4_t( points[ i ].x + delta.x, points[ i ].y + delta.y, 1.f, 1.f ) );
+
+    const Vec2_t origin = { 10.f, 20.f };
+    const auto   offset = origin - origin * 2.f;
+    VertexKernels::scale( vertices.data(), vertices.size(), origin, 2.f );
+
+    for( size_t i = 0; i < points.size(); ++i ) {
+        const auto &pos = vertices[ i ].m_pos;
+
+        CHECK( close( pos.x, ( points[ i ].x + delta.x ) * 2.f + offset.x ) );
+        CHECK( close( pos.y, ( points[ i ].y + delta.y ) * 2.f + offset.y ) );
+        CHECK( pos.z == 1.f && pos.w == 1.f );
+    }
+}
+
+TEST( unit_circle_kernel_matches_scalar ) {
+    const auto in = vector_inputs( 14 );
+
+    // 7 entries, one simd step and its tail
+    std::vector< float > cos( in.begin(), in.begin() + 7 ), sin( in.begin() + 7, in.end() );
+    std::vector< Vec2_t > points( 7 );
+
+    const Vec2_t pos = { 10.f, 20.f };
+    VertexKernels::from_unit_circle( points.data(), cos.data(), sin.data(), points.size(), pos, 2.5f );
+
+    for( size_t i = 0; i < points.size(); ++i )
+        CHECK( close( points[ i ].x, cos[ i ] * 2.5f + pos.x ) && close( points[ i ].y, sin[ i ] * 2.5f + pos.y ) );
+}
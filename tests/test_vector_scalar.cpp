@@ -0,0 +1,19 @@
+// scalar reference for test_vector.cpp. vector.h is compiled with VECTOR_NO_SIMD inside its own namespace so
+// both versions link into one binary without clashing
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#ifndef FORCEINLINE
+    #define FORCEINLINE inline
+#endif
+
+#define VECTOR_NO_SIMD
+
+namespace Scalar {
+
+#include "vector.h"
+#include "vector_ops.h"
+
+}
@@ -0,0 +1,98 @@
+// one fixed sequence of vector operations, compiled twice: against the simd vector.h in test_vector.cpp and
+// against the scalar fallback in test_vector_scalar.cpp. included inside a namespace, so no includes here, the
+// including file provides Vector2 / Vector4 / VectorKernels and <vector>
+//
+// m_exact results must match bit for bit, m_approx ones only closely ( summation order, fused multiply-add,
+// reciprocal square root estimates )
+void vector_ops( const float *in, size_t count, std::vector< float > &exact, std::vector< float > &approx ) {
+    const auto push2 = []( std::vector< float > &out, const Vector2 &v ) {
+        out.push_back( v.x );
+        out.push_back( v.y );
+    };
+
+    const auto push4 = []( std::vector< float > &out, const Vector4 &v ) {
+        out.push_back( v.x );
+        out.push_back( v.y );
+        out.push_back( v.z );
+        out.push_back( v.w );
+    };
+
+    for( size_t i = 0; i + 8 <= count; i += 8 ) {
+        Vector2 a( in[ i ], in[ i + 1 ] ), b( in[ i + 2 ], in[ i + 3 ] );
+
+        const auto s = in[ i + 4 ];
+
+        push2( exact, a + b );
+        push2( exact, a - b );
+        push2( exact, a * b );
+        push2( exact, a / b );
+        push2( exact, a + s );
+        push2( exact, a - s );
+        push2( exact, a * s );
+        push2( exact, a / s );
+
+        auto c = a;
+        push2( exact, c += b );
+        push2( exact, c -= a );
+        push2( exact, c *= b );
+        push2( exact, c /= a );
+        push2( exact, c += s );
+        push2( exact, c -= s );
+        push2( exact, c *= s );
+        push2( exact, c /= s );
+
+        exact.push_back( a.cross( b ) );
+
+        approx.push_back( a.dot( b ) );
+        approx.push_back( a.len_2d_sqr() );
+        approx.push_back( a.len_2d() );
+        approx.push_back( a.dist( b ) );
+        push2( approx, a.normalized() );
+        push2( approx, a.normalized_fast() );
+
+        Vector4 p( in[ i ], in[ i + 1 ], in[ i + 2 ], in[ i + 3 ] ), q( in[ i + 4 ], in[ i + 5 ], in[ i + 6 ], in[ i + 7 ] );
+
+        push4( exact, p + q );
+        push4( exact, p - q );
+        push4( exact, p * q );
+        push4( exact, p / q );
+        push4( exact, p * s );
+        push4( exact, p / s );
+
+        auto r = p;
+        push4( exact, r += q );
+        push4( exact, r *= s );
+        push4( exact, r /= q );
+
+        approx.push_back( p.dot( q ) );
+        approx.push_back( p.len() );
+        push4( approx, p.normalized() );
+    }
+
+    // odd point count so the kernels run both the 2-wide body and the scalar tail
+    std::vector< Vector2 > points;
+
+    for( size_t i = 0; i + 2 <= count; i += 2 )
+        points.emplace_back( in[ i ], in[ i + 1 ] );
+
+    if( !( points.size() & 1 ) )
+        points.pop_back();
+
+    auto moved = points;
+    VectorKernels::translate( moved.data(), moved.size(), { in[ 0 ], in[ 1 ] } );
+
+    for( const auto &point : moved )
+        push2( exact, point );
+
+    auto scaled = points;
+    VectorKernels::scale( scaled.data(), scaled.size(), { in[ 2 ], in[ 3 ] }, 1.75f );
+
+    for( const auto &point : scaled )
+        push2( approx, point );
+
+    std::vector< Vector4 > wide( points.size() );
+    VectorKernels::widen( points.data(), wide.data(), points.size(), 0.5f, 1.f );
+
+    for( const auto &point : wide )
+        push4( exact, point );
+}
@@ -0,0 +1,254 @@
+#include "includes.h"
+
+NOINLINE TextureManager::TextureEntry_t *TextureManager::find( texture_handle_t handle ) {
+    const auto index = ( size_t ) ( handle & 0xffffffff );
+
+    if( handle == invalid_texture_handle || index >= m_entries.size() )
+        return nullptr;
+
+    auto &entry = m_entries[ index ];
+    if( !entry.m_used || entry.m_generation != ( uint32_t ) ( handle >> 32 ) )
+        return nullptr;
+
+    return &entry;
+}
+
+NOINLINE const TextureManager::TextureEntry_t *TextureManager::find( texture_handle_t handle ) const {
+    return const_cast< TextureManager * >( this )->find( handle );
+}
+
+NOINLINE void TextureManager::unload( TextureEntry_t &entry ) {
+    if( !entry.m_texture )
+        return;
+
+    Utils::safe_release( &entry.m_texture );
+
+    m_footprint.m_resident--;
+    m_footprint.m_resident_bytes -= entry.m_bytes;
+
+    entry.m_bytes = 0;
+}
+
+NOINLINE texture_handle_t TextureManager::add( IDirect3DTexture9 *texture, size_t group, texture_loader_t loader, texture_evict_t on_evict ) {
+    size_t index;
+
+    if( !texture )
+        return invalid_texture_handle;
+
+    // reuse a free slot, its generation was bumped when it was freed
+    if( !m_free.empty() ) {
+        index = m_free.back();
+        m_free.pop_back();
+    }
+
+    else {
+        index = m_entries.size();
+        m_entries.emplace_back();
+    }
+
+    auto &entry = m_entries[ index ];
+    entry.m_texture    = texture;
+    entry.m_bytes      = get_texture_bytes( texture );
+    entry.m_group      = group;
+    entry.m_last_frame = m_frame;
+    entry.m_used       = true;
+    entry.m_loader     = std::move( loader );
+    entry.m_on_evict   = std::move( on_evict );
+
+    m_footprint.m_textures++;
+    m_footprint.m_resident++;
+    m_footprint.m_resident_bytes += entry.m_bytes;
+
+    return ( ( texture_handle_t ) entry.m_generation << 32 ) | index;
+}
+
+NOINLINE void TextureManager::remove( texture_handle_t handle ) {
+    const auto entry = find( handle );
+    if( !entry )
+        return;
+
+    unload( *entry );
+
+    entry->m_used = false;
+    entry->m_generation++;
+    entry->m_loader   = nullptr;
+    entry->m_on_evict = nullptr;
+
+    m_footprint.m_textures--;
+
+    m_free.push_back( ( size_t ) ( handle & 0xffffffff ) );
+}
+
+NOINLINE IDirect3DTexture9 *TextureManager::acquire( texture_handle_t handle ) {
+    const auto entry = find( handle );
+    if( !entry )
+        return nullptr;
+
+    entry->m_last_frame = m_frame;
+
+    if( entry->m_texture )
+        return entry->m_texture;
+
+    // evicted, load it again
+    if( !entry->m_loader )
+        return nullptr;
+
+    entry->m_texture = entry->m_loader();
+    if( !entry->m_texture )
+        return nullptr;
+
+    entry->m_bytes = get_texture_bytes( entry->m_texture );
+
+    m_footprint.m_resident++;
+    m_footprint.m_resident_bytes += entry->m_bytes;
+    m_footprint.m_reloads++;
+
+    return entry->m_texture;
+}
+
+NOINLINE size_t TextureManager::end_frame() {
+    size_t evicted;
+
+    PROFILE_FUNCTION();
+
+    evicted = 0;
+
+    if( m_footprint.m_budget && m_footprint.m_resident_bytes > m_footprint.m_budget ) {
+        // evictable textures that weren't used this frame, oldest first
+        m_candidates.clear();
+
+        for( size_t i = 0; i < m_entries.size(); ++i ) {
+            const auto &entry = m_entries[ i ];
+
+            if( entry.m_used && entry.m_texture && entry.m_loader && entry.m_last_frame < m_frame )
+                m_candidates.push_back( i );
+        }
+
+        std::sort( m_candidates.begin(), m_candidates.end(), [ & ]( size_t a, size_t b ) {
+            return m_entries[ a ].m_last_frame < m_entries[ b ].m_last_frame;
+        } );
+
+        for( const auto index : m_candidates ) {
+            if( m_footprint.m_resident_bytes <= m_footprint.m_budget )
+                break;
+
+            auto &entry = m_entries[ index ];
+
+            if( entry.m_on_evict )
+                entry.m_on_evict();
+
+            unload( entry );
+
+            ++evicted;
+        }
+
+        m_footprint.m_evictions += evicted;
+    }
+
+    m_frame++;
+
+    return evicted;
+}
+
+NOINLINE void TextureManager::release() {
+    // slots stay with their generation bumped like remove, handles from before never alias the textures added after
+    for( auto &entry : m_entries ) {
+        Utils::safe_release( &entry.m_texture );
+
+        if( entry.m_used )
+            entry.m_generation++;
+
+        entry.m_bytes    = 0;
+        entry.m_used     = false;
+        entry.m_loader   = nullptr;
+        entry.m_on_evict = nullptr;
+    }
+
+    // lowest slots are handed out first again
+    m_free.clear();
+
+    for( size_t i = m_entries.size(); i > 0; --i )
+        m_free.push_back( i - 1 );
+
+    // keep the budget and totals, only the live counts go away
+    m_footprint.m_textures       = 0;
+    m_footprint.m_resident       = 0;
+    m_footprint.m_resident_bytes = 0;
+}
+
+NOINLINE size_t TextureManager::get_bytes( texture_handle_t handle ) const {
+    const auto entry = find( handle );
+
+    return entry ? entry->m_bytes : 0;
+}
+
+NOINLINE size_t TextureManager::get_group_bytes( size_t group ) const {
+    size_t bytes = 0;
+
+    for( const auto &entry : m_entries ) {
+        if( entry.m_used && entry.m_group == group )
+            bytes += entry.m_bytes;
+    }
+
+    return bytes;
+}
+
+NOINLINE size_t TextureManager::get_texture_bytes( IDirect3DTexture9 *texture ) {
+    D3DSURFACE_DESC desc;
+    size_t          bytes;
+
+    if( !texture )
+        return 0;
+
+    bytes = 0;
+
+    for( DWORD level = 0; level < texture->GetLevelCount(); ++level ) {
+        if( texture->GetLevelDesc( level, &desc ) < 0 )
+            continue;
+
+        const size_t pixels = ( size_t ) desc.Width * desc.Height;
+
+        switch( desc.Format ) {
+        case D3DFMT_A8:
+        case D3DFMT_L8:
+        case D3DFMT_P8:
+            bytes += pixels;
+            break;
+
+        case D3DFMT_R5G6B5:
+        case D3DFMT_X1R5G5B5:
+        case D3DFMT_A1R5G5B5:
+        case D3DFMT_A4R4G4B4:
+        case D3DFMT_A8L8:
+            bytes += pixels * 2;
+            break;
+
+        // block compressed, 4x4 pixels in 8 or 16 bytes
+        case D3DFMT_DXT1:
+            bytes += std::max< size_t >( pixels / 2, 8 );
+            break;
+
+        case D3DFMT_DXT2:
+        case D3DFMT_DXT3:
+        case D3DFMT_DXT4:
+        case D3DFMT_DXT5:
+            bytes += std::max< size_t >( pixels, 16 );
+            break;
+
+        case D3DFMT_A16B16G16R16:
+        case D3DFMT_A16B16G16R16F:
+            bytes += pixels * 8;
+            break;
+
+        case D3DFMT_A32B32G32R32F:
+            bytes += pixels * 16;
+            break;
+
+        default:
+            bytes += pixels * 4;
+            break;
+        }
+    }
+
+    return bytes;
+}
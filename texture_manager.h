@@ -0,0 +1,120 @@
+#pragma once
+
+using texture_handle_t = uint64_t;
+
+// handle that doesn't name a texture
+constexpr texture_handle_t invalid_texture_handle = ~( texture_handle_t ) 0;
+
+using texture_loader_t = std::function< IDirect3DTexture9 *() >;
+using texture_evict_t  = std::function< void() >;
+
+//
+// Texture memory counters
+//
+struct TextureFootprint_t {
+    size_t   m_textures;       // live handles
+    size_t   m_resident;       // handles with a texture right now
+    size_t   m_resident_bytes; // bytes of resident textures, all mip levels
+    size_t   m_budget;         // 0 is unlimited
+    uint64_t m_evictions;      // textures released to stay in the budget
+    uint64_t m_reloads;        // evicted textures created again on use
+
+    // ctor(s)
+    FORCEINLINE TextureFootprint_t() : m_textures{}, m_resident{}, m_resident_bytes{}, m_budget{}, m_evictions{}, m_reloads{} {
+
+    }
+};
+
+//
+// Handle based texture ownership with a memory budget
+//
+// textures are referenced by handle instead of raw pointer. a handle carries the slot index and a generation,
+// so a released handle never aliases the texture that takes its slot. textures with a loader can be evicted
+// when the resident bytes are over budget, least recently used first, and are created again by the loader
+// the next time they're acquired. textures used in the current frame are never evicted
+//
+class TextureManager {
+public:
+    struct TextureEntry_t {
+        IDirect3DTexture9 *m_texture;    // null while evicted or free
+        size_t            m_bytes;      // size of m_texture
+        size_t            m_group;      // accounting group, ex. a font id
+        uint64_t          m_last_frame; // last frame the texture was acquired
+        uint32_t          m_generation; // bumped when the slot is freed
+        bool              m_used;       // slot holds a handle
+        texture_loader_t  m_loader;     // creates the texture again after eviction, entries without one stay resident
+        texture_evict_t   m_on_evict;   // tells the owner its texture is about to go away
+
+        // ctor(s)
+        FORCEINLINE TextureEntry_t() : m_texture{}, m_bytes{}, m_group{}, m_last_frame{}, m_generation{}, m_used{}, m_loader{}, m_on_evict{} {
+
+        }
+    };
+
+    using entries_t = std::vector< TextureEntry_t >;
+
+    // group of textures that don't belong to a font
+    static constexpr size_t user_group = ~( size_t ) 0;
+
+private:
+    entries_t             m_entries;    // slots by handle index
+    std::vector< size_t > m_free;       // unused slots
+    std::vector< size_t > m_candidates; // eviction scratch
+    uint64_t              m_frame;      // current frame
+    TextureFootprint_t    m_footprint;  // counters
+
+    // entry for handle, null if the handle is stale
+    NOINLINE TextureEntry_t *find( texture_handle_t handle );
+    NOINLINE const TextureEntry_t *find( texture_handle_t handle ) const;
+
+    // release entry texture and account for it
+    NOINLINE void unload( TextureEntry_t &entry );
+
+public:
+    // ctor(s)
+    FORCEINLINE TextureManager() : m_entries{}, m_free{}, m_candidates{}, m_frame{}, m_footprint{} {
+
+    }
+
+    // dtor
+    FORCEINLINE ~TextureManager() {
+        release();
+    }
+
+    TextureManager( const TextureManager & )            = delete;
+    TextureManager &operator=( const TextureManager & ) = delete;
+
+    // take over a reference to texture. with a loader the texture may be evicted and loaded again on demand
+    NOINLINE texture_handle_t add( IDirect3DTexture9 *texture, size_t group, texture_loader_t loader = nullptr, texture_evict_t on_evict = nullptr );
+
+    // release texture and free the handle
+    NOINLINE void remove( texture_handle_t handle );
+
+    // texture for drawing this frame, loaded again if it was evicted. null if the handle is stale or loading failed
+    NOINLINE IDirect3DTexture9 *acquire( texture_handle_t handle );
+
+    // evict least recently used textures until the budget is met, then start the next frame.
+    // returns the number of evicted textures
+    NOINLINE size_t end_frame();
+
+    // release every texture, every handle goes stale
+    NOINLINE void release();
+
+    // max resident bytes, 0 is unlimited. evictions happen at end_frame
+    FORCEINLINE void set_budget( size_t bytes ) {
+        m_footprint.m_budget = bytes;
+    }
+
+    FORCEINLINE const TextureFootprint_t &get_footprint() const {
+        return m_footprint;
+    }
+
+    // resident bytes of a texture, 0 while evicted
+    NOINLINE size_t get_bytes( texture_handle_t handle ) const;
+
+    // resident bytes of every texture in group
+    NOINLINE size_t get_group_bytes( size_t group ) const;
+
+    // memory used by all levels of texture
+    static NOINLINE size_t get_texture_bytes( IDirect3DTexture9 *texture );
+};
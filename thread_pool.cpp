@@ -0,0 +1,113 @@
+#include "includes.h"
+
+NOINLINE bool ThreadPool::init( size_t worker_count ) {
+    if( !m_workers.empty() )
+        return true;
+
+    if( !worker_count ) {
+        const auto hardware_threads = ( size_t ) std::thread::hardware_concurrency();
+
+        worker_count = hardware_threads > 1 ? hardware_threads - 1 : 0;
+    }
+
+    m_stop = false;
+
+    for( size_t i = 0; i < worker_count; ++i )
+        m_workers.emplace_back( &ThreadPool::worker_loop, this, i );
+
+    return true;
+}
+
+NOINLINE void ThreadPool::release() {
+    {
+        std::lock_guard< std::mutex > lock( m_mutex );
+        m_stop = true;
+    }
+
+    m_task_cv.notify_all();
+
+    for( auto &worker : m_workers ) {
+        if( worker.joinable() )
+            worker.join();
+    }
+
+    m_workers.clear();
+}
+
+NOINLINE void ThreadPool::submit( task_t task ) {
+    // no workers, run inline
+    if( m_workers.empty() ) {
+        task();
+        return;
+    }
+
+    {
+        std::lock_guard< std::mutex > lock( m_mutex );
+
+        m_tasks.push_back( std::move( task ) );
+        m_pending++;
+    }
+
+    m_task_cv.notify_one();
+}
+
+NOINLINE void ThreadPool::wait() {
+    std::unique_lock< std::mutex > lock( m_mutex );
+
+    m_done_cv.wait( lock, [ this ]() { return m_pending == 0; } );
+}
+
+NOINLINE bool ThreadPool::run_pending() {
+    task_t task;
+
+    {
+        std::lock_guard< std::mutex > lock( m_mutex );
+
+        if( m_tasks.empty() )
+            return false;
+
+        task = std::move( m_tasks.front() );
+        m_tasks.pop_front();
+    }
+
+    task();
+
+    {
+        std::lock_guard< std::mutex > lock( m_mutex );
+
+        if( --m_pending == 0 )
+            m_done_cv.notify_all();
+    }
+
+    return true;
+}
+
+NOINLINE void ThreadPool::worker_loop( size_t index ) {
+    task_t task;
+
+    Profiler::set_thread_name( "ThreadPool worker " + std::to_string( index ) );
+
+    while( true ) {
+        {
+            std::unique_lock< std::mutex > lock( m_mutex );
+
+            m_task_cv.wait( lock, [ this ]() { return m_stop || !m_tasks.empty(); } );
+
+            // drain the queue before exiting
+            if( m_tasks.empty() )
+                return;
+
+            task = std::move( m_tasks.front() );
+            m_tasks.pop_front();
+        }
+
+        task();
+
+        {
+            std::lock_guard< std::mutex > lock( m_mutex );
+
+            if( --m_pending == 0 )
+                m_done_cv.notify_all();
+        }
+    }
+}
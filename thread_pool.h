@@ -0,0 +1,101 @@
+#pragma once
+
+//
+// Fixed size worker pool
+//
+// workers sleep on a condition variable until tasks are queued. parallel_for splits a range into
+// one chunk per worker plus one for the calling thread, which works on its own chunk and then
+// runs queued tasks until the rest are done, so callers can index per worker state with the chunk index
+// and chunks still get run while every worker is busy with something else.
+//
+class ThreadPool {
+private:
+    using task_t = std::function< void() >;
+
+    std::vector< std::thread > m_workers; // worker threads
+    std::deque< task_t >       m_tasks;   // queued tasks
+    std::mutex                 m_mutex;   // guards tasks, pending count and stop flag
+    std::condition_variable    m_task_cv; // signaled when tasks are queued or on stop
+    std::condition_variable    m_done_cv; // signaled when a task finishes
+    size_t                     m_pending; // queued + running tasks
+    bool                       m_stop;    // workers should exit
+
+    // worker thread loop
+    NOINLINE void worker_loop( size_t index );
+
+public:
+    // ctor(s)
+    FORCEINLINE ThreadPool() : m_workers{}, m_tasks{}, m_mutex{}, m_task_cv{}, m_done_cv{}, m_pending{}, m_stop{} {
+
+    }
+
+    // dtor
+    FORCEINLINE ~ThreadPool() {
+        release();
+    }
+
+    // start worker threads, zero uses one less than the hardware thread count
+    NOINLINE bool init( size_t worker_count = 0 );
+
+    // finish queued tasks and join workers
+    NOINLINE void release();
+
+    // queue task
+    NOINLINE void submit( task_t task );
+
+    // block until every queued task has finished
+    NOINLINE void wait();
+
+    // run the oldest queued task on the calling thread, false if nothing is queued
+    NOINLINE bool run_pending();
+
+    // number of worker threads
+    FORCEINLINE size_t get_worker_count() const {
+        return m_workers.size();
+    }
+
+    // run fn( chunk, begin, end ) over [0, count), chunk 0 runs on the calling thread.
+    // at most max_chunks chunks are used, each gets at least min_chunk_size items
+    template< typename fn_t > 
+    FORCEINLINE size_t parallel_for( size_t count, size_t max_chunks, size_t min_chunk_size, fn_t &&fn ) {
+        std::atomic< size_t >   remaining;
+        std::mutex              done_mutex;
+        std::condition_variable done_cv;
+        size_t                  chunk_count;
+
+        if( !count )
+            return 0;
+
+        chunk_count = std::min( { max_chunks, get_worker_count() + 1, ( count + min_chunk_size - 1 ) / std::max< size_t >( min_chunk_size, 1 ) } );
+        chunk_count = std::max< size_t >( chunk_count, 1 );
+
+        const auto chunk_size = ( count + chunk_count - 1 ) / chunk_count;
+
+        remaining = chunk_count - 1;
+
+        for( size_t chunk = 1; chunk < chunk_count; ++chunk ) {
+            const auto begin = std::min( chunk * chunk_size, count );
+            const auto end   = std::min( begin + chunk_size, count );
+
+            submit( [ &, chunk, begin, end ]() {
+                fn( chunk, begin, end );
+
+                // last one out wakes the caller
+                std::lock_guard< std::mutex > lock( done_mutex );
+                if( --remaining == 0 )
+                    done_cv.notify_one();
+            } );
+        }
+
+        fn( 0, 0, std::min( chunk_size, count ) );
+
+        // help out, our chunks may be queued behind other tasks. once the queue is empty they're all running
+        while( remaining != 0 && run_pending() )
+            ;
+
+        std::unique_lock< std::mutex > lock( done_mutex );
+        done_cv.wait( lock, [ & ]() { return remaining == 0; } );
+
+        return chunk_count;
+    }
+};
@@ -10,4 +10,79 @@ namespace Utils {
         }
     }
 
+    // fast non cryptographic 64 bit hash, 8 bytes per step
+    FORCEINLINE uint64_t hash_bytes( const void *data, size_t size, uint64_t seed = 0 ) {
+        constexpr uint64_t multiplier = 0x9E3779B97F4A7C15ull;
+
+        const auto bytes = ( const uint8_t * ) data;
+
+        uint64_t hash = seed ^ ( size * multiplier );
+        uint64_t word;
+        size_t   i = 0;
+
+        for( ; i + 8 <= size; i += 8 ) {
+            std::memcpy( &word, bytes + i, 8 );
+
+            hash = ( ( ( hash << 5 ) | ( hash >> 59 ) ) ^ word ) * multiplier;
+        }
+
+        for( ; i < size; ++i )
+            hash = ( ( ( hash << 5 ) | ( hash >> 59 ) ) ^ bytes[ i ] ) * multiplier;
+
+        // murmur3 finalizer, spreads the last words over every bit
+        hash ^= hash >> 33;
+        hash *= 0xFF51AFD7ED558CCDull;
+        hash ^= hash >> 33;
+        hash *= 0xC4CEB9FE1A85EC53ull;
+        hash ^= hash >> 33;
+
+        return hash;
+    }
+
+    // decode utf-8 codepoint at index and advance past it, malformed sequences decode to U+FFFD
+    FORCEINLINE uint32_t decode_utf8( const char *str, size_t length, size_t &index ) {
+        constexpr uint32_t replacement = 0xFFFD;
+
+        const auto lead = ( uint8_t ) str[ index++ ];
+
+        // ascii
+        if( lead < 0x80 )
+            return lead;
+
+        size_t   count;
+        uint32_t codepoint, min;
+
+        if( ( lead & 0xE0 ) == 0xC0 ) {
+            count     = 1;
+            codepoint = lead & 0x1F;
+            min       = 0x80;
+        }
+        else if( ( lead & 0xF0 ) == 0xE0 ) {
+            count     = 2;
+            codepoint = lead & 0x0F;
+            min       = 0x800;
+        }
+        else if( ( lead & 0xF8 ) == 0xF0 ) {
+            count     = 3;
+            codepoint = lead & 0x07;
+            min       = 0x10000;
+        }
+        else
+            return replacement;
+
+        for( size_t i = 0; i < count; ++i ) {
+            // truncated sequence, resume at the offending byte
+            if( index >= length || ( ( uint8_t ) str[ index ] & 0xC0 ) != 0x80 )
+                return replacement;
+
+            codepoint = ( codepoint << 6 ) | ( ( uint8_t ) str[ index++ ] & 0x3F );
+        }
+
+        // overlong encodings, surrogates and out of range
+        if( codepoint < min || ( codepoint >= 0xD800 && codepoint <= 0xDFFF ) || codepoint > 0x10FFFF )
+            return replacement;
+
+        return codepoint;
+    }
+
 }
\ No newline at end of file
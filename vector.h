@@ -1,5 +1,115 @@
 #pragma once
 
+//
+// simd backend selection, define VECTOR_NO_SIMD to force the scalar fallback
+//
+#if !defined( VECTOR_NO_SIMD ) && ( defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 ) )
+    #define VECTOR_SIMD
+    #define VECTOR_SSE
+    #include <emmintrin.h>
+#elif !defined( VECTOR_NO_SIMD ) && ( defined( __aarch64__ ) || defined( _M_ARM64 ) )
+    #define VECTOR_SIMD
+    #define VECTOR_NEON
+    #include <arm_neon.h>
+#endif
+
+#ifdef VECTOR_SIMD
+
+//
+// thin wrapper over the 4-wide float instructions of the selected backend.
+// loads and stores are unaligned, vectors live inside packed vertex structs.
+//
+namespace Simd {
+
+#ifdef VECTOR_SSE
+    using float4_t = __m128;
+
+    FORCEINLINE float4_t load( const float *src ) { return _mm_loadu_ps( src ); }
+    FORCEINLINE void     store( float *dst, float4_t v ) { _mm_storeu_ps( dst, v ); }
+    FORCEINLINE float4_t set( float x, float y, float z, float w ) { return _mm_setr_ps( x, y, z, w ); }
+    FORCEINLINE float4_t set1( float s ) { return _mm_set1_ps( s ); }
+    FORCEINLINE float4_t add( float4_t a, float4_t b ) { return _mm_add_ps( a, b ); }
+    FORCEINLINE float4_t sub( float4_t a, float4_t b ) { return _mm_sub_ps( a, b ); }
+    FORCEINLINE float4_t mul( float4_t a, float4_t b ) { return _mm_mul_ps( a, b ); }
+    FORCEINLINE float4_t div( float4_t a, float4_t b ) { return _mm_div_ps( a, b ); }
+
+    // ( a.x, a.y, b.x, b.y )
+    FORCEINLINE float4_t low_pairs( float4_t a, float4_t b ) { return _mm_movelh_ps( a, b ); }
+
+    // ( a.z, a.w, b.x, b.y )
+    FORCEINLINE float4_t high_low_pairs( float4_t a, float4_t b ) { return _mm_movelh_ps( _mm_movehl_ps( a, a ), b ); }
+
+    // ( a.x, b.x, a.y, b.y ) and ( a.z, b.z, a.w, b.w ), xs and ys into points
+    FORCEINLINE float4_t interleave_low( float4_t a, float4_t b ) { return _mm_unpacklo_ps( a, b ); }
+    FORCEINLINE float4_t interleave_high( float4_t a, float4_t b ) { return _mm_unpackhi_ps( a, b ); }
+
+    // x + y + z + w
+    FORCEINLINE float hsum( float4_t v ) {
+        const auto shuffled = _mm_shuffle_ps( v, v, _MM_SHUFFLE( 2, 3, 0, 1 ) );
+        const auto sums     = _mm_add_ps( v, shuffled );
+
+        return _mm_cvtss_f32( _mm_add_ss( sums, _mm_movehl_ps( shuffled, sums ) ) );
+    }
+
+    // 2-wide, 64 bit loads and stores. only the low 2 lanes are meaningful. __m64 may alias the floats, double doesn't
+    using float2_t = __m128;
+
+    FORCEINLINE float2_t load2( const float *src ) { return _mm_loadl_pi( _mm_setzero_ps(), ( const __m64 * ) src ); }
+    FORCEINLINE void     store2( float *dst, float2_t v ) { _mm_storel_pi( ( __m64 * ) dst, v ); }
+    FORCEINLINE float2_t set2( float x, float y ) { return _mm_setr_ps( x, y, 0.f, 0.f ); }
+    FORCEINLINE float2_t set1_2( float s ) { return _mm_set1_ps( s ); }
+    FORCEINLINE float2_t add2( float2_t a, float2_t b ) { return _mm_add_ps( a, b ); }
+    FORCEINLINE float2_t sub2( float2_t a, float2_t b ) { return _mm_sub_ps( a, b ); }
+    FORCEINLINE float2_t mul2( float2_t a, float2_t b ) { return _mm_mul_ps( a, b ); }
+    FORCEINLINE float2_t div2( float2_t a, float2_t b ) { return _mm_div_ps( a, b ); }
+
+    // x + y
+    FORCEINLINE float hsum2( float2_t v ) { return _mm_cvtss_f32( _mm_add_ss( v, _mm_shuffle_ps( v, v, _MM_SHUFFLE( 1, 1, 1, 1 ) ) ) ); }
+#else
+    using float4_t = float32x4_t;
+
+    FORCEINLINE float4_t load( const float *src ) { return vld1q_f32( src ); }
+    FORCEINLINE void     store( float *dst, float4_t v ) { vst1q_f32( dst, v ); }
+    FORCEINLINE float4_t set( float x, float y, float z, float w ) { const float values[ 4 ] = { x, y, z, w }; return vld1q_f32( values ); }
+    FORCEINLINE float4_t set1( float s ) { return vdupq_n_f32( s ); }
+    FORCEINLINE float4_t add( float4_t a, float4_t b ) { return vaddq_f32( a, b ); }
+    FORCEINLINE float4_t sub( float4_t a, float4_t b ) { return vsubq_f32( a, b ); }
+    FORCEINLINE float4_t mul( float4_t a, float4_t b ) { return vmulq_f32( a, b ); }
+    FORCEINLINE float4_t div( float4_t a, float4_t b ) { return vdivq_f32( a, b ); }
+
+    // ( a.x, a.y, b.x, b.y )
+    FORCEINLINE float4_t low_pairs( float4_t a, float4_t b ) { return vcombine_f32( vget_low_f32( a ), vget_low_f32( b ) ); }
+
+    // ( a.z, a.w, b.x, b.y )
+    FORCEINLINE float4_t high_low_pairs( float4_t a, float4_t b ) { return vcombine_f32( vget_high_f32( a ), vget_low_f32( b ) ); }
+
+    // ( a.x, b.x, a.y, b.y ) and ( a.z, b.z, a.w, b.w ), xs and ys into points
+    FORCEINLINE float4_t interleave_low( float4_t a, float4_t b ) { return vzip1q_f32( a, b ); }
+    FORCEINLINE float4_t interleave_high( float4_t a, float4_t b ) { return vzip2q_f32( a, b ); }
+
+    // x + y + z + w
+    FORCEINLINE float hsum( float4_t v ) { return vaddvq_f32( v ); }
+
+    // 2-wide, 64 bit loads and stores
+    using float2_t = float32x2_t;
+
+    FORCEINLINE float2_t load2( const float *src ) { return vld1_f32( src ); }
+    FORCEINLINE void     store2( float *dst, float2_t v ) { vst1_f32( dst, v ); }
+    FORCEINLINE float2_t set2( float x, float y ) { return vset_lane_f32( y, vdup_n_f32( x ), 1 ); }
+    FORCEINLINE float2_t set1_2( float s ) { return vdup_n_f32( s ); }
+    FORCEINLINE float2_t add2( float2_t a, float2_t b ) { return vadd_f32( a, b ); }
+    FORCEINLINE float2_t sub2( float2_t a, float2_t b ) { return vsub_f32( a, b ); }
+    FORCEINLINE float2_t mul2( float2_t a, float2_t b ) { return vmul_f32( a, b ); }
+    FORCEINLINE float2_t div2( float2_t a, float2_t b ) { return vdiv_f32( a, b ); }
+
+    // x + y
+    FORCEINLINE float hsum2( float2_t v ) { return vpadds_f32( v ); }
+#endif
+
+}
+
+#endif
+
 //
 // 4-dimensional vector implementatioon
 //
@@ -13,9 +123,7 @@ public:
 
     }
 
-    FORCEINLINE Vector4( const Vector4 &other ) : x{ other.x }, y{ other.y }, z{ other.z }, w{ other.w } {
-
-    }
+    FORCEINLINE Vector4( const Vector4 &other ) = default;
 
     FORCEINLINE Vector4( float x, float y, float z, float w ) : x{ x }, y{ y }, z{ z }, w{ w } {
 
@@ -28,6 +136,20 @@ public:
         w = w0;
     }
 
+#ifdef VECTOR_SIMD
+    FORCEINLINE explicit Vector4( Simd::float4_t v ) {
+        store( v );
+    }
+
+    FORCEINLINE Simd::float4_t load() const {
+        return Simd::load( &x );
+    }
+
+    FORCEINLINE void store( Simd::float4_t v ) {
+        Simd::store( &x, v );
+    }
+#endif
+
     // 
     // operators
     //
@@ -41,14 +163,7 @@ public:
     }
 
     // assignment
-    FORCEINLINE Vector4 &operator =( const Vector4 &other ) {
-        x = other.x;
-        y = other.y;
-        z = other.z;
-        w = other.w;
-
-        return *this;
-    }
+    FORCEINLINE Vector4 &operator =( const Vector4 &other ) = default;
 
     // equality
     FORCEINLINE bool operator ==( const Vector4 &other ) const {
@@ -56,112 +171,176 @@ public:
     }
 
     FORCEINLINE bool operator !=( const Vector4 & other ) const {
-        return ( other.x != x ) || ( other.y != y ) || ( other.z != z ) && ( other.w != w );
+        return ( other.x != x ) || ( other.y != y ) || ( other.z != z ) || ( other.w != w );
     }
 
     // arithmetic operations
     // copy
     FORCEINLINE Vector4 operator +( const Vector4 & other ) const {
+#ifdef VECTOR_SIMD
+        return Vector4( Simd::add( load(), other.load() ) );
+#else
         return Vector4( x + other.x, y + other.y, z + other.z, w + other.w );
+#endif
     }
 
     FORCEINLINE Vector4 operator -( const Vector4 & other ) const {
+#ifdef VECTOR_SIMD
+        return Vector4( Simd::sub( load(), other.load() ) );
+#else
         return Vector4( x - other.x, y - other.y, z - other.z, w - other.w );
+#endif
     }
 
     FORCEINLINE Vector4 operator *( const Vector4 & other ) const {
+#ifdef VECTOR_SIMD
+        return Vector4( Simd::mul( load(), other.load() ) );
+#else
         return Vector4( x * other.x, y * other.y, z * other.z, w * other.w );
+#endif
     }
 
     FORCEINLINE Vector4 operator /( const Vector4 & other ) const {
+#ifdef VECTOR_SIMD
+        return Vector4( Simd::div( load(), other.load() ) );
+#else
         return Vector4( x / other.x, y / other.y, z / other.z, w / other.w );
+#endif
     }
 
     FORCEINLINE Vector4 operator +( float scalar ) const {
+#ifdef VECTOR_SIMD
+        return Vector4( Simd::add( load(), Simd::set1( scalar ) ) );
+#else
         return Vector4( x + scalar, y + scalar, z + scalar, w + scalar );
+#endif
     }
 
     FORCEINLINE Vector4 operator -( float scalar ) const {
+#ifdef VECTOR_SIMD
+        return Vector4( Simd::sub( load(), Simd::set1( scalar ) ) );
+#else
         return Vector4( x - scalar, y - scalar, z - scalar, w - scalar );
+#endif
     }
 
     FORCEINLINE Vector4 operator *( float scalar ) const {
+#ifdef VECTOR_SIMD
+        return Vector4( Simd::mul( load(), Simd::set1( scalar ) ) );
+#else
         return Vector4( x * scalar, y * scalar, z * scalar, w * scalar );
+#endif
     }
 
     FORCEINLINE Vector4 operator /( float scalar ) const {
+#ifdef VECTOR_SIMD
+        return Vector4( Simd::div( load(), Simd::set1( scalar ) ) );
+#else
         return Vector4( x / scalar, y / scalar, z / scalar, w / scalar );
+#endif
     }
 
     // reference
     FORCEINLINE Vector4 &operator +=( const Vector4 & other ) {
+#ifdef VECTOR_SIMD
+        store( Simd::add( load(), other.load() ) );
+#else
         x += other.x;
         y += other.y;
         z += other.z;
         w += other.w;
+#endif
 
         return *this;
     }
 
     FORCEINLINE Vector4 &operator -=( const Vector4 &other ) {
+#ifdef VECTOR_SIMD
+        store( Simd::sub( load(), other.load() ) );
+#else
         x -= other.x;
         y -= other.y;
         z -= other.z;
         w -= other.w;
+#endif
 
         return *this;
     }
 
     FORCEINLINE Vector4 &operator *=( const Vector4 &other ) {
+#ifdef VECTOR_SIMD
+        store( Simd::mul( load(), other.load() ) );
+#else
         x *= other.x;
         y *= other.y;
         z *= other.z;
         w *= other.w;
+#endif
 
         return *this;
     }
 
     FORCEINLINE Vector4 &operator /=( const Vector4 &other ) {
+#ifdef VECTOR_SIMD
+        store( Simd::div( load(), other.load() ) );
+#else
         x /= other.x;
         y /= other.y;
         z /= other.z;
         w /= other.w;
+#endif
 
         return *this;
     }
 
     FORCEINLINE Vector4 &operator *=( float scalar ) {
+#ifdef VECTOR_SIMD
+        store( Simd::mul( load(), Simd::set1( scalar ) ) );
+#else
         x *= scalar;
         y *= scalar;
         z *= scalar;
         w *= scalar;
+#endif
 
         return *this;
     }
 
     FORCEINLINE Vector4 &operator /=( float scalar ) {
+#ifdef VECTOR_SIMD
+        store( Simd::div( load(), Simd::set1( scalar ) ) );
+#else
         x /= scalar;
         y /= scalar;
         z /= scalar;
         w /= scalar;
+#endif
 
         return *this;
     }
 
     FORCEINLINE Vector4 &operator +=( float scalar ) {
+#ifdef VECTOR_SIMD
+        store( Simd::add( load(), Simd::set1( scalar ) ) );
+#else
         x += scalar;
         y += scalar;
         z += scalar;
         w += scalar;
+#endif
 
         return *this;
     }
 
     FORCEINLINE Vector4 &operator -=( float scalar ) {
+#ifdef VECTOR_SIMD
+        store( Simd::sub( load(), Simd::set1( scalar ) ) );
+#else
         x -= scalar;
         y -= scalar;
         z -= scalar;
         w -= scalar;
+#endif
 
         return *this;
     }
@@ -172,7 +351,7 @@ public:
     }
 
     FORCEINLINE float len() {
-        return sqrtf( x * x + y * y + z * z + w * w );
+        return sqrtf( len_sqr() );
     }
 
     FORCEINLINE float len_3d() {
@@ -184,11 +363,15 @@ public:
     }
 
     FORCEINLINE float len_sqr() {
-        return ( x * x ) + ( y * y ) + ( z * z ) + ( w * w );
+        return dot( *this );
     }
 
     FORCEINLINE float dot( const Vector4 & other ) {
+#ifdef VECTOR_SIMD
+        return Simd::hsum( Simd::mul( load(), other.load() ) );
+#else
         return ( x * other.x ) + ( y * other.y ) + ( z * other.z ) + ( w * other.w );
+#endif
     }
 
     FORCEINLINE float dist( const Vector4 & other ) {
@@ -202,25 +385,20 @@ public:
         mag = len();
 
         // create unit vector, divide each component by magnitude
-        if( mag != 0.f ) {
-            x /= mag;
-            y /= mag;
-            z /= mag;
-            w /= mag;
-        }
+        if( mag != 0.f )
+            *this /= mag;
 
         return mag;
     }
 
     FORCEINLINE Vector4 normalized() {
         Vector4 vec;
-        float mag;
 
         // make copy of current vector
         vec = ( *this );
 
         // normalize vector
-        mag = vec.normalize();
+        vec.normalize();
 
         return vec;
     }
@@ -236,9 +414,7 @@ public:
 
     }
 
-    FORCEINLINE Vector2( const Vector2 &other ) : x{ other.x }, y{ other.y } {
-
-    }
+    FORCEINLINE Vector2( const Vector2 &other ) = default;
 
     FORCEINLINE Vector2( float x, float y ) : x{ x }, y{ y } {
 
@@ -249,6 +425,20 @@ public:
         y = y0;
     }
 
+#ifdef VECTOR_SIMD
+    FORCEINLINE explicit Vector2( Simd::float2_t v ) {
+        store( v );
+    }
+
+    FORCEINLINE Simd::float2_t load() const {
+        return Simd::load2( &x );
+    }
+
+    FORCEINLINE void store( Simd::float2_t v ) {
+        Simd::store2( &x, v );
+    }
+#endif
+
     // 
     // operators
     //
@@ -262,12 +452,7 @@ public:
     }
 
     // assignment
-    FORCEINLINE Vector2 &operator =( const Vector2 &other ) {
-        x = other.x;
-        y = other.y;
-
-        return *this;
-    }
+    FORCEINLINE Vector2 &operator =( const Vector2 &other ) = default;
 
     // equality
     FORCEINLINE bool operator ==( const Vector2 &other ) const {
@@ -280,91 +465,155 @@ public:
 
     // arithmetic operations
     // copy
-    FORCEINLINE Vector2 operator +( const Vector2 & other ) const {
-        return Vector2( x + other.x, y + other.y);
-    }
-
-    FORCEINLINE Vector2 operator -( const Vector2 & other ) const {
+    FORCEINLINE Vector2 operator +( const Vector2 &other ) const {
+#ifdef VECTOR_SIMD
+        return Vector2( Simd::add2( load(), other.load() ) );
+#else
+        return Vector2( x + other.x, y + other.y );
+#endif
+    }
+
+    FORCEINLINE Vector2 operator -( const Vector2 &other ) const {
+#ifdef VECTOR_SIMD
+        return Vector2( Simd::sub2( load(), other.load() ) );
+#else
         return Vector2( x - other.x, y - other.y );
+#endif
     }
 
     FORCEINLINE Vector2 operator *( const Vector2 &other ) const {
+#ifdef VECTOR_SIMD
+        return Vector2( Simd::mul2( load(), other.load() ) );
+#else
         return Vector2( x * other.x, y * other.y );
+#endif
     }
 
     FORCEINLINE Vector2 operator /( const Vector2 &other ) const {
+#ifdef VECTOR_SIMD
+        return Vector2( Simd::div2( load(), other.load() ) );
+#else
         return Vector2( x / other.x, y / other.y );
+#endif
     }
 
     FORCEINLINE Vector2 operator +( float scalar ) const {
+#ifdef VECTOR_SIMD
+        return Vector2( Simd::add2( load(), Simd::set1_2( scalar ) ) );
+#else
         return Vector2( x + scalar, y + scalar );
+#endif
     }
 
     FORCEINLINE Vector2 operator -( float scalar ) const {
-        return Vector2( x - scalar, y - scalar  );
+#ifdef VECTOR_SIMD
+        return Vector2( Simd::sub2( load(), Simd::set1_2( scalar ) ) );
+#else
+        return Vector2( x - scalar, y - scalar );
+#endif
     }
 
     FORCEINLINE Vector2 operator *( float scalar ) const {
+#ifdef VECTOR_SIMD
+        return Vector2( Simd::mul2( load(), Simd::set1_2( scalar ) ) );
+#else
         return Vector2( x * scalar, y * scalar );
+#endif
     }
 
     FORCEINLINE Vector2 operator /( float scalar ) const {
+#ifdef VECTOR_SIMD
+        return Vector2( Simd::div2( load(), Simd::set1_2( scalar ) ) );
+#else
         return Vector2( x / scalar, y / scalar );
+#endif
     }
 
     // reference
     FORCEINLINE Vector2 &operator +=( const Vector2 &other ) {
+#ifdef VECTOR_SIMD
+        store( Simd::add2( load(), other.load() ) );
+#else
         x += other.x;
         y += other.y;
+#endif
 
         return *this;
     }
 
     FORCEINLINE Vector2 &operator -=( const Vector2 &other ) {
+#ifdef VECTOR_SIMD
+        store( Simd::sub2( load(), other.load() ) );
+#else
         x -= other.x;
         y -= other.y;
+#endif
 
         return *this;
     }
 
     FORCEINLINE Vector2 &operator *=( const Vector2 &other ) {
+#ifdef VECTOR_SIMD
+        store( Simd::mul2( load(), other.load() ) );
+#else
         x *= other.x;
         y *= other.y;
+#endif
 
         return *this;
     }
 
     FORCEINLINE Vector2 &operator /=( const Vector2 &other ) {
+#ifdef VECTOR_SIMD
+        store( Simd::div2( load(), other.load() ) );
+#else
         x /= other.x;
         y /= other.y;
+#endif
 
         return *this;
     }
 
     FORCEINLINE Vector2 &operator *=( float scalar ) {
+#ifdef VECTOR_SIMD
+        store( Simd::mul2( load(), Simd::set1_2( scalar ) ) );
+#else
         x *= scalar;
         y *= scalar;
+#endif
 
         return *this;
     }
 
     FORCEINLINE Vector2 &operator /=( float scalar ) {
+#ifdef VECTOR_SIMD
+        store( Simd::div2( load(), Simd::set1_2( scalar ) ) );
+#else
         x /= scalar;
         y /= scalar;
+#endif
 
         return *this;
     }
 
     FORCEINLINE Vector2 &operator +=( float scalar ) {
+#ifdef VECTOR_SIMD
+        store( Simd::add2( load(), Simd::set1_2( scalar ) ) );
+#else
         x += scalar;
         y += scalar;
+#endif
 
         return *this;
     }
 
     FORCEINLINE Vector2 &operator -=( float scalar ) {
+#ifdef VECTOR_SIMD
+        store( Simd::sub2( load(), Simd::set1_2( scalar ) ) );
+#else
         x -= scalar;
         y -= scalar;
+#endif
 
         return *this;
     }
@@ -375,15 +624,19 @@ public:
     }
 
     FORCEINLINE float len_2d() {
-        return sqrtf( x * x + y * y );
+        return sqrtf( len_2d_sqr() );
     }
 
     FORCEINLINE float len_2d_sqr() {
-        return ( x * x ) + ( y * y );
+        return dot( *this );
     }
 
     FORCEINLINE float dot( const Vector2 &other ) {
+#ifdef VECTOR_SIMD
+        return Simd::hsum2( Simd::mul2( load(), other.load() ) );
+#else
         return ( x * other.x ) + ( y * other.y );
+#endif
     }
 
     FORCEINLINE float cross( const Vector2 &other ) {
@@ -401,26 +654,44 @@ public:
         mag = len_2d();
 
         // create unit vector, divide each component by magnitude
-        if( mag != 0.f ) {
-            x /= mag;
-            y /= mag;
-        }
+        if( mag != 0.f )
+            *this /= mag;
 
         return mag;
     }
 
     FORCEINLINE Vector2 normalized() {
         Vector2 vec;
-        float mag;
 
         // make copy of current vector
         vec = ( *this );
 
         // normalize vector
-        mag = vec.normalize();
+        vec.normalize();
 
         return vec;
     }
+
+    // unit vector from reciprocal square root, no divide. ~1e-6 relative error on sse
+    FORCEINLINE Vector2 normalized_fast() const {
+        const auto mag_sqr = ( x * x ) + ( y * y );
+
+        if( mag_sqr == 0.f )
+            return *this;
+
+#ifdef VECTOR_SSE
+        // rsqrt estimate refined with one newton-raphson step
+        const auto estimate = _mm_rsqrt_ss( _mm_set_ss( mag_sqr ) );
+        const auto refined  = _mm_mul_ss( _mm_mul_ss( _mm_set_ss( 0.5f ), estimate ), 
+            _mm_sub_ss( _mm_set_ss( 3.f ), _mm_mul_ss( _mm_mul_ss( _mm_set_ss( mag_sqr ), estimate ), estimate ) ) );
+
+        const auto inv_mag = _mm_cvtss_f32( refined );
+#else
+        const auto inv_mag = 1.f / sqrtf( mag_sqr );
+#endif
+
+        return Vector2( x * inv_mag, y * inv_mag );
+    }
 };
 
 //
@@ -436,9 +707,7 @@ public:
 
     }
 
-    FORCEINLINE Vector3( const Vector3 &other ) : x{ other.x }, y{ other.y }, z{ other.z }{
-
-    }
+    FORCEINLINE Vector3( const Vector3 &other ) = default;
 
     FORCEINLINE Vector3( float x, float y, float z ) : x{ x }, y{ y }, z{ z } {
 
@@ -463,13 +732,7 @@ public:
     }
 
     // assignment
-    FORCEINLINE Vector3 &operator =( const Vector3 &other ) {
-        x = other.x;
-        y = other.y;
-        z = other.z;
-
-        return *this;
-    }
+    FORCEINLINE Vector3 &operator =( const Vector3 &other ) = default;
 
     // equality
     FORCEINLINE bool operator ==( const Vector3 &other ) const {
@@ -626,14 +889,74 @@ public:
 
     FORCEINLINE Vector3 normalized() {
         Vector3 vec;
-        float mag;
 
         // make copy of current vector
         vec = ( *this );
 
         // normalize vector
-        mag = vec.normalize();
+        vec.normalize();
 
         return vec;
     }
 };
+
+//
+// batch kernels over contiguous vector arrays, simd with a scalar tail / fallback
+//
+namespace VectorKernels {
+
+    // points += delta
+    FORCEINLINE void translate( Vector2 *points, size_t count, const Vector2 &delta ) {
+        size_t i = 0;
+
+#ifdef VECTOR_SIMD
+        // 2 points per register
+        const auto delta4 = Simd::set( delta.x, delta.y, delta.x, delta.y );
+
+        for( ; i + 2 <= count; i += 2 )
+            Simd::store( &points[ i ].x, Simd::add( Simd::load( &points[ i ].x ), delta4 ) );
+#endif
+
+        for( ; i < count; ++i )
+            points[ i ] += delta;
+    }
+
+    // points = origin + ( points - origin ) * factor
+    FORCEINLINE void scale( Vector2 *points, size_t count, const Vector2 &origin, float factor ) {
+        size_t i = 0;
+
+        // folded into a single multiply-add
+        const auto offset = origin - origin * factor;
+
+#ifdef VECTOR_SIMD
+        const auto factor4 = Simd::set1( factor );
+        const auto offset4 = Simd::set( offset.x, offset.y, offset.x, offset.y );
+
+        for( ; i + 2 <= count; i += 2 )
+            Simd::store( &points[ i ].x, Simd::add( Simd::mul( Simd::load( &points[ i ].x ), factor4 ), offset4 ) );
+#endif
+
+        for( ; i < count; ++i )
+            points[ i ] = points[ i ] * factor + offset;
+    }
+
+    // dst = ( src.x, src.y, z, w )
+    FORCEINLINE void widen( const Vector2 *src, Vector4 *dst, size_t count, float z, float w ) {
+        size_t i = 0;
+
+#ifdef VECTOR_SIMD
+        const auto zw = Simd::set( z, w, z, w );
+
+        for( ; i + 2 <= count; i += 2 ) {
+            const auto pair = Simd::load( &src[ i ].x );
+
+            dst[ i ].store( Simd::low_pairs( pair, zw ) );
+            dst[ i + 1 ].store( Simd::high_low_pairs( pair, zw ) );
+        }
+#endif
+
+        for( ; i < count; ++i )
+            dst[ i ].init( src[ i ].x, src[ i ].y, z, w );
+    }
+
+}
\ No newline at end of file